@@ -0,0 +1,303 @@
+#define _GNU_SOURCE
+#include "n_queens_affinity.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_WORKERS 4096
+
+// Topology of one hardware thread, read from /sys/devices/system/cpu
+typedef struct cpu_info
+{
+    int cpu;
+    int core;    // core_id, unique inside a package
+    int package; // physical socket
+    int node;    // NUMA node
+    int smt;     // index of this hardware thread among its core's siblings
+    int core_rank; // index of the core inside its package
+} CPU_INFO;
+
+static PLACEMENT_POLICY policy = PLACEMENT_NONE;
+static CPU_INFO cpus[CPU_SETSIZE];
+static int cpu_count = 0;
+// CPUs in the order workers are assigned to them
+static int order[CPU_SETSIZE];
+static int order_count = 0;
+// Effective CPU and allowed CPUs of each worker, recorded once it is bound
+static int worker_cpu[MAX_WORKERS];
+static cpu_set_t worker_mask[MAX_WORKERS];
+
+static int read_topology_value(int cpu, const char *name)
+{
+    char path[128];
+    int value = 0;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return 0;
+    }
+    if (fscanf(file, "%d", &value) != 1)
+    {
+        value = 0;
+    }
+    fclose(file);
+    return value;
+}
+
+static int read_numa_node(int cpu)
+{
+    char path[128];
+    for (int node = 0; node < 1024; ++node)
+    {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/node%d", cpu, node);
+        if (access(path, F_OK) == 0)
+        {
+            return node;
+        }
+    }
+    return 0;
+}
+
+static int compare_compact(const void *a, const void *b)
+{
+    const CPU_INFO *x = &cpus[*(const int *)a];
+    const CPU_INFO *y = &cpus[*(const int *)b];
+    if (x->node != y->node) return x->node - y->node;
+    if (x->package != y->package) return x->package - y->package;
+    if (x->core_rank != y->core_rank) return x->core_rank - y->core_rank;
+    return x->smt - y->smt;
+}
+
+static int compare_scatter(const void *a, const void *b)
+{
+    const CPU_INFO *x = &cpus[*(const int *)a];
+    const CPU_INFO *y = &cpus[*(const int *)b];
+    if (x->smt != y->smt) return x->smt - y->smt;
+    if (x->core_rank != y->core_rank) return x->core_rank - y->core_rank;
+    if (x->node != y->node) return x->node - y->node;
+    return x->package - y->package;
+}
+
+PLACEMENT_POLICY placement_policy_from_string(const char *name)
+{
+    if (name == NULL)
+    {
+        return PLACEMENT_NONE;
+    }
+    if (strcmp(name, "compact") == 0)
+    {
+        return PLACEMENT_COMPACT;
+    }
+    if (strcmp(name, "scatter") == 0)
+    {
+        return PLACEMENT_SCATTER;
+    }
+    if (strcmp(name, "cores") == 0)
+    {
+        return PLACEMENT_CORES;
+    }
+    if (strcmp(name, "none") != 0)
+    {
+        fprintf(stderr, "Unknown placement policy '%s', threads are not pinned.\n", name);
+    }
+    return PLACEMENT_NONE;
+}
+
+void placement_init(PLACEMENT_POLICY requested)
+{
+    policy = requested != PLACEMENT_NONE ? requested : placement_policy_from_string(getenv("NQ_PLACEMENT"));
+    for (int i = 0; i < MAX_WORKERS; ++i)
+    {
+        worker_cpu[i] = -1;
+    }
+    cpu_count = 0;
+    order_count = 0;
+
+    // Only the CPUs this process is allowed to run on (cgroups, mpirun binding);
+    // the topology is read even without a policy, for placement_report
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    {
+        perror("sched_getaffinity");
+        policy = PLACEMENT_NONE;
+        return;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (!CPU_ISSET(cpu, &allowed))
+        {
+            continue;
+        }
+        CPU_INFO *info = &cpus[cpu_count++];
+        info->cpu = cpu;
+        info->core = read_topology_value(cpu, "core_id");
+        info->package = read_topology_value(cpu, "physical_package_id");
+        info->node = read_numa_node(cpu);
+        info->smt = 0;
+        info->core_rank = 0;
+    }
+
+    // SMT index and core rank are derived from the sibling CPUs seen before
+    for (int i = 0; i < cpu_count; ++i)
+    {
+        int new_core = 1;
+        for (int j = 0; j < i; ++j)
+        {
+            if (cpus[j].package != cpus[i].package)
+            {
+                continue;
+            }
+            if (cpus[j].core == cpus[i].core)
+            {
+                ++cpus[i].smt;
+                cpus[i].core_rank = cpus[j].core_rank;
+                new_core = 0;
+            }
+        }
+        if (new_core)
+        {
+            for (int j = 0; j < i; ++j)
+            {
+                if (cpus[j].package == cpus[i].package && cpus[j].smt == 0)
+                {
+                    ++cpus[i].core_rank;
+                }
+            }
+        }
+    }
+
+    if (policy == PLACEMENT_NONE)
+    {
+        return;
+    }
+    for (int i = 0; i < cpu_count; ++i)
+    {
+        if (policy != PLACEMENT_CORES || cpus[i].smt == 0)
+        {
+            order[order_count++] = i;
+        }
+    }
+    qsort(order, order_count, sizeof(int), policy == PLACEMENT_SCATTER ? compare_scatter : compare_compact);
+}
+
+// What the worker actually got: the CPU it runs on and its affinity mask
+static void record_worker(uint32_t worker)
+{
+    if (worker >= MAX_WORKERS)
+    {
+        return;
+    }
+    CPU_ZERO(&worker_mask[worker]);
+    pthread_getaffinity_np(pthread_self(), sizeof(worker_mask[worker]), &worker_mask[worker]);
+    worker_cpu[worker] = sched_getcpu();
+}
+
+int placement_bind_worker(uint32_t worker)
+{
+    if (policy == PLACEMENT_NONE || order_count == 0)
+    {
+        record_worker(worker);
+        return -1;
+    }
+
+    // More workers than CPUs: wrap around in the same order
+    const int cpu = cpus[order[worker % order_count]].cpu;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+    {
+        fprintf(stderr, "Failed to pin worker %u on cpu %d.\n", worker, cpu);
+        record_worker(worker);
+        return -1;
+    }
+    record_worker(worker);
+    return cpu;
+}
+
+uint32_t placement_first_worker(uint32_t node_rank, uint32_t nworkers)
+{
+    // order only holds the CPUs of this process's affinity mask. When mpirun
+    // already gave each rank its own CPUs, the mask cannot hold the workers of
+    // the ranks before this one and the workers start at its first CPU; when the
+    // ranks share the node's mask, each one takes the next range of it
+    if (policy == PLACEMENT_NONE || (uint64_t)(node_rank + 1) * nworkers > (uint64_t)order_count)
+    {
+        return 0;
+    }
+    return node_rank * nworkers;
+}
+
+void *placement_alloc_local(size_t size)
+{
+    void *memory = malloc(size);
+    if (memory == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for worker local data.\n");
+        exit(EXIT_FAILURE);
+    }
+    // Pages are placed on the NUMA node of the first thread writing them
+    memset(memory, 0, size);
+    return memory;
+}
+
+// CPUs of a mask as ranges, e.g. "0-3,8"
+static void format_mask(const cpu_set_t *mask, char *text, size_t size)
+{
+    size_t used = 0;
+    text[0] = '\0';
+    for (int cpu = 0; cpu < CPU_SETSIZE && used < size; ++cpu)
+    {
+        if (!CPU_ISSET(cpu, mask))
+        {
+            continue;
+        }
+        int last = cpu;
+        while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, mask))
+        {
+            ++last;
+        }
+        used += snprintf(text + used, size - used, last > cpu ? "%s%d-%d" : "%s%d", used ? "," : "", cpu, last);
+        cpu = last;
+    }
+}
+
+void placement_report(uint32_t nworkers)
+{
+    static const char *names[] = {"none", "compact", "scatter", "cores"};
+    printf("placement : %s\n", names[policy]);
+    for (uint32_t worker = 0; worker < nworkers && worker < MAX_WORKERS; ++worker)
+    {
+        const int cpu = worker_cpu[worker];
+        if (cpu < 0)
+        {
+            printf("  worker %u -> not started\n", worker);
+            continue;
+        }
+        char mask[256];
+        format_mask(&worker_mask[worker], mask, sizeof(mask));
+        const CPU_INFO *info = NULL;
+        for (int i = 0; i < cpu_count; ++i)
+        {
+            if (cpus[i].cpu == cpu)
+            {
+                info = &cpus[i];
+            }
+        }
+        if (info != NULL)
+        {
+            printf("  worker %u -> cpu %d (core %d, smt %d, socket %d, node %d), allowed %s\n",
+                   worker, cpu, info->core, info->smt, info->package, info->node, mask);
+        }
+        else
+        {
+            printf("  worker %u -> cpu %d, allowed %s\n", worker, cpu, mask);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef N_QUEENS_AFFINITY_H
+#define N_QUEENS_AFFINITY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Politiques de placement des threads sur les CPU :
+ *  - NONE    : aucun placement, le système choisit
+ *  - COMPACT : remplir les threads matériels d'un coeur, puis le coeur suivant
+ *  - SCATTER : répartir sur les sockets/noeuds NUMA d'abord, l'hyperthreading en dernier
+ *  - CORES   : un seul thread par coeur physique (pas de voisins SMT) */
+typedef enum placement_policy
+{
+    PLACEMENT_NONE,
+    PLACEMENT_COMPACT,
+    PLACEMENT_SCATTER,
+    PLACEMENT_CORES
+} PLACEMENT_POLICY;
+
+/* Convertir "none", "compact", "scatter" ou "cores" en politique */
+PLACEMENT_POLICY placement_policy_from_string(const char *name);
+
+/* Lire la topologie de la machine et préparer l'ordre des CPU selon la politique.
+ * Si policy vaut PLACEMENT_NONE, la variable d'environnement NQ_PLACEMENT est consultée. */
+void placement_init(PLACEMENT_POLICY policy);
+
+/* Fixer le thread appelant sur le CPU du travailleur `worker` ; renvoie le CPU ou -1 */
+int placement_bind_worker(uint32_t worker);
+
+/* Premier travailleur d'un processus de rang `node_rank` dans son noeud, qui a
+ * `nworkers` travailleurs : les processus qui se partagent les mêmes CPU en
+ * prennent des plages disjointes, un processus qui a déjà ses propres CPU
+ * (mpirun --bind-to, cgroups) commence au premier d'entre eux. Après placement_init. */
+uint32_t placement_first_worker(uint32_t node_rank, uint32_t nworkers);
+
+/* Allouer de la mémoire et la toucher depuis le thread appelant (first touch),
+ * pour qu'elle soit placée sur le noeud NUMA du travailleur */
+void *placement_alloc_local(size_t size);
+
+/* Afficher la correspondance effective travailleur -> CPU/coeur/socket/noeud
+ * et les CPU permis, telle que chaque travailleur l'a relevée (sched_getcpu,
+ * masque d'affinité) dans placement_bind_worker : à appeler une fois les
+ * travailleurs terminés */
+void placement_report(uint32_t nworkers);
+
+#endif
@@ -0,0 +1,318 @@
+#include "n_queens_bfs.h"
+#include "n_queens_core.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Parents handled together by the vector extraction: 8 x 32-bit masks, one AVX2 register
+#define BFS_LANES 8
+// Blocks of the parallel prefix sum, each at least this many parents
+#define SCAN_BLOCK 4096
+#define SCAN_MAX_BLOCKS 256
+// Bytes of one state in a level, and of the work arrays per parent (free rows, offset)
+#define STATE_BYTES (3 * sizeof(uint32_t))
+#define WORK_BYTES (sizeof(uint32_t) + sizeof(uint64_t))
+
+// Children of 8 parents of at most 32 rows, and the slot the empty lanes write to
+#define BFS_SCRATCH (BFS_LANES * 32)
+typedef uint32_t bfs_lanes_t __attribute__((vector_size(BFS_LANES * sizeof(uint32_t))));
+
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+static uint32_t full_mask(uint32_t n_queens)
+{
+    return n_queens >= 32 ? UINT32_MAX : (1u << n_queens) - 1;
+}
+
+static int bfs_threads(uint32_t threads)
+{
+#ifdef _OPENMP
+    return threads ? (int)threads : omp_get_max_threads();
+#else
+    (void)threads;
+    return 1;
+#endif
+}
+
+static void level_alloc(NQ_SOA_LEVEL *level, uint32_t depth, uint64_t count)
+{
+    level->depth = depth;
+    level->count = count;
+    // one block, the three arrays one after the other
+    level->cols = malloc(STATE_BYTES * (count ? count : 1));
+    if (level->cols == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for a breadth-first level of %llu states.\n",
+                (unsigned long long)count);
+        exit(EXIT_FAILURE);
+    }
+    level->diag_up = level->cols + count;
+    level->diag_down = level->diag_up + count;
+}
+
+void nq_soa_level_free(NQ_SOA_LEVEL *level)
+{
+    free(level->cols);
+    memset(level, 0, sizeof(NQ_SOA_LEVEL));
+}
+
+void nq_bfs_options_default(NQ_BFS_OPTIONS *options)
+{
+    options->memory_budget = 256ULL << 20;
+    options->max_depth = 0;
+    options->threads = 0;
+    options->simd = 1;
+}
+
+// Free rows of every parent, with the half-board symmetry on the first two columns
+static void free_rows(const NQ_SOA_LEVEL *level, uint32_t n_queens, int threads, uint32_t *restrict free)
+{
+    const uint32_t full = full_mask(n_queens);
+    const uint32_t *restrict cols = level->cols;
+    const uint32_t *restrict up = level->diag_up;
+    const uint32_t *restrict down = level->diag_down;
+    const uint64_t count = level->count;
+    // branch-free over contiguous arrays: the compiler turns it into vector code
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        free[i] = full & ~(cols[i] | up[i] | down[i]);
+    }
+    if (level->depth == 0)
+    {
+        free[0] &= (1u << ((n_queens + 1) / 2)) - 1;
+    }
+    else if (level->depth == 1 && (n_queens & 1))
+    {
+        // a first queen on the middle row: the second one above it
+        const uint32_t middle = n_queens >> 1;
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            if (cols[i] == 1u << middle)
+            {
+                free[i] &= (1u << middle) - 1;
+            }
+        }
+    }
+}
+
+// Exclusive prefix sum of the free-row counts; offsets[count] is the size of the next level
+static void child_offsets(const uint32_t *restrict free, uint64_t count, int threads, uint64_t *restrict offsets)
+{
+    uint64_t blocks = count / SCAN_BLOCK;
+    blocks = blocks < 1 ? 1 : (blocks > SCAN_MAX_BLOCKS ? SCAN_MAX_BLOCKS : blocks);
+    const uint64_t share = (count + blocks - 1) / blocks;
+    uint64_t sums[SCAN_MAX_BLOCKS + 1];
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (uint64_t b = 0; b < blocks; ++b)
+    {
+        const uint64_t end = (b + 1) * share < count ? (b + 1) * share : count;
+        uint64_t sum = 0;
+        for (uint64_t i = b * share; i < end; ++i)
+        {
+            sum += (uint64_t)__builtin_popcount(free[i]);
+        }
+        sums[b + 1] = sum;
+    }
+    sums[0] = 0;
+    for (uint64_t b = 0; b < blocks; ++b)
+    {
+        sums[b + 1] += sums[b];
+    }
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (uint64_t b = 0; b < blocks; ++b)
+    {
+        const uint64_t end = (b + 1) * share < count ? (b + 1) * share : count;
+        uint64_t offset = sums[b];
+        for (uint64_t i = b * share; i < end; ++i)
+        {
+            offsets[i] = offset;
+            offset += (uint64_t)__builtin_popcount(free[i]);
+        }
+    }
+    offsets[count] = sums[blocks];
+}
+
+// One child per free row, lowest row first, written at the parent's offset
+static void extract_scalar(const NQ_SOA_LEVEL *parents, const uint32_t *free, const uint64_t *offsets,
+                           uint64_t begin, uint64_t end, NQ_SOA_LEVEL *children)
+{
+    for (uint64_t i = begin; i < end; ++i)
+    {
+        const uint32_t cols = parents->cols[i], up = parents->diag_up[i], down = parents->diag_down[i];
+        uint32_t f = free[i];
+        uint64_t o = offsets[i];
+        while (f)
+        {
+            const uint32_t bit = f & -f;
+            f ^= bit;
+            children->cols[o] = cols | bit;
+            children->diag_up[o] = (up | bit) << 1;
+            children->diag_down[o] = (down | bit) >> 1;
+            ++o;
+        }
+    }
+}
+
+// Same children, 8 parents at a time: the lowest free bit and the three child
+// masks are computed for the 8 lanes in one vector, until every lane is empty;
+// the stores stay scalar (AVX2 has no scatter) but never branch
+static void extract_lanes(const NQ_SOA_LEVEL *parents, const uint32_t *free, const uint64_t *offsets,
+                          uint64_t begin, uint64_t end, NQ_SOA_LEVEL *children)
+{
+    uint64_t i = begin;
+    for (; i + BFS_LANES <= end; i += BFS_LANES)
+    {
+        bfs_lanes_t f, cols, up, down, position;
+        memcpy(&f, &free[i], sizeof(f));
+        memcpy(&cols, &parents->cols[i], sizeof(cols));
+        memcpy(&up, &parents->diag_up[i], sizeof(up));
+        memcpy(&down, &parents->diag_down[i], sizeof(down));
+        // positions relative to the first parent: at most 8 * 32 children
+        const uint64_t base = offsets[i];
+        for (int l = 0; l < BFS_LANES; ++l)
+        {
+            position[l] = (uint32_t)(offsets[i + l] - base);
+        }
+        // the children of the 8 parents are contiguous: staged here, then copied
+        uint32_t out_cols[BFS_SCRATCH + 1], out_up[BFS_SCRATCH + 1], out_down[BFS_SCRATCH + 1];
+        const bfs_lanes_t zero = {};
+        while (memcmp(&f, &zero, sizeof(f)) != 0)
+        {
+            const bfs_lanes_t bit = f & -f;
+            f ^= bit;
+            const bfs_lanes_t child_cols = cols | bit;
+            const bfs_lanes_t child_up = (up | bit) << 1;
+            const bfs_lanes_t child_down = (down | bit) >> 1;
+            // the empty lanes store into a scratch slot instead of branching
+            for (int l = 0; l < BFS_LANES; ++l)
+            {
+                const uint32_t slot = bit[l] ? position[l] : BFS_SCRATCH;
+                out_cols[slot] = child_cols[l];
+                out_up[slot] = child_up[l];
+                out_down[slot] = child_down[l];
+            }
+            // a comparison is -1 in the lanes where it holds
+            position -= (bfs_lanes_t)(bit != 0);
+        }
+        const uint64_t staged = offsets[i + BFS_LANES] - base;
+        memcpy(children->cols + base, out_cols, sizeof(uint32_t) * staged);
+        memcpy(children->diag_up + base, out_up, sizeof(uint32_t) * staged);
+        memcpy(children->diag_down + base, out_down, sizeof(uint32_t) * staged);
+    }
+    extract_scalar(parents, free, offsets, i, end, children);
+}
+
+void nq_soa_build(NQ_SOA_LEVEL *level, uint32_t n_queens, const NQ_BFS_OPTIONS *options, NQ_BFS_STATS *stats)
+{
+    if (n_queens < 1 || n_queens > NQ_BFS_MAX_N)
+    {
+        fprintf(stderr, "The breadth-first search handles 1 to %d queens.\n", NQ_BFS_MAX_N);
+        exit(EXIT_FAILURE);
+    }
+    const double start = now();
+    const int threads = bfs_threads(options->threads);
+    const uint32_t max_depth =
+        (options->max_depth == 0 || options->max_depth > n_queens) ? n_queens : options->max_depth;
+    memset(stats, 0, sizeof(NQ_BFS_STATS));
+
+    // the empty board
+    level_alloc(level, 0, 1);
+    level->cols[0] = level->diag_up[0] = level->diag_down[0] = 0;
+    stats->peak_bytes = STATE_BYTES;
+    while (level->depth < max_depth)
+    {
+        const uint64_t count = level->count;
+        uint32_t *free_masks = malloc(sizeof(uint32_t) * count);
+        uint64_t *offsets = malloc(sizeof(uint64_t) * (count + 1));
+        if (free_masks == NULL || offsets == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed for the breadth-first work arrays.\n");
+            exit(EXIT_FAILURE);
+        }
+        free_rows(level, n_queens, threads, free_masks);
+        child_offsets(free_masks, count, threads, offsets);
+
+        // the size of the next level is known before it is allocated
+        const uint64_t children = offsets[count];
+        const uint64_t bytes = (STATE_BYTES + WORK_BYTES) * count + STATE_BYTES * children;
+        if (bytes > options->memory_budget && level->depth > 0)
+        {
+            free(free_masks);
+            free(offsets);
+            break;
+        }
+        NQ_SOA_LEVEL next;
+        level_alloc(&next, level->depth + 1, children);
+        const uint64_t share = (count + threads - 1) / threads;
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for (int t = 0; t < threads; ++t)
+        {
+            const uint64_t begin = (uint64_t)t * share < count ? (uint64_t)t * share : count;
+            const uint64_t end = begin + share < count ? begin + share : count;
+            if (options->simd)
+            {
+                extract_lanes(level, free_masks, offsets, begin, end, &next);
+            }
+            else
+            {
+                extract_scalar(level, free_masks, offsets, begin, end, &next);
+            }
+        }
+        free(free_masks);
+        free(offsets);
+        nq_soa_level_free(level);
+        *level = next;
+        stats->bfs_placements += children;
+        if (children > stats->widest)
+        {
+            stats->widest = children;
+        }
+        if (bytes > stats->peak_bytes)
+        {
+            stats->peak_bytes = bytes;
+        }
+    }
+    stats->depth = level->depth;
+    stats->frontier = level->count;
+    stats->bfs_seconds = now() - start;
+}
+
+uint64_t nq_soa_count(const NQ_SOA_LEVEL *level, uint32_t n_queens, uint32_t threads, uint64_t *placements)
+{
+    const uint64_t full = full_mask(n_queens);
+    uint64_t solutions = 0, nodes = 0;
+    // subtrees of very different sizes: small dynamic chunks
+    #pragma omp parallel for schedule(dynamic, 16) reduction(+ : solutions, nodes) num_threads(bfs_threads(threads))
+    for (uint64_t i = 0; i < level->count; ++i)
+    {
+        uint64_t local = 0;
+        solutions += nq_bitboard_subtree(full, level->cols[i], level->diag_up[i], level->diag_down[i], &local);
+        nodes += local;
+    }
+    *placements = nodes;
+    return solutions;
+}
+
+uint64_t nq_bfs_count(uint32_t n_queens, const NQ_BFS_OPTIONS *options, NQ_BFS_STATS *stats)
+{
+    NQ_SOA_LEVEL level;
+    nq_soa_build(&level, n_queens, options, stats);
+    const double start = now();
+    const uint64_t half = nq_soa_count(&level, n_queens, options->threads, &stats->dfs_placements);
+    stats->dfs_seconds = now() - start;
+    nq_soa_level_free(&level);
+    // the mirror images of the half board; a single queen is its own mirror
+    return n_queens == 1 ? half : 2 * half;
+}
@@ -0,0 +1,64 @@
+#ifndef N_QUEENS_BFS_H
+#define N_QUEENS_BFS_H
+
+#include <stdint.h>
+
+/* Recherche en largeur puis en profondeur : l'échiquier est développé colonne
+ * par colonne tant que le niveau suivant tient dans un budget mémoire, puis
+ * chaque état du dernier niveau est fini par le noyau bitboard sur les
+ * threads OpenMP. Un niveau est une structure de tableaux (lignes occupées,
+ * diagonales montantes, diagonales descendantes dans trois tableaux
+ * contigus), et non des copies de CHESS_BOARD : 12 octets par état. Chaque
+ * niveau est développé en trois passes : masques des lignes libres et leur
+ * nombre de bits, somme préfixe de ces nombres (place des enfants de chaque
+ * parent), puis extraction des bits dans le niveau suivant. Symétrie de la
+ * demi-planche comme dans les autres programmes. */
+
+// masques de 32 bits
+#define NQ_BFS_MAX_N 32
+
+/* Un niveau du parcours en largeur */
+typedef struct nq_soa_level
+{
+    uint32_t depth; // colonnes déjà remplies
+    uint64_t count;
+    uint32_t *cols;
+    uint32_t *diag_up;
+    uint32_t *diag_down;
+} NQ_SOA_LEVEL;
+
+typedef struct nq_bfs_options
+{
+    uint64_t memory_budget; // octets pour les niveaux et les tableaux de travail
+    uint32_t max_depth;     // 0 : N
+    uint32_t threads;       // 0 : valeur par défaut d'OpenMP
+    int simd;               // extraction des bits sur 8 parents à la fois (extensions vectorielles de GCC)
+} NQ_BFS_OPTIONS;
+
+typedef struct nq_bfs_stats
+{
+    uint32_t depth;          // profondeur du dernier niveau
+    uint64_t frontier;       // états du dernier niveau
+    uint64_t widest;         // états du plus grand niveau
+    uint64_t bfs_placements; // reines placées en largeur (états créés)
+    uint64_t dfs_placements; // reines placées par le noyau en profondeur
+    uint64_t peak_bytes;     // mémoire la plus haute des niveaux et des tableaux de travail
+    double bfs_seconds;
+    double dfs_seconds;
+} NQ_BFS_STATS;
+
+/* 256 Mo, profondeur N au plus, threads d'OpenMP, extraction vectorielle */
+void nq_bfs_options_default(NQ_BFS_OPTIONS *options);
+
+/* Niveaux en largeur jusqu'au budget ; à libérer par nq_soa_level_free */
+void nq_soa_build(NQ_SOA_LEVEL *level, uint32_t n_queens, const NQ_BFS_OPTIONS *options, NQ_BFS_STATS *stats);
+void nq_soa_level_free(NQ_SOA_LEVEL *level);
+
+/* Nombre de solutions sous les états du niveau, chaque thread un bloc d'états
+ * fini en profondeur (sans la symétrie : la somme des sous-arbres) */
+uint64_t nq_soa_count(const NQ_SOA_LEVEL *level, uint32_t n_queens, uint32_t threads, uint64_t *placements);
+
+/* Nombre de solutions de l'échiquier, largeur puis profondeur */
+uint64_t nq_bfs_count(uint32_t n_queens, const NQ_BFS_OPTIONS *options, NQ_BFS_STATS *stats);
+
+#endif
@@ -0,0 +1,269 @@
+#include "n_queens_checkpoint.h"
+
+#include <glob.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CHECKPOINT_MAGIC "NQCKPT01"
+
+// set by the signal handler, the only state shared with it
+static volatile sig_atomic_t stop_requested = 0;
+
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+static void on_signal(int signal_number)
+{
+    (void)signal_number;
+    stop_requested = 1;
+}
+
+void nq_checkpoint_handle_signals(void)
+{
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGTERM, &action, NULL);
+    sigaction(SIGINT, &action, NULL);
+}
+
+int nq_checkpoint_stop_requested(void)
+{
+    return stop_requested != 0;
+}
+
+// Append the records of one journal to the loaded ones
+static int load_journal(NQ_CHECKPOINT *checkpoint, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        perror("Failed to open a checkpoint journal");
+        return 0;
+    }
+    NQ_CHECKPOINT_HEADER header;
+    if (fread(&header, sizeof(header), 1, file) != 1)
+    {
+        // created but never written: nothing to resume from it
+        fclose(file);
+        return 1;
+    }
+    if (memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 ||
+        (checkpoint->loaded_header.n_queens != 0 &&
+         (header.n_queens != checkpoint->loaded_header.n_queens || header.depth != checkpoint->loaded_header.depth)))
+    {
+        fprintf(stderr, "%s does not belong to the same count.\n", path);
+        fclose(file);
+        return 0;
+    }
+    checkpoint->loaded_header = header;
+
+    struct stat st;
+    fstat(fileno(file), &st);
+    // a record cut short by a crash is dropped
+    const uint64_t records = ((uint64_t)st.st_size - sizeof(header)) / sizeof(NQ_CHECKPOINT_RECORD);
+    checkpoint->loaded = realloc(checkpoint->loaded,
+                                 sizeof(NQ_CHECKPOINT_RECORD) * (checkpoint->loaded_count + records + 1));
+    if (checkpoint->loaded == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the checkpoint.\n");
+        exit(EXIT_FAILURE);
+    }
+    const size_t read = fread(&checkpoint->loaded[checkpoint->loaded_count], sizeof(NQ_CHECKPOINT_RECORD),
+                              records, file);
+    checkpoint->loaded_count += read;
+    fclose(file);
+    return 1;
+}
+
+// Cut the record (or header) that a crash left incomplete at the end of a
+// journal, so that the records appended after it start on a record boundary
+static int trim_journal(FILE *journal)
+{
+    struct stat st;
+    if (fstat(fileno(journal), &st) != 0)
+    {
+        return 0;
+    }
+    const uint64_t size = (uint64_t)st.st_size;
+    uint64_t whole = 0;
+    if (size >= sizeof(NQ_CHECKPOINT_HEADER))
+    {
+        whole = sizeof(NQ_CHECKPOINT_HEADER) +
+                (size - sizeof(NQ_CHECKPOINT_HEADER)) / sizeof(NQ_CHECKPOINT_RECORD) * sizeof(NQ_CHECKPOINT_RECORD);
+    }
+    return whole == size || ftruncate(fileno(journal), (off_t)whole) == 0;
+}
+
+NQ_CHECKPOINT *nq_checkpoint_open(const char *base, int rank, int resume, double interval)
+{
+    NQ_CHECKPOINT *checkpoint = calloc(1, sizeof(NQ_CHECKPOINT));
+    const size_t length = strlen(base) + 16;
+    char *path = malloc(length);
+    if (checkpoint == NULL || path == NULL || (checkpoint->base = strdup(base)) == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the checkpoint.\n");
+        exit(EXIT_FAILURE);
+    }
+    checkpoint->rank = rank;
+    checkpoint->resume = resume;
+    checkpoint->interval = interval;
+    pthread_mutex_init(&checkpoint->mutex, NULL);
+
+    if (resume)
+    {
+        // every journal of the earlier run, whatever its number of ranks
+        char *pattern = malloc(length);
+        glob_t journals;
+        if (pattern == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed for the checkpoint.\n");
+            exit(EXIT_FAILURE);
+        }
+        snprintf(pattern, length, "%s.*", base);
+        if (glob(pattern, 0, NULL, &journals) != 0)
+        {
+            journals.gl_pathc = 0;
+            journals.gl_pathv = NULL;
+        }
+        int loaded = 1;
+        for (size_t i = 0; i < journals.gl_pathc && loaded; ++i)
+        {
+            loaded = load_journal(checkpoint, journals.gl_pathv[i]);
+        }
+        if (journals.gl_pathv != NULL)
+        {
+            globfree(&journals);
+        }
+        free(pattern);
+        if (!loaded)
+        {
+            free(path);
+            nq_checkpoint_close(checkpoint);
+            return NULL;
+        }
+    }
+
+    // the records of this rank go after those of the earlier run, if any
+    snprintf(path, length, "%s.%d", base, rank);
+    checkpoint->journal = fopen(path, resume ? "ab" : "wb");
+    if (checkpoint->journal == NULL || (resume && !trim_journal(checkpoint->journal)))
+    {
+        perror("Failed to open the checkpoint journal");
+        free(path);
+        nq_checkpoint_close(checkpoint);
+        return NULL;
+    }
+    free(path);
+    checkpoint->last_flush = now();
+    return checkpoint;
+}
+
+int nq_checkpoint_begin(NQ_CHECKPOINT *checkpoint, uint32_t n_queens, uint32_t depth, uint64_t prefixes)
+{
+    const NQ_CHECKPOINT_HEADER *loaded = &checkpoint->loaded_header;
+    if (loaded->n_queens != 0 &&
+        (loaded->n_queens != n_queens || loaded->depth != depth || loaded->prefixes != prefixes))
+    {
+        fprintf(stderr, "The checkpoint is of N = %u at depth %u, not N = %u at depth %u.\n",
+                loaded->n_queens, loaded->depth, n_queens, depth);
+        return -1;
+    }
+    checkpoint->prefixes = prefixes;
+    checkpoint->done = calloc(prefixes / 8 + 1, 1);
+    if (checkpoint->done == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the checkpoint.\n");
+        exit(EXIT_FAILURE);
+    }
+    // a prefix may appear in several journals (a rank resumed twice), count it once
+    for (uint64_t i = 0; i < checkpoint->loaded_count; ++i)
+    {
+        const NQ_CHECKPOINT_RECORD *record = &checkpoint->loaded[i];
+        if (record->prefix < prefixes && !nq_checkpoint_done(checkpoint, record->prefix))
+        {
+            checkpoint->done[record->prefix / 8] |= (uint8_t)(1u << (record->prefix % 8));
+            ++checkpoint->resumed_prefixes;
+            checkpoint->resumed_solutions += record->solutions;
+            checkpoint->resumed_placements += record->placements;
+        }
+    }
+    free(checkpoint->loaded);
+    checkpoint->loaded = NULL;
+    checkpoint->loaded_count = 0;
+
+    // an empty journal starts with the header
+    fseek(checkpoint->journal, 0, SEEK_END);
+    if (ftell(checkpoint->journal) == 0)
+    {
+        NQ_CHECKPOINT_HEADER header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+        header.n_queens = n_queens;
+        header.depth = depth;
+        header.prefixes = prefixes;
+        fwrite(&header, sizeof(header), 1, checkpoint->journal);
+        nq_checkpoint_flush(checkpoint);
+    }
+    return 0;
+}
+
+int nq_checkpoint_done(const NQ_CHECKPOINT *checkpoint, uint64_t prefix)
+{
+    return (checkpoint->done[prefix / 8] >> (prefix % 8)) & 1;
+}
+
+static void flush_locked(NQ_CHECKPOINT *checkpoint)
+{
+    if (fflush(checkpoint->journal) != 0 || fsync(fileno(checkpoint->journal)) != 0)
+    {
+        perror("Failed to write the checkpoint journal");
+    }
+    checkpoint->last_flush = now();
+}
+
+void nq_checkpoint_record(NQ_CHECKPOINT *checkpoint, uint64_t prefix, uint64_t solutions, uint64_t placements)
+{
+    const NQ_CHECKPOINT_RECORD record = {prefix, solutions, placements};
+    pthread_mutex_lock(&checkpoint->mutex);
+    if (fwrite(&record, sizeof(record), 1, checkpoint->journal) != 1)
+    {
+        perror("Failed to write the checkpoint journal");
+    }
+    ++checkpoint->recorded;
+    if (now() - checkpoint->last_flush >= checkpoint->interval)
+    {
+        flush_locked(checkpoint);
+    }
+    pthread_mutex_unlock(&checkpoint->mutex);
+}
+
+void nq_checkpoint_flush(NQ_CHECKPOINT *checkpoint)
+{
+    pthread_mutex_lock(&checkpoint->mutex);
+    flush_locked(checkpoint);
+    pthread_mutex_unlock(&checkpoint->mutex);
+}
+
+void nq_checkpoint_close(NQ_CHECKPOINT *checkpoint)
+{
+    if (checkpoint->journal != NULL)
+    {
+        nq_checkpoint_flush(checkpoint);
+        fclose(checkpoint->journal);
+    }
+    pthread_mutex_destroy(&checkpoint->mutex);
+    free(checkpoint->loaded);
+    free(checkpoint->done);
+    free(checkpoint->base);
+    free(checkpoint);
+}
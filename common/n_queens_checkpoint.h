@@ -0,0 +1,86 @@
+#ifndef N_QUEENS_CHECKPOINT_H
+#define N_QUEENS_CHECKPOINT_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Points de reprise d'un long comptage : chaque préfixe terminé (son numéro
+ * dans le frontier et ses comptes) est ajouté à un journal, écrit sur disque
+ * au plus tard toutes les `interval` secondes. Une reprise relit les journaux,
+ * saute les préfixes déjà comptés et repart de leur somme.
+ *
+ * Chaque processus MPI écrit son propre journal `<base>.<rang>` ; une reprise
+ * relit tous les journaux `<base>.*`, quel que soit le nombre de processus
+ * d'avant. Les numéros de préfixe ne dépendent que de N et de la profondeur,
+ * qui sont vérifiées à la reprise. Tous les processus doivent avoir relu les
+ * journaux avant que l'un d'eux n'y ajoute : le backend MPI de nq_solve les
+ * attend tous (MPI_Barrier) avant de compter.
+ *
+ * Fichier : un en-tête, puis des enregistrements de 24 octets ajoutés à la
+ * fin ; un enregistrement coupé par un arrêt brutal est ignoré, et retiré du
+ * journal à la reprise pour que les suivants restent alignés. */
+
+typedef struct nq_checkpoint_header
+{
+    char magic[8];
+    uint32_t n_queens;
+    uint32_t depth;
+    uint64_t prefixes;
+} NQ_CHECKPOINT_HEADER;
+
+typedef struct nq_checkpoint_record
+{
+    uint64_t prefix;
+    uint64_t solutions;
+    uint64_t placements;
+} NQ_CHECKPOINT_RECORD;
+
+typedef struct nq_checkpoint
+{
+    char *base;
+    int rank;
+    int resume;
+    FILE *journal;
+    double interval;
+    double last_flush;
+    pthread_mutex_t mutex;
+    // enregistrements relus des journaux, vérifiés par nq_checkpoint_begin
+    NQ_CHECKPOINT_HEADER loaded_header;
+    NQ_CHECKPOINT_RECORD *loaded;
+    uint64_t loaded_count;
+    // préfixes terminés (un bit par préfixe) et leur somme
+    uint8_t *done;
+    uint64_t prefixes;
+    uint64_t resumed_prefixes;
+    uint64_t resumed_solutions;
+    uint64_t resumed_placements;
+    uint64_t recorded;
+} NQ_CHECKPOINT;
+
+/* Ouvrir le journal du processus `rank` ; avec `resume`, relire les journaux
+ * existants, sinon repartir d'un journal vide. NULL si un journal est illisible. */
+NQ_CHECKPOINT *nq_checkpoint_open(const char *base, int rank, int resume, double interval);
+
+/* Fixer le comptage (N, profondeur, nombre de préfixes du frontier) ; -1 si
+ * les journaux relus viennent d'un autre comptage */
+int nq_checkpoint_begin(NQ_CHECKPOINT *checkpoint, uint32_t n_queens, uint32_t depth, uint64_t prefixes);
+
+/* Le préfixe a-t-il été compté avant la reprise ? */
+int nq_checkpoint_done(const NQ_CHECKPOINT *checkpoint, uint64_t prefix);
+
+/* Ajouter un préfixe terminé au journal (écrit sur disque si l'intervalle est écoulé) */
+void nq_checkpoint_record(NQ_CHECKPOINT *checkpoint, uint64_t prefix, uint64_t solutions, uint64_t placements);
+
+/* Écrire le journal sur disque (fflush + fsync) */
+void nq_checkpoint_flush(NQ_CHECKPOINT *checkpoint);
+
+/* Écrire le journal sur disque et le fermer */
+void nq_checkpoint_close(NQ_CHECKPOINT *checkpoint);
+
+/* Intercepter SIGTERM et SIGINT : le comptage ne commence plus de nouveau
+ * préfixe, finit ceux en cours et rend la main pour écrire le journal */
+void nq_checkpoint_handle_signals(void);
+int nq_checkpoint_stop_requested(void);
+
+#endif
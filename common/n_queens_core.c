@@ -0,0 +1,568 @@
+#include "n_queens_core.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Lanes of the SIMD kernel: 8 x 32-bit masks, one AVX2 register
+#define SIMD_LANES 8
+// The per-lane 32-bit counters are flushed into 64-bit totals this often
+#define SIMD_FLUSH (1u << 30)
+
+typedef uint32_t lanes_t __attribute__((vector_size(SIMD_LANES * sizeof(uint32_t))));
+
+void initialize_board(const uint32_t n_queens, CHESS_BOARD **board, uint64_t start, uint64_t end)
+{
+    if (n_queens < 1)
+    {
+        fprintf(stderr, "The number of queens must be greater than 0.\n");
+        exit(EXIT_SUCCESS);
+    }
+
+    // Dynamically allocate memory for chessboard struct
+    *board = malloc(sizeof(CHESS_BOARD));
+    if (*board == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for chess board.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Dynamically allocate memory for chessboard arrays that track positions
+    const uint32_t diagonal_size = 2 * n_queens - 1;
+    const uint32_t total_size = 2 * (n_queens + diagonal_size);
+    (*board)->queen_positions = malloc(sizeof(uint32_t) * total_size);
+    if ((*board)->queen_positions == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the chess board arrays.\n");
+        free(*board);
+        exit(EXIT_FAILURE);
+    }
+    (*board)->column = &(*board)->queen_positions[n_queens];
+    (*board)->diagonal_up = &(*board)->column[n_queens];
+    (*board)->diagonal_down = &(*board)->diagonal_up[diagonal_size];
+
+    // Initialize the chess board parameters
+    (*board)->n_size = n_queens;
+    for (uint32_t i = 0; i < n_queens; ++i)
+    {
+        (*board)->queen_positions[i] = 0;
+    }
+    for (uint32_t i = n_queens; i < total_size; ++i)
+    {
+        // Initializes values for column, diagonal_up, and diagonal_down
+        (*board)->queen_positions[i] = 1;
+    }
+    (*board)->column_j = 0;
+    (*board)->placements = 0;
+    (*board)->solutions = 0;
+    (*board)->start = start;
+    (*board)->end = end;
+}
+
+void smash_board(CHESS_BOARD *board)
+{
+    // Free dynamically allocated memory
+    free(board->queen_positions);
+    free(board);
+}
+
+CHESS_BOARD *copyBoard(const CHESS_BOARD *board)
+{
+    CHESS_BOARD *copy;
+    initialize_board(board->n_size, &copy, board->start, board->end);
+    const uint32_t total_size = 2 * (board->n_size + 2 * board->n_size - 1);
+    memcpy(copy->queen_positions, board->queen_positions, sizeof(uint32_t) * total_size);
+    copy->column_j = board->column_j;
+    copy->placements = board->placements;
+    return copy;
+}
+
+NQ_KERNEL nq_kernel_from_string(const char *name)
+{
+    if (name == NULL || strcmp(name, "bitboard") == 0)
+    {
+        return NQ_KERNEL_BITBOARD;
+    }
+    if (strcmp(name, "array") == 0)
+    {
+        return NQ_KERNEL_ARRAY;
+    }
+    if (strcmp(name, "simd") == 0)
+    {
+        return NQ_KERNEL_SIMD;
+    }
+    if (strcmp(name, "interleaved") == 0)
+    {
+        return NQ_KERNEL_INTERLEAVED;
+    }
+    fprintf(stderr, "Unknown kernel '%s', using bitboard.\n", name);
+    return NQ_KERNEL_BITBOARD;
+}
+
+static uint64_t array_subtree(CHESS_BOARD *board)
+{
+    if (board->column_j == board->n_size)
+    {
+        return 1;
+    }
+    uint64_t solutions = 0;
+    for (uint32_t row_i = 0; row_i < board->n_size; ++row_i)
+    {
+        if (square_is_free(row_i, board))
+        {
+            set_queen(row_i, board);
+            solutions += array_subtree(board);
+            remove_queen(row_i, board);
+        }
+    }
+    return solutions;
+}
+
+uint64_t nq_bitboard_subtree(uint64_t full, uint64_t cols, uint64_t diag_up, uint64_t diag_down,
+                             uint64_t *placements)
+{
+    if (cols == full)
+    {
+        return 1;
+    }
+    uint64_t solutions = 0;
+    uint64_t free_rows = full & ~(cols | diag_up | diag_down);
+    while (free_rows)
+    {
+        const uint64_t bit = free_rows & -free_rows;
+        free_rows ^= bit;
+        ++*placements;
+        solutions += nq_bitboard_subtree(full, cols | bit, (diag_up | bit) << 1, (diag_down | bit) >> 1, placements);
+    }
+    return solutions;
+}
+
+// Bitboard masks of a prefix; returns 0 when two of its queens attack each other
+static int prefix_masks(uint32_t n_queens, const uint32_t *prefix, uint32_t depth, uint64_t *cols,
+                        uint64_t *diag_up, uint64_t *diag_down)
+{
+    *cols = *diag_up = *diag_down = 0;
+    for (uint32_t j = 0; j < depth; ++j)
+    {
+        const uint64_t bit = 1ULL << prefix[j];
+        if (prefix[j] >= n_queens || ((*cols | *diag_up | *diag_down) & bit))
+        {
+            return 0;
+        }
+        *cols |= bit;
+        *diag_up = (*diag_up | bit) << 1;
+        *diag_down = (*diag_down | bit) >> 1;
+    }
+    return 1;
+}
+
+static int lanes_empty(const lanes_t *lanes)
+{
+    uint32_t any = 0;
+    for (int i = 0; i < SIMD_LANES; ++i)
+    {
+        any |= (*lanes)[i];
+    }
+    return any == 0;
+}
+
+static uint64_t lanes_sum(const lanes_t *lanes)
+{
+    uint64_t sum = 0;
+    for (int i = 0; i < SIMD_LANES; ++i)
+    {
+        sum += (*lanes)[i];
+    }
+    return sum;
+}
+
+// Depth-first search of up to 8 subtrees in lockstep: every lane places its
+// next queen in the same column, lanes without a free row wait (masked) until
+// the walk comes back up to a column where they have one
+static uint64_t simd_subtrees(uint32_t n_queens, uint32_t depth, const lanes_t *cols0, const lanes_t *up0,
+                              const lanes_t *down0, const lanes_t *live, uint64_t *placements)
+{
+    const uint32_t full_mask = n_queens == 32 ? ~0u : (1u << n_queens) - 1;
+    const lanes_t full = full_mask - (lanes_t){};
+    lanes_t cols[NQ_CORE_MAX_N + 1], up[NQ_CORE_MAX_N + 1], down[NQ_CORE_MAX_N + 1], free_rows[NQ_CORE_MAX_N + 1];
+    lanes_t found = {}, visited = {};
+    uint64_t solutions = 0;
+    uint32_t steps = 0;
+
+    cols[depth] = *cols0;
+    up[depth] = *up0;
+    down[depth] = *down0;
+    free_rows[depth] = full & ~(cols[depth] | up[depth] | down[depth]) & *live;
+    uint32_t d = depth;
+    while (1)
+    {
+        const lanes_t f = free_rows[d];
+        if (lanes_empty(&f))
+        {
+            if (d == depth)
+            {
+                break;
+            }
+            --d;
+            continue;
+        }
+        const lanes_t bit = f & -f;
+        free_rows[d] = f ^ bit;
+        // -1 in the lanes that placed a queen, 0 elsewhere
+        const lanes_t active = (lanes_t)(bit != 0);
+        visited -= active;
+        if (d + 1 == n_queens)
+        {
+            found -= active;
+        }
+        else
+        {
+            cols[d + 1] = cols[d] | bit;
+            up[d + 1] = (up[d] | bit) << 1;
+            down[d + 1] = (down[d] | bit) >> 1;
+            free_rows[d + 1] = full & ~(cols[d + 1] | up[d + 1] | down[d + 1]) & active;
+            ++d;
+        }
+        if (++steps == SIMD_FLUSH)
+        {
+            solutions += lanes_sum(&found);
+            *placements += lanes_sum(&visited);
+            found = (lanes_t){};
+            visited = (lanes_t){};
+            steps = 0;
+        }
+    }
+    *placements += lanes_sum(&visited);
+    return solutions + lanes_sum(&found);
+}
+
+// One walk of the interleaved kernel: the explicit stack of the columns below its prefix
+typedef struct interleaved_walk
+{
+    int32_t top; // stack level of the next step, -1 once the prefix is done
+    uint64_t free_rows[NQ_CORE_MAX_N + 1];
+    uint64_t cols[NQ_CORE_MAX_N + 1];
+    uint64_t diag_up[NQ_CORE_MAX_N + 1];
+    uint64_t diag_down[NQ_CORE_MAX_N + 1];
+} INTERLEAVED_WALK;
+
+// Next valid prefix onto the walk; complete prefixes are counted on the way.
+// 0 once the prefixes are exhausted.
+static int walk_load(INTERLEAVED_WALK *walk, uint32_t n_queens, const uint32_t *prefixes, uint32_t stride,
+                     uint64_t count, uint32_t depth, uint64_t *next, uint64_t *solutions)
+{
+    const uint64_t full = (1ULL << n_queens) - 1;
+    while (*next < count)
+    {
+        uint64_t cols, diag_up, diag_down;
+        if (!prefix_masks(n_queens, &prefixes[*next * stride], depth, &cols, &diag_up, &diag_down))
+        {
+            ++*next;
+            continue;
+        }
+        ++*next;
+        if (cols == full)
+        {
+            ++*solutions;
+            continue;
+        }
+        walk->top = 0;
+        walk->cols[0] = cols;
+        walk->diag_up[0] = diag_up;
+        walk->diag_down[0] = diag_down;
+        walk->free_rows[0] = full & ~(cols | diag_up | diag_down);
+        return 1;
+    }
+    return 0;
+}
+
+// One step of a walk without a branch: place the next queen of the top column
+// and push the child, or pop when the column has no row left. The child is
+// written even on a pop, where it is never read.
+static inline uint64_t walk_step(INTERLEAVED_WALK *walk, uint64_t full, uint64_t *solutions)
+{
+    const int32_t top = walk->top;
+    const uint64_t f = walk->free_rows[top];
+    const uint64_t bit = f & -f;
+    walk->free_rows[top] = f ^ bit;
+    const uint64_t cols = walk->cols[top] | bit;
+    const uint64_t diag_up = (walk->diag_up[top] | bit) << 1;
+    const uint64_t diag_down = (walk->diag_down[top] | bit) >> 1;
+    walk->cols[top + 1] = cols;
+    walk->diag_up[top + 1] = diag_up;
+    walk->diag_down[top + 1] = diag_down;
+    // a complete board has no free row: the next step pops it
+    walk->free_rows[top + 1] = full & ~(cols | diag_up | diag_down);
+    const uint64_t placed = f != 0;
+    *solutions += placed & (cols == full);
+    walk->top = top + 2 * (int32_t)placed - 1;
+    return placed;
+}
+
+uint64_t nq_interleaved_prefixes(uint32_t n_queens, const uint32_t *prefixes, uint32_t stride, uint64_t count,
+                                 uint32_t depth, uint32_t walks, uint64_t *placements)
+{
+    if (n_queens < 1 || n_queens > NQ_CORE_MAX_N || depth > n_queens)
+    {
+        fprintf(stderr, "The number of queens must be between 1 and %d.\n", NQ_CORE_MAX_N);
+        exit(EXIT_FAILURE);
+    }
+    if (walks < 1 || walks > NQ_INTERLEAVE_MAX_WALKS)
+    {
+        fprintf(stderr, "The interleaved kernel runs 1 to %d walks.\n", NQ_INTERLEAVE_MAX_WALKS);
+        exit(EXIT_FAILURE);
+    }
+    INTERLEAVED_WALK *stacks = malloc(sizeof(INTERLEAVED_WALK) * walks);
+    if (stacks == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the interleaved walks.\n");
+        exit(EXIT_FAILURE);
+    }
+    const uint64_t full = (1ULL << n_queens) - 1;
+    uint64_t solutions = 0, visited = 0, next = 0;
+
+    // the live walks come first; a walk without a prefix left is swapped out
+    INTERLEAVED_WALK *live[NQ_INTERLEAVE_MAX_WALKS];
+    uint32_t active = 0;
+    for (uint32_t k = 0; k < walks; ++k)
+    {
+        if (walk_load(&stacks[k], n_queens, prefixes, stride, count, depth, &next, &solutions))
+        {
+            live[active++] = &stacks[k];
+        }
+    }
+    while (active > 0)
+    {
+        for (uint32_t k = 0; k < active; ++k)
+        {
+            visited += walk_step(live[k], full, &solutions);
+            if (live[k]->top < 0 &&
+                !walk_load(live[k], n_queens, prefixes, stride, count, depth, &next, &solutions))
+            {
+                live[k--] = live[--active];
+            }
+        }
+    }
+    free(stacks);
+    *placements += visited;
+    return solutions;
+}
+
+uint64_t nq_count_prefixes(NQ_KERNEL kernel, uint32_t n_queens, const uint32_t *prefixes, uint32_t stride,
+                           uint64_t count, uint32_t depth, uint64_t *placements)
+{
+    if (n_queens < 1 || n_queens > NQ_CORE_MAX_N || depth > n_queens)
+    {
+        fprintf(stderr, "The number of queens must be between 1 and %d.\n", NQ_CORE_MAX_N);
+        exit(EXIT_FAILURE);
+    }
+    const uint64_t full = (1ULL << n_queens) - 1;
+    uint64_t solutions = 0;
+
+    if (kernel == NQ_KERNEL_ARRAY)
+    {
+        CHESS_BOARD *board;
+        initialize_board(n_queens, &board, 0, n_queens);
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            const uint32_t *prefix = &prefixes[i * stride];
+            uint32_t j = 0;
+            while (j < depth && prefix[j] < n_queens && square_is_free(prefix[j], board))
+            {
+                set_queen(prefix[j++], board);
+            }
+            // only the queens below the prefix are counted
+            board->placements = 0;
+            if (j == depth)
+            {
+                solutions += array_subtree(board);
+            }
+            *placements += board->placements;
+            while (j > 0)
+            {
+                --j;
+                remove_queen(prefix[j], board);
+            }
+        }
+        smash_board(board);
+        return solutions;
+    }
+
+    if (kernel == NQ_KERNEL_INTERLEAVED)
+    {
+        return nq_interleaved_prefixes(n_queens, prefixes, stride, count, depth, NQ_INTERLEAVE_WALKS, placements);
+    }
+
+    if (kernel == NQ_KERNEL_BITBOARD)
+    {
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            uint64_t cols, diag_up, diag_down;
+            if (prefix_masks(n_queens, &prefixes[i * stride], depth, &cols, &diag_up, &diag_down))
+            {
+                solutions += nq_bitboard_subtree(full, cols, diag_up, diag_down, placements);
+            }
+        }
+        return solutions;
+    }
+
+    // SIMD: batches of 8 valid prefixes, the padding lanes are not live
+    uint64_t i = 0;
+    while (i < count)
+    {
+        lanes_t cols = {}, up = {}, down = {}, live = {};
+        int lane = 0;
+        for (; i < count && lane < SIMD_LANES; ++i)
+        {
+            uint64_t c, u, d;
+            if (prefix_masks(n_queens, &prefixes[i * stride], depth, &c, &u, &d))
+            {
+                cols[lane] = (uint32_t)c;
+                // the diagonals only matter on the board rows
+                up[lane] = (uint32_t)(u & full);
+                down[lane] = (uint32_t)d;
+                live[lane] = ~0u;
+                ++lane;
+            }
+        }
+        if (lane == 0)
+        {
+            continue;
+        }
+        if (depth == n_queens)
+        {
+            solutions += (uint64_t)lane;
+            continue;
+        }
+        solutions += simd_subtrees(n_queens, depth, &cols, &up, &down, &live, placements);
+    }
+    return solutions;
+}
+
+uint64_t nq_half_board_prefixes(uint32_t n_queens, uint32_t (*prefixes)[2], uint64_t *placements)
+{
+    uint64_t count = 0;
+    for (uint32_t first = 0; first < (n_queens + 1) >> 1; ++first)
+    {
+        ++*placements;
+        const uint32_t limit = ((n_queens & 1) && first == n_queens >> 1) ? n_queens >> 1 : n_queens;
+        for (uint32_t second = 0; second < limit; ++second)
+        {
+            if (second + 1 < first || second > first + 1)
+            {
+                ++*placements;
+                prefixes[count][0] = first;
+                prefixes[count][1] = second;
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+uint64_t nq_count(NQ_KERNEL kernel, uint32_t n_queens, uint64_t *placements)
+{
+    if (n_queens == 1)
+    {
+        ++*placements;
+        return 1;
+    }
+
+    // The prefixes of the half board: first queen in the upper half, and when
+    // it sits on the middle row (odd N), the second one above it
+    uint32_t prefixes[NQ_CORE_MAX_N * NQ_CORE_MAX_N][2];
+    const uint64_t count = nq_half_board_prefixes(n_queens, prefixes, placements);
+    return 2 * nq_count_prefixes(kernel, n_queens, &prefixes[0][0], 2, count, 2, placements);
+}
+
+uint32_t nq_half_board_limit(const CHESS_BOARD *board)
+{
+    if (board->column_j == 0)
+    {
+        return (board->n_size >> 1) + (board->n_size & 1);
+    }
+    if (board->column_j == 1 && board->queen_positions[0] == board->n_size >> 1)
+    {
+        return board->n_size >> 1;
+    }
+    return board->n_size;
+}
+
+void nq_half_board_expand(CHESS_BOARD *board, uint32_t depth, uint32_t stride, uint32_t **prefixes,
+                          uint64_t *count, uint64_t *capacity)
+{
+    if (board->column_j == depth || board->column_j == board->n_size)
+    {
+        if (*count == *capacity)
+        {
+            *capacity = *capacity ? 2 * *capacity : 64;
+            *prefixes = realloc(*prefixes, sizeof(uint32_t) * stride * *capacity);
+            if (*prefixes == NULL)
+            {
+                fprintf(stderr, "Memory allocation failed for the frontier.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        uint32_t *prefix = &(*prefixes)[*count * stride];
+        memset(prefix, 0, sizeof(uint32_t) * stride);
+        memcpy(prefix, board->queen_positions, sizeof(uint32_t) * board->column_j);
+        ++*count;
+        return;
+    }
+    const uint32_t limit = nq_half_board_limit(board);
+    for (uint32_t row_i = 0; row_i < limit; ++row_i)
+    {
+        if (square_is_free(row_i, board))
+        {
+            set_queen(row_i, board);
+            nq_half_board_expand(board, depth, stride, prefixes, count, capacity);
+            remove_queen(row_i, board);
+        }
+    }
+}
+
+// Solutions under the queens on the board, 2 for each; the first two columns
+// keep the half-board limits, the kernel takes over below them
+static void half_board_subtree(NQ_KERNEL kernel, CHESS_BOARD *board)
+{
+    if (board->column_j == board->n_size)
+    {
+        board->solutions += 2;
+        return;
+    }
+    if (board->column_j >= 2)
+    {
+        board->solutions += 2 * (kernel == NQ_KERNEL_ARRAY
+                                     ? array_subtree(board)
+                                     : nq_count_prefixes(kernel, board->n_size, board->queen_positions, 0, 1,
+                                                         board->column_j, &board->placements));
+        return;
+    }
+    const uint32_t limit = nq_half_board_limit(board);
+    for (uint32_t row_i = 0; row_i < limit; ++row_i)
+    {
+        if (square_is_free(row_i, board))
+        {
+            set_queen(row_i, board);
+            half_board_subtree(kernel, board);
+            remove_queen(row_i, board);
+        }
+    }
+}
+
+void nq_half_board_solve(NQ_KERNEL kernel, const uint32_t *prefix, uint32_t depth, CHESS_BOARD *board)
+{
+    if (depth > board->n_size)
+    {
+        depth = board->n_size;
+    }
+    for (uint32_t j = 0; j < depth; ++j)
+    {
+        set_queen(prefix[j], board);
+    }
+    half_board_subtree(kernel, board);
+    for (uint32_t j = depth; j > 0; --j)
+    {
+        remove_queen(prefix[j - 1], board);
+    }
+}
@@ -0,0 +1,137 @@
+#ifndef N_QUEENS_CORE_H
+#define N_QUEENS_CORE_H
+
+#include <stdint.h>
+
+/* Noyau commun à tous les programmes : l'échiquier en tableaux et ses
+ * opérations, et plusieurs noyaux de comptage derrière une même interface. */
+
+#define NQ_CORE_MAX_N 32
+
+/* Échiquier N x N en tableaux : une case à 1 dans column / diagonal_up /
+ * diagonal_down est libre. Les quatre tableaux sont alloués d'un seul bloc
+ * à partir de queen_positions. */
+typedef struct chess_board
+{
+    uint32_t n_size;           // Number of queens on the NxN chess board
+    uint32_t *queen_positions; // Store queen positions on the board
+    uint32_t *column;          // Store available column moves/attacks
+    uint32_t *diagonal_up;     // Store available diagonal moves/attacks
+    uint32_t *diagonal_down;
+    uint32_t column_j;   // Stores column to place the next queen in
+    uint64_t placements; // Tracks total number queen placements
+    uint64_t solutions;  // Tracks number of solutions
+    // lignes [start, end) à essayer dans la colonne column_j (programmes à tâches)
+    uint64_t start;
+    uint64_t end;
+} CHESS_BOARD;
+
+/* Initialiser un échiquier n_queens x n_queens vide */
+void initialize_board(const uint32_t n_queens, CHESS_BOARD **board, uint64_t start, uint64_t end);
+
+/* Détruire l'échiquier en libérant l'espace mémoire */
+void smash_board(CHESS_BOARD *board);
+
+/* Créer une copie de l'échiquier (solutions remises à 0) */
+CHESS_BOARD *copyBoard(const CHESS_BOARD *board);
+
+/* Vérifier si une case de la colonne column_j est libre */
+static inline uint32_t square_is_free(const uint32_t row_i, const CHESS_BOARD *board)
+{
+    return board->column[row_i] &
+           board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] &
+           board->diagonal_down[board->column_j + row_i];
+}
+
+/* Placer une reine dans la colonne column_j et passer à la suivante */
+static inline void set_queen(const uint32_t row_i, CHESS_BOARD *board)
+{
+    board->queen_positions[board->column_j] = row_i;
+    board->column[row_i] = 0;
+    board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] = 0;
+    board->diagonal_down[board->column_j + row_i] = 0;
+    ++board->column_j;
+    ++board->placements;
+}
+
+/* Retirer la reine de la colonne précédente */
+static inline void remove_queen(const uint32_t row_i, CHESS_BOARD *board)
+{
+    --board->column_j;
+    board->diagonal_down[board->column_j + row_i] = 1;
+    board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] = 1;
+    board->column[row_i] = 1;
+}
+
+/* Noyaux de comptage :
+ *  - ARRAY    : l'échiquier en tableaux ci-dessus
+ *  - BITBOARD : lignes et diagonales occupées en masques de bits
+ *  - SIMD     : masques de bits, 8 préfixes parcourus en parallèle dans un vecteur
+ *  - INTERLEAVED : masques de bits, NQ_INTERLEAVE_WALKS parcours indépendants
+ *    sur des piles explicites, avancés d'un pas chacun à tour de rôle */
+typedef enum nq_kernel
+{
+    NQ_KERNEL_ARRAY,
+    NQ_KERNEL_BITBOARD,
+    NQ_KERNEL_SIMD,
+    NQ_KERNEL_INTERLEAVED
+} NQ_KERNEL;
+
+/* Parcours entrelacés du noyau INTERLEAVED ; la meilleure valeur dépend du
+ * processeur (n_queens_interleave_tune la mesure), à fixer avec -DNQ_INTERLEAVE_WALKS=k */
+#ifndef NQ_INTERLEAVE_WALKS
+#define NQ_INTERLEAVE_WALKS 4
+#endif
+#define NQ_INTERLEAVE_MAX_WALKS 32
+
+/* Convertir "array", "bitboard", "simd" ou "interleaved" en noyau */
+NQ_KERNEL nq_kernel_from_string(const char *name);
+
+/* Nombre de solutions sous un masque de bitboard (lignes occupées, diagonales
+ * décalées d'une colonne à l'autre) ; chaque reine posée compte dans placements */
+uint64_t nq_bitboard_subtree(uint64_t full, uint64_t cols, uint64_t diag_up, uint64_t diag_down,
+                             uint64_t *placements);
+
+/* Nombre de solutions qui prolongent chacun des `count` préfixes de `depth`
+ * colonnes (le préfixe i commence à prefixes[i * stride]), sans symétrie.
+ * Un préfixe invalide ne compte aucune solution. */
+uint64_t nq_count_prefixes(NQ_KERNEL kernel, uint32_t n_queens, const uint32_t *prefixes, uint32_t stride,
+                           uint64_t count, uint32_t depth, uint64_t *placements);
+
+/* Comme nq_count_prefixes avec le noyau INTERLEAVED, mais `walks` parcours
+ * (1 à NQ_INTERLEAVE_MAX_WALKS) : un parcours qui finit son préfixe prend le
+ * suivant. Chaque pas est sans branche (sauf la fin d'un préfixe), et les pas
+ * des autres parcours, indépendants, remplissent les attentes de celui-ci. */
+uint64_t nq_interleaved_prefixes(uint32_t n_queens, const uint32_t *prefixes, uint32_t stride, uint64_t count,
+                                 uint32_t depth, uint32_t walks, uint64_t *placements);
+
+/* Préfixes de 2 colonnes de la demi-planche (première reine dans la moitié
+ * haute, seconde au-dessus d'elle si la première est sur la ligne du milieu),
+ * rangés par paires dans `prefixes` (N * N paires au plus) ; renvoie leur
+ * nombre et compte leurs reines dans placements. N >= 2. */
+uint64_t nq_half_board_prefixes(uint32_t n_queens, uint32_t (*prefixes)[2], uint64_t *placements);
+
+/* Nombre de solutions d'un échiquier complet, avec la symétrie de la moitié
+ * de l'échiquier */
+uint64_t nq_count(NQ_KERNEL kernel, uint32_t n_queens, uint64_t *placements);
+
+/* Demi-planche sur un CHESS_BOARD, pour les programmes qui distribuent des
+ * préfixes : première reine dans la moitié haute, seconde au-dessus d'elle si
+ * la première est sur la ligne du milieu (N impair). Nombre de lignes à
+ * essayer dans la colonne column_j. */
+uint32_t nq_half_board_limit(const CHESS_BOARD *board);
+
+/* Ajouter à *prefixes (agrandi par realloc, *capacity préfixes) les préfixes
+ * de `depth` colonnes de la demi-planche qui prolongent les reines déjà posées
+ * (les solutions complètes si N <= depth), dans l'ordre canonique. Chaque
+ * préfixe occupe `stride` lignes (stride >= depth), les dernières à 0. */
+void nq_half_board_expand(CHESS_BOARD *board, uint32_t depth, uint32_t stride, uint32_t **prefixes,
+                          uint64_t *count, uint64_t *capacity);
+
+/* Poser un préfixe de la demi-planche sur un échiquier vide, ajouter à
+ * board->solutions 2 par solution qui le prolonge (l'autre moitié, symétrique)
+ * en la cherchant avec le noyau `kernel`, puis retirer le préfixe. Les reines
+ * posées comptent dans board->placements. */
+void nq_half_board_solve(NQ_KERNEL kernel, const uint32_t *prefix, uint32_t depth, CHESS_BOARD *board);
+
+#endif
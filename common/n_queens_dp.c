@@ -0,0 +1,616 @@
+#include "n_queens_dp.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Empty slot of the hash table: a key uses at most 3 * 21 = 63 bits
+#define DP_EMPTY UINT64_MAX
+#define DP_INITIAL_CAPACITY (1ULL << 12)
+#define DP_MIN_CAPACITY (1ULL << 6)
+// Records read from a spill file at once
+#define DP_READ_CHUNK 4096
+
+// Open-addressing table (linear probing) that sums the counts of equal keys
+typedef struct dp_table
+{
+    NQ_DP_STATE *slots;
+    uint64_t capacity;
+    uint64_t used;
+    // largest capacity allowed by the memory budget
+    uint64_t max_capacity;
+} DP_TABLE;
+
+// States of one column, either in memory or in one spill file per partition
+typedef struct dp_layer
+{
+    NQ_DP_STATE *states;
+    uint64_t count;
+    FILE **parts;
+    uint32_t nparts;
+} DP_LAYER;
+
+typedef struct dp_context
+{
+    uint32_t n_queens;
+    uint64_t full;
+    const NQ_DP_OPTIONS *options;
+    NQ_DP_STATS *stats;
+    DP_TABLE table;
+    // spill partitions by occupied rows (join)
+    int by_rows;
+    // raw (not yet merged) spill files of the column being built, NULL until the table is full
+    FILE **raw;
+} DP_CONTEXT;
+
+static uint64_t mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Partition of a spilled state. For the join, a set of occupied rows and its
+// complement go to the same partition, so that the two half boards are joined
+// one partition at a time; otherwise the whole key is hashed, since near the
+// last columns only a few sets of rows are left.
+static uint32_t partition_of(uint64_t key, uint64_t full, uint32_t nparts, int by_rows)
+{
+    if (!by_rows)
+    {
+        return (uint32_t)(mix(key) % nparts);
+    }
+    const uint64_t cols = key & full;
+    const uint64_t other = ~cols & full;
+    return (uint32_t)(mix(cols < other ? cols : other) % nparts);
+}
+
+static void table_alloc(DP_TABLE *table, uint64_t capacity)
+{
+    table->slots = malloc(sizeof(NQ_DP_STATE) * capacity);
+    if (table->slots == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the state table.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(table->slots, 0xFF, sizeof(NQ_DP_STATE) * capacity);
+    table->capacity = capacity;
+    table->used = 0;
+}
+
+static void table_init(DP_TABLE *table, uint64_t memory_budget)
+{
+    uint64_t max_capacity = 1ULL << 40;
+    if (memory_budget > 0)
+    {
+        max_capacity = DP_MIN_CAPACITY;
+        while (max_capacity * 2 * sizeof(NQ_DP_STATE) <= memory_budget)
+        {
+            max_capacity *= 2;
+        }
+    }
+    table->max_capacity = max_capacity;
+    table_alloc(table, DP_INITIAL_CAPACITY < max_capacity ? DP_INITIAL_CAPACITY : max_capacity);
+}
+
+static void table_clear(DP_TABLE *table)
+{
+    memset(table->slots, 0xFF, sizeof(NQ_DP_STATE) * table->capacity);
+    table->used = 0;
+}
+
+static void table_insert(DP_TABLE *table, uint64_t key, uint64_t count)
+{
+    const uint64_t mask = table->capacity - 1;
+    uint64_t slot = mix(key) & mask;
+    while (table->slots[slot].key != DP_EMPTY && table->slots[slot].key != key)
+    {
+        slot = (slot + 1) & mask;
+    }
+    if (table->slots[slot].key == DP_EMPTY)
+    {
+        table->slots[slot].key = key;
+        table->slots[slot].count = 0;
+        ++table->used;
+    }
+    table->slots[slot].count += count;
+}
+
+// Returns 0 when the table is full and may not grow past the budget
+static int table_add(DP_TABLE *table, uint64_t key, uint64_t count)
+{
+    if (4 * (table->used + 1) > 3 * table->capacity)
+    {
+        if (2 * table->capacity > table->max_capacity)
+        {
+            return 0;
+        }
+        NQ_DP_STATE *old = table->slots;
+        const uint64_t old_capacity = table->capacity;
+        table_alloc(table, 2 * old_capacity);
+        for (uint64_t i = 0; i < old_capacity; ++i)
+        {
+            if (old[i].key != DP_EMPTY)
+            {
+                table_insert(table, old[i].key, old[i].count);
+            }
+        }
+        free(old);
+    }
+    table_insert(table, key, count);
+    return 1;
+}
+
+static FILE *open_spill_file(const char *dir)
+{
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/nq_dp_XXXXXX", dir);
+    const int fd = mkstemp(path);
+    if (fd < 0)
+    {
+        perror("Failed to create a spill file");
+        exit(EXIT_FAILURE);
+    }
+    // the file disappears with its last descriptor
+    unlink(path);
+    FILE *file = fdopen(fd, "w+b");
+    if (file == NULL)
+    {
+        perror("Failed to open a spill file");
+        exit(EXIT_FAILURE);
+    }
+    return file;
+}
+
+static FILE **open_spill_files(const DP_CONTEXT *ctx)
+{
+    FILE **files = malloc(sizeof(FILE *) * ctx->options->partitions);
+    if (files == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the spill files.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (uint32_t p = 0; p < ctx->options->partitions; ++p)
+    {
+        files[p] = open_spill_file(ctx->options->spill_dir);
+    }
+    return files;
+}
+
+static void write_state(DP_CONTEXT *ctx, FILE **files, const NQ_DP_STATE *state)
+{
+    FILE *file = files[partition_of(state->key, ctx->full, ctx->options->partitions, ctx->by_rows)];
+    if (fwrite(state, sizeof(NQ_DP_STATE), 1, file) != 1)
+    {
+        perror("Failed to write a spill file");
+        exit(EXIT_FAILURE);
+    }
+    ++ctx->stats->spilled_records;
+}
+
+static void flush_table(DP_CONTEXT *ctx, FILE **files)
+{
+    DP_TABLE *table = &ctx->table;
+    for (uint64_t i = 0; i < table->capacity; ++i)
+    {
+        if (table->slots[i].key != DP_EMPTY)
+        {
+            write_state(ctx, files, &table->slots[i]);
+        }
+    }
+    table_clear(table);
+}
+
+static void add_state(DP_CONTEXT *ctx, uint64_t key, uint64_t count)
+{
+    if (table_add(&ctx->table, key, count))
+    {
+        return;
+    }
+    if (ctx->options->spill_dir == NULL)
+    {
+        fprintf(stderr, "The states of a column do not fit in the memory budget (%" PRIu64 " bytes); give a spill directory.\n",
+                ctx->options->memory_budget);
+        exit(EXIT_FAILURE);
+    }
+    // the partially merged states go to disk and the table starts over
+    if (ctx->raw == NULL)
+    {
+        ctx->raw = open_spill_files(ctx);
+    }
+    flush_table(ctx, ctx->raw);
+    table_add(&ctx->table, key, count);
+}
+
+// Place a queen on every free row of the next column
+static void expand_state(DP_CONTEXT *ctx, const NQ_DP_STATE *state, int last)
+{
+    const uint32_t n = ctx->n_queens;
+    const uint64_t full = ctx->full;
+    const uint64_t cols = state->key & full;
+    const uint64_t up = (state->key >> n) & full;
+    const uint64_t down = state->key >> (2 * n);
+    uint64_t free_rows = full & ~(cols | up | down);
+    while (free_rows)
+    {
+        const uint64_t bit = free_rows & -free_rows;
+        free_rows ^= bit;
+        ++ctx->stats->transitions;
+        if (last)
+        {
+            // the diagonals no longer matter after the last column
+            add_state(ctx, cols | bit, state->count);
+        }
+        else
+        {
+            const uint64_t next_up = ((up | bit) << 1) & full;
+            const uint64_t next_down = (down | bit) >> 1;
+            add_state(ctx, (cols | bit) | (next_up << n) | (next_down << (2 * n)), state->count);
+        }
+    }
+}
+
+static void rewind_file(FILE *file)
+{
+    if (fseek(file, 0, SEEK_SET) != 0)
+    {
+        perror("Failed to rewind a spill file");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Read a whole spill file into memory
+static NQ_DP_STATE *read_file(FILE *file, uint64_t *count)
+{
+    if (fseek(file, 0, SEEK_END) != 0)
+    {
+        perror("Failed to read a spill file");
+        exit(EXIT_FAILURE);
+    }
+    *count = (uint64_t)ftell(file) / sizeof(NQ_DP_STATE);
+    rewind_file(file);
+    NQ_DP_STATE *states = malloc(sizeof(NQ_DP_STATE) * (*count + 1));
+    if (states == NULL || fread(states, sizeof(NQ_DP_STATE), *count, file) != *count)
+    {
+        fprintf(stderr, "Failed to load a spill file.\n");
+        exit(EXIT_FAILURE);
+    }
+    return states;
+}
+
+static void free_layer(DP_LAYER *layer)
+{
+    free(layer->states);
+    if (layer->parts != NULL)
+    {
+        for (uint32_t p = 0; p < layer->nparts; ++p)
+        {
+            fclose(layer->parts[p]);
+        }
+        free(layer->parts);
+    }
+    memset(layer, 0, sizeof(DP_LAYER));
+}
+
+// Build the states of the next column from those of `in`
+static void expand_layer(DP_CONTEXT *ctx, const DP_LAYER *in, DP_LAYER *out, int last)
+{
+    DP_TABLE *table = &ctx->table;
+    table_clear(table);
+    ctx->raw = NULL;
+
+    if (in->parts == NULL)
+    {
+        for (uint64_t i = 0; i < in->count; ++i)
+        {
+            expand_state(ctx, &in->states[i], last);
+        }
+    }
+    else
+    {
+        NQ_DP_STATE chunk[DP_READ_CHUNK];
+        for (uint32_t p = 0; p < in->nparts; ++p)
+        {
+            rewind_file(in->parts[p]);
+            size_t read;
+            while ((read = fread(chunk, sizeof(NQ_DP_STATE), DP_READ_CHUNK, in->parts[p])) > 0)
+            {
+                for (size_t i = 0; i < read; ++i)
+                {
+                    expand_state(ctx, &chunk[i], last);
+                }
+            }
+        }
+    }
+
+    memset(out, 0, sizeof(DP_LAYER));
+    if (ctx->raw == NULL)
+    {
+        // everything fitted: keep the merged states in memory
+        out->states = malloc(sizeof(NQ_DP_STATE) * (table->used + 1));
+        if (out->states == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed for the column states.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (uint64_t i = 0; i < table->capacity; ++i)
+        {
+            if (table->slots[i].key != DP_EMPTY)
+            {
+                out->states[out->count++] = table->slots[i];
+            }
+        }
+        if (out->count > ctx->stats->peak_states)
+        {
+            ctx->stats->peak_states = out->count;
+        }
+        return;
+    }
+
+    // Spilled: the same key may sit in several flushes, merge each partition
+    // on its own (every flush of a key went to the same partition)
+    flush_table(ctx, ctx->raw);
+    ++ctx->stats->spilled_columns;
+    out->nparts = ctx->options->partitions;
+    out->parts = open_spill_files(ctx);
+    uint64_t states = 0;
+    for (uint32_t p = 0; p < out->nparts; ++p)
+    {
+        NQ_DP_STATE chunk[DP_READ_CHUNK];
+        size_t read;
+        rewind_file(ctx->raw[p]);
+        while ((read = fread(chunk, sizeof(NQ_DP_STATE), DP_READ_CHUNK, ctx->raw[p])) > 0)
+        {
+            for (size_t i = 0; i < read; ++i)
+            {
+                if (!table_add(table, chunk[i].key, chunk[i].count))
+                {
+                    fprintf(stderr, "A partition does not fit in the memory budget; use more partitions.\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+        }
+        fclose(ctx->raw[p]);
+        states += table->used;
+        flush_table(ctx, out->parts);
+    }
+    free(ctx->raw);
+    ctx->raw = NULL;
+    if (states > ctx->stats->peak_states)
+    {
+        ctx->stats->peak_states = states;
+    }
+}
+
+static void context_init(DP_CONTEXT *ctx, uint32_t n_queens, const NQ_DP_OPTIONS *options, NQ_DP_STATS *stats)
+{
+    if (n_queens < 1 || n_queens > NQ_DP_MAX_N)
+    {
+        fprintf(stderr, "The number of queens must be between 1 and %d.\n", NQ_DP_MAX_N);
+        exit(EXIT_FAILURE);
+    }
+    if (options->spill_dir != NULL && options->partitions < 1)
+    {
+        fprintf(stderr, "The number of partitions must be greater than 0.\n");
+        exit(EXIT_FAILURE);
+    }
+    ctx->n_queens = n_queens;
+    ctx->full = (1ULL << n_queens) - 1;
+    ctx->options = options;
+    ctx->stats = stats;
+    ctx->by_rows = 0;
+    ctx->raw = NULL;
+    memset(stats, 0, sizeof(NQ_DP_STATS));
+    table_init(&ctx->table, options->memory_budget);
+}
+
+// The empty board: one state, reached once
+static void first_layer(DP_LAYER *layer)
+{
+    memset(layer, 0, sizeof(DP_LAYER));
+    layer->states = malloc(sizeof(NQ_DP_STATE));
+    if (layer->states == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the column states.\n");
+        exit(EXIT_FAILURE);
+    }
+    layer->states[0].key = 0;
+    layer->states[0].count = 1;
+    layer->count = 1;
+}
+
+void nq_dp_options_default(NQ_DP_OPTIONS *options)
+{
+    options->memory_budget = 0;
+    options->spill_dir = NULL;
+    options->partitions = NQ_DP_DEFAULT_PARTITIONS;
+}
+
+uint64_t nq_dp_count(uint32_t n_queens, const NQ_DP_OPTIONS *options, NQ_DP_STATS *stats)
+{
+    DP_CONTEXT ctx;
+    context_init(&ctx, n_queens, options, stats);
+    DP_LAYER layer, next;
+    first_layer(&layer);
+    for (uint32_t j = 0; j < n_queens; ++j)
+    {
+        expand_layer(&ctx, &layer, &next, j + 1 == n_queens);
+        free_layer(&layer);
+        layer = next;
+    }
+
+    // after the last column only the full set of rows is left
+    uint64_t solutions = 0;
+    if (layer.parts == NULL)
+    {
+        for (uint64_t i = 0; i < layer.count; ++i)
+        {
+            solutions += layer.states[i].count;
+        }
+    }
+    else
+    {
+        for (uint32_t p = 0; p < layer.nparts; ++p)
+        {
+            uint64_t count;
+            NQ_DP_STATE *states = read_file(layer.parts[p], &count);
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                solutions += states[i].count;
+            }
+            free(states);
+        }
+    }
+    free_layer(&layer);
+    free(ctx.table.slots);
+    return solutions;
+}
+
+// States of partition p of a layer (a copy, to be freed)
+static NQ_DP_STATE *load_partition(const DP_CONTEXT *ctx, const DP_LAYER *layer, uint32_t p, uint32_t nparts,
+                                   uint64_t *count)
+{
+    if (layer->parts != NULL)
+    {
+        return read_file(layer->parts[p], count);
+    }
+    NQ_DP_STATE *states = malloc(sizeof(NQ_DP_STATE) * (layer->count + 1));
+    if (states == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the join.\n");
+        exit(EXIT_FAILURE);
+    }
+    *count = 0;
+    for (uint64_t i = 0; i < layer->count; ++i)
+    {
+        if (nparts == 1 || partition_of(layer->states[i].key, ctx->full, nparts, 1) == p)
+        {
+            states[(*count)++] = layer->states[i];
+        }
+    }
+    return states;
+}
+
+static int compare_keys(const void *a, const void *b)
+{
+    const uint64_t x = ((const NQ_DP_STATE *)a)->key;
+    const uint64_t y = ((const NQ_DP_STATE *)b)->key;
+    return (x > y) - (x < y);
+}
+
+// First state whose occupied rows are >= cols (the high bits of a right key)
+static uint64_t lower_bound(const NQ_DP_STATE *states, uint64_t count, uint32_t n, uint64_t cols)
+{
+    uint64_t low = 0, high = count;
+    while (low < high)
+    {
+        const uint64_t middle = low + (high - low) / 2;
+        if ((states[middle].key >> (2 * n)) < cols)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Join the left half board with the mirrored right half board.
+// A left state after h columns holds, seen from column h, the rows reached by
+// the diagonals of its queens: up = r + (h - c), down = r - (h - c). A right
+// queen (r, c >= h) is attacked when r - (c - h) is in up or r + (c - h) is in
+// down. On the mirrored board the right queens were placed in columns
+// n - 1 - c, and the state after n - h columns gives those two sets as
+// down_m << 1 and up_m >> 1 (the bits dropped by the shifts can never meet a
+// left diagonal).
+static uint64_t join_layers(DP_CONTEXT *ctx, const DP_LAYER *left, const DP_LAYER *right)
+{
+    const uint32_t n = ctx->n_queens;
+    const uint64_t full = ctx->full;
+    const uint32_t nparts = (left->parts != NULL || right->parts != NULL) ? ctx->options->partitions : 1;
+    uint64_t solutions = 0;
+
+    for (uint32_t p = 0; p < nparts; ++p)
+    {
+        uint64_t nl, nr;
+        NQ_DP_STATE *lstates = load_partition(ctx, left, p, nparts, &nl);
+        NQ_DP_STATE *rstates = load_partition(ctx, right, p, nparts, &nr);
+        for (uint64_t i = 0; i < nr; ++i)
+        {
+            const uint64_t key = rstates[i].key;
+            const uint64_t up = ((key >> (2 * n)) << 1) & full;
+            const uint64_t down = ((key >> n) & full) >> 1;
+            // occupied rows in the high bits: sorting groups the states by rows
+            rstates[i].key = ((key & full) << (2 * n)) | (up << n) | down;
+        }
+        qsort(rstates, nr, sizeof(NQ_DP_STATE), compare_keys);
+
+        for (uint64_t i = 0; i < nl; ++i)
+        {
+            const uint64_t key = lstates[i].key;
+            const uint64_t cols = ~key & full;
+            const uint64_t up = (key >> n) & full;
+            const uint64_t down = key >> (2 * n);
+            for (uint64_t k = lower_bound(rstates, nr, n, cols); k < nr && (rstates[k].key >> (2 * n)) == cols; ++k)
+            {
+                ++ctx->stats->join_pairs;
+                const uint64_t rkey = rstates[k].key;
+                if ((((rkey >> n) & full) & up) == 0 && ((rkey & full) & down) == 0)
+                {
+                    solutions += lstates[i].count * rstates[k].count;
+                }
+            }
+        }
+        free(lstates);
+        free(rstates);
+    }
+    return solutions;
+}
+
+uint64_t nq_dp_count_join(uint32_t n_queens, const NQ_DP_OPTIONS *options, NQ_DP_STATS *stats)
+{
+    DP_CONTEXT ctx;
+    context_init(&ctx, n_queens, options, stats);
+    ctx.by_rows = 1;
+    const uint32_t left_columns = (n_queens + 1) / 2;
+    const uint32_t right_columns = n_queens - left_columns;
+
+    DP_LAYER layer, next, right;
+    first_layer(&layer);
+    memset(&right, 0, sizeof(DP_LAYER));
+    for (uint32_t j = 0; j < left_columns; ++j)
+    {
+        if (j == right_columns && right_columns != left_columns)
+        {
+            // odd N: keep the shorter half, the next column builds the longer one
+            right = layer;
+            expand_layer(&ctx, &right, &next, 0);
+        }
+        else
+        {
+            expand_layer(&ctx, &layer, &next, 0);
+            free_layer(&layer);
+        }
+        layer = next;
+    }
+
+    uint64_t solutions;
+    if (right_columns == left_columns)
+    {
+        solutions = join_layers(&ctx, &layer, &layer);
+    }
+    else
+    {
+        solutions = join_layers(&ctx, &layer, &right);
+        free_layer(&right);
+    }
+    free_layer(&layer);
+    free(ctx.table.slots);
+    return solutions;
+}
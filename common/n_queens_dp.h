@@ -0,0 +1,56 @@
+#ifndef N_QUEENS_DP_H
+#define N_QUEENS_DP_H
+
+#include <stdint.h>
+
+/* Comptage par programmation dynamique sur le frontier, sans énumérer les
+ * solutions : l'échiquier est rempli colonne par colonne et, après chaque
+ * colonne, les placements partiels qui ont le même état (lignes occupées,
+ * diagonales montantes et descendantes qui touchent la colonne suivante) sont
+ * fusionnés dans une table de hachage avec leur nombre d'occurrences.
+ *
+ * L'état tient dans une clé de 3 * N bits, d'où la limite de N. */
+
+#define NQ_DP_MAX_N 21
+#define NQ_DP_DEFAULT_PARTITIONS 16
+
+/* Un état du frontier et le nombre de placements partiels qui y mènent */
+typedef struct nq_dp_state
+{
+    uint64_t key;
+    uint64_t count;
+} NQ_DP_STATE;
+
+typedef struct nq_dp_options
+{
+    // taille maximale de la table de hachage en octets, 0 = sans limite
+    uint64_t memory_budget;
+    // répertoire des fichiers de débordement ; NULL : dépasser le budget est une erreur
+    const char *spill_dir;
+    // nombre de partitions d'une colonne débordée sur disque
+    uint32_t partitions;
+} NQ_DP_OPTIONS;
+
+typedef struct nq_dp_stats
+{
+    uint64_t transitions;     // reines posées sur les états (comparable aux placements)
+    uint64_t peak_states;     // plus grand nombre d'états distincts d'une colonne
+    uint64_t join_pairs;      // paires d'états comparées par la jointure
+    uint64_t spilled_records; // états écrits sur disque
+    uint32_t spilled_columns; // colonnes qui n'ont pas tenu dans le budget
+} NQ_DP_STATS;
+
+/* Options par défaut : sans limite de mémoire ni débordement */
+void nq_dp_options_default(NQ_DP_OPTIONS *options);
+
+/* Nombre de solutions en remplissant les N colonnes */
+uint64_t nq_dp_count(uint32_t n_queens, const NQ_DP_OPTIONS *options, NQ_DP_STATS *stats);
+
+/* Nombre de solutions en joignant deux demi-échiquiers : les états après
+ * ceil(N/2) colonnes et ceux de l'échiquier miroir après floor(N/2) colonnes
+ * (les mêmes quand N est pair) sont groupés par lignes occupées, et une paire
+ * compte quand les lignes sont complémentaires et les diagonales disjointes.
+ * La colonne la plus chargée du frontier n'est jamais construite. */
+uint64_t nq_dp_count_join(uint32_t n_queens, const NQ_DP_OPTIONS *options, NQ_DP_STATS *stats);
+
+#endif
@@ -0,0 +1,291 @@
+#include "n_queens_endgame.h"
+#include "n_queens_core.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+#define ENDGAME_MAGIC "NQENDGM1"
+
+// Bits of the table index: k - 1 capped gaps of 2 bits, then k * k allowed squares
+static uint32_t index_bits(uint32_t k)
+{
+    return 2 * (k - 1) + k * k;
+}
+
+// Gather the bits of `value` at the positions set in `mask` into the low bits
+static uint64_t extract_bits(uint64_t value, uint64_t mask)
+{
+#ifdef __BMI2__
+    return _pext_u64(value, mask);
+#else
+    uint64_t bits = 0;
+    for (uint32_t i = 0; mask; ++i)
+    {
+        const uint64_t bit = mask & -mask;
+        mask ^= bit;
+        bits |= (uint64_t)((value & bit) != 0) << i;
+    }
+    return bits;
+#endif
+}
+
+// Masks (bit t * k + i: column t on free row i) of the placements of k queens
+// on the free rows `rows` that no two of them attack; returns how many
+static uint32_t valid_placements(uint32_t k, const uint32_t *rows, uint32_t *masks)
+{
+    uint32_t perm[NQ_ENDGAME_MAX_K];
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < k; ++i)
+    {
+        perm[i] = i;
+    }
+    while (1)
+    {
+        int valid = 1;
+        for (uint32_t t1 = 0; t1 < k && valid; ++t1)
+        {
+            for (uint32_t t2 = t1 + 1; t2 < k; ++t2)
+            {
+                const int32_t distance = (int32_t)rows[perm[t2]] - (int32_t)rows[perm[t1]];
+                if (distance == (int32_t)(t2 - t1) || -distance == (int32_t)(t2 - t1))
+                {
+                    valid = 0;
+                    break;
+                }
+            }
+        }
+        if (valid)
+        {
+            uint32_t mask = 0;
+            for (uint32_t t = 0; t < k; ++t)
+            {
+                mask |= 1u << (t * k + perm[t]);
+            }
+            masks[count++] = mask;
+        }
+        // next permutation in lexicographic order
+        int32_t i = (int32_t)k - 2;
+        while (i >= 0 && perm[i] > perm[i + 1])
+        {
+            --i;
+        }
+        if (i < 0)
+        {
+            return count;
+        }
+        int32_t j = (int32_t)k - 1;
+        while (perm[j] < perm[i])
+        {
+            --j;
+        }
+        uint32_t swap = perm[i];
+        perm[i] = perm[j];
+        perm[j] = swap;
+        for (int32_t a = i + 1, b = (int32_t)k - 1; a < b; ++a, --b)
+        {
+            swap = perm[a];
+            perm[a] = perm[b];
+            perm[b] = swap;
+        }
+    }
+}
+
+static void build_table(NQ_ENDGAME *endgame)
+{
+    const uint32_t k = endgame->k;
+    const uint32_t square_bits = k * k;
+    uint32_t masks[24];
+    for (uint32_t gaps = 0; gaps < (1u << (2 * (k - 1))); ++gaps)
+    {
+        // rows of the free rows, rebuilt from the capped gaps
+        uint32_t rows[NQ_ENDGAME_MAX_K];
+        rows[0] = 0;
+        for (uint32_t i = 1; i < k; ++i)
+        {
+            rows[i] = rows[i - 1] + ((gaps >> (2 * (i - 1))) & 3) + 1;
+        }
+        const uint32_t count = valid_placements(k, rows, masks);
+        uint8_t *table = &endgame->completions[(uint64_t)gaps << square_bits];
+        for (uint32_t allowed = 0; allowed < (1u << square_bits); ++allowed)
+        {
+            uint8_t completions = 0;
+            for (uint32_t m = 0; m < count; ++m)
+            {
+                completions += (masks[m] & allowed) == masks[m];
+            }
+            table[allowed] = completions;
+        }
+    }
+}
+
+static int load_table(NQ_ENDGAME *endgame, const char *cache_path)
+{
+    FILE *file = fopen(cache_path, "rb");
+    if (file == NULL)
+    {
+        return 0;
+    }
+    char magic[8];
+    uint32_t k;
+    uint64_t size;
+    const int loaded = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                       memcmp(magic, ENDGAME_MAGIC, sizeof(magic)) == 0 &&
+                       fread(&k, sizeof(k), 1, file) == 1 && k == endgame->k &&
+                       fread(&size, sizeof(size), 1, file) == 1 && size == endgame->size &&
+                       fread(endgame->completions, 1, size, file) == size;
+    fclose(file);
+    return loaded;
+}
+
+static void save_table(const NQ_ENDGAME *endgame, const char *cache_path)
+{
+    FILE *file = fopen(cache_path, "wb");
+    if (file == NULL ||
+        fwrite(ENDGAME_MAGIC, 1, 8, file) != 8 ||
+        fwrite(&endgame->k, sizeof(endgame->k), 1, file) != 1 ||
+        fwrite(&endgame->size, sizeof(endgame->size), 1, file) != 1 ||
+        fwrite(endgame->completions, 1, endgame->size, file) != endgame->size)
+    {
+        // the cache is optional: the table is rebuilt next time
+        fprintf(stderr, "Failed to write the endgame cache %s.\n", cache_path);
+    }
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+}
+
+NQ_ENDGAME *nq_endgame_create(uint32_t k, const char *cache_path)
+{
+    if (k < NQ_ENDGAME_MIN_K || k > NQ_ENDGAME_MAX_K)
+    {
+        fprintf(stderr, "The endgame depth must be between %d and %d.\n", NQ_ENDGAME_MIN_K, NQ_ENDGAME_MAX_K);
+        exit(EXIT_FAILURE);
+    }
+    NQ_ENDGAME *endgame = malloc(sizeof(NQ_ENDGAME));
+    if (endgame == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the endgame table.\n");
+        exit(EXIT_FAILURE);
+    }
+    endgame->k = k;
+    endgame->size = 1ULL << index_bits(k);
+    endgame->completions = malloc(endgame->size);
+    if (endgame->completions == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the endgame table.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (cache_path == NULL || !load_table(endgame, cache_path))
+    {
+        build_table(endgame);
+        if (cache_path != NULL)
+        {
+            save_table(endgame, cache_path);
+        }
+    }
+    return endgame;
+}
+
+void nq_endgame_destroy(NQ_ENDGAME *endgame)
+{
+    free(endgame->completions);
+    free(endgame);
+}
+
+// Completions of the last k columns: exactly k rows are free
+static uint64_t lookup(const NQ_ENDGAME *endgame, uint64_t free_rows, uint64_t diag_up, uint64_t diag_down)
+{
+    const uint32_t k = endgame->k;
+    uint64_t allowed = 0;
+    for (uint32_t t = 0; t < k; ++t)
+    {
+        const uint64_t attacked = (diag_up << t) | (diag_down >> t);
+        allowed |= extract_bits(~attacked, free_rows) << (t * k);
+    }
+    uint64_t gaps = 0;
+    uint32_t previous = (uint32_t)__builtin_ctzll(free_rows);
+    free_rows &= free_rows - 1;
+    for (uint32_t i = 0; free_rows; ++i)
+    {
+        const uint32_t row = (uint32_t)__builtin_ctzll(free_rows);
+        free_rows &= free_rows - 1;
+        const uint32_t gap = row - previous < k ? row - previous : k;
+        gaps |= (uint64_t)(gap - 1) << (2 * i);
+        previous = row;
+    }
+    return endgame->completions[(gaps << (k * k)) | allowed];
+}
+
+static uint64_t endgame_search(const NQ_ENDGAME *endgame, uint64_t full, uint64_t cols, uint64_t diag_up,
+                               uint64_t diag_down, uint32_t remaining, uint64_t *placements)
+{
+    uint64_t free_rows = full & ~(cols | diag_up | diag_down);
+    if (remaining == endgame->k)
+    {
+        // most of the states of that depth are dead ends, skip their lookup
+        return free_rows ? lookup(endgame, full & ~cols, diag_up, diag_down) : 0;
+    }
+    uint64_t solutions = 0;
+    while (free_rows)
+    {
+        const uint64_t bit = free_rows & -free_rows;
+        free_rows ^= bit;
+        ++*placements;
+        solutions += endgame_search(endgame, full, cols | bit, (diag_up | bit) << 1, (diag_down | bit) >> 1,
+                                    remaining - 1, placements);
+    }
+    return solutions;
+}
+
+uint64_t nq_endgame_subtree(const NQ_ENDGAME *endgame, uint64_t full, uint64_t cols, uint64_t diag_up,
+                            uint64_t diag_down, uint64_t *placements)
+{
+    const uint32_t remaining = (uint32_t)__builtin_popcountll(full & ~cols);
+    if (remaining < endgame->k)
+    {
+        return nq_bitboard_subtree(full, cols, diag_up, diag_down, placements);
+    }
+    return endgame_search(endgame, full, cols, diag_up, diag_down, remaining, placements);
+}
+
+uint64_t nq_endgame_count(const NQ_ENDGAME *endgame, uint32_t n_queens, uint64_t *placements)
+{
+    if (n_queens < 1 || n_queens > NQ_CORE_MAX_N)
+    {
+        fprintf(stderr, "The number of queens must be between 1 and %d.\n", NQ_CORE_MAX_N);
+        exit(EXIT_FAILURE);
+    }
+    if (n_queens == 1)
+    {
+        ++*placements;
+        return 1;
+    }
+    const uint64_t full = (1ULL << n_queens) - 1;
+    uint64_t solutions = 0;
+    // first queen in the upper half, and when it sits on the middle row (odd N),
+    // the second one above it
+    for (uint32_t first = 0; first < (n_queens + 1) >> 1; ++first)
+    {
+        const uint64_t bit = 1ULL << first;
+        ++*placements;
+        uint64_t free_rows = full & ~(bit | (bit << 1) | (bit >> 1));
+        if ((n_queens & 1) && first == n_queens >> 1)
+        {
+            free_rows &= (1ULL << (n_queens >> 1)) - 1;
+        }
+        while (free_rows)
+        {
+            const uint64_t second = free_rows & -free_rows;
+            free_rows ^= second;
+            ++*placements;
+            solutions += nq_endgame_subtree(endgame, full, bit | second, (((bit << 1) | second) << 1),
+                                            ((bit >> 1) | second) >> 1, placements);
+        }
+    }
+    return 2 * solutions;
+}
@@ -0,0 +1,40 @@
+#ifndef N_QUEENS_ENDGAME_H
+#define N_QUEENS_ENDGAME_H
+
+#include <stdint.h>
+
+/* Tables de fin de partie : quand il ne reste que k colonnes, le nombre de
+ * façons de les compléter ne dépend que
+ *  - des cases autorisées : pour chacune des k colonnes, lesquelles des k
+ *    lignes libres ne sont pas attaquées par une diagonale (k * k bits) ;
+ *  - des écarts entre lignes libres consécutives, plafonnés à k (au-delà, deux
+ *    nouvelles reines ne peuvent plus être sur une même diagonale).
+ * Ces bits forment l'indice d'une table d'octets : 8 Ko pour k = 3, 4 Mo pour
+ * k = 4. La recherche s'arrête k colonnes avant la fin et lit la table. */
+
+#define NQ_ENDGAME_MIN_K 1
+#define NQ_ENDGAME_MAX_K 4
+#define NQ_ENDGAME_DEFAULT_K 3
+
+typedef struct nq_endgame
+{
+    uint32_t k;
+    uint64_t size;
+    uint8_t *completions;
+} NQ_ENDGAME;
+
+/* Construire la table des k dernières colonnes, ou la lire depuis `cache_path`
+ * si ce fichier en contient une ; sinon elle y est écrite (NULL : pas de cache) */
+NQ_ENDGAME *nq_endgame_create(uint32_t k, const char *cache_path);
+void nq_endgame_destroy(NQ_ENDGAME *endgame);
+
+/* Comme nq_bitboard_subtree, avec une lecture de table à k colonnes de la fin ;
+ * les reines des k dernières colonnes ne sont pas comptées dans placements */
+uint64_t nq_endgame_subtree(const NQ_ENDGAME *endgame, uint64_t full, uint64_t cols, uint64_t diag_up,
+                            uint64_t diag_down, uint64_t *placements);
+
+/* Nombre de solutions d'un échiquier complet, avec la symétrie de la moitié
+ * de l'échiquier */
+uint64_t nq_endgame_count(const NQ_ENDGAME *endgame, uint32_t n_queens, uint64_t *placements);
+
+#endif
@@ -0,0 +1,208 @@
+#include "n_queens_estimator.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+// xorshift64* generator, enough for choosing random rows
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+// Number of rows that may be tried in column `column_j`, with the same
+// half-board symmetry rule as the counters (first column, then second column
+// when the first queen sits on the middle row of an odd board)
+static uint32_t row_limit(uint32_t n_queens, uint32_t column_j, uint32_t first_row)
+{
+    if (column_j == 0)
+    {
+        return (n_queens >> 1) + (n_queens & 1);
+    }
+    if (column_j == 1 && first_row == n_queens >> 1)
+    {
+        return n_queens >> 1;
+    }
+    return n_queens;
+}
+
+double estimator_subtree(uint32_t n_queens, const uint32_t *prefix, uint32_t depth,
+                         uint32_t samples, uint64_t *seed)
+{
+    const uint64_t full = n_queens >= 64 ? ~0ULL : (1ULL << n_queens) - 1;
+    uint64_t columns = 0, diagonal_up = 0, diagonal_down = 0;
+    uint32_t first_row = depth > 0 ? prefix[0] : 0;
+
+    // Replay the prefix on bitmasks: bit r is row r, the diagonals are shifted
+    // by one row when moving to the next column
+    for (uint32_t j = 0; j < depth; ++j)
+    {
+        const uint64_t bit = 1ULL << prefix[j];
+        columns |= bit;
+        diagonal_up = ((diagonal_up | bit) << 1) & full;
+        diagonal_down = (diagonal_down | bit) >> 1;
+    }
+    if (depth >= n_queens)
+    {
+        return 0.0;
+    }
+
+    double total = 0.0;
+    for (uint32_t s = 0; s < samples; ++s)
+    {
+        uint64_t c = columns, up = diagonal_up, down = diagonal_down;
+        double product = 1.0;
+        double nodes = 0.0;
+        uint32_t row0 = first_row;
+        for (uint32_t column_j = depth; column_j < n_queens; ++column_j)
+        {
+            const uint32_t limit = row_limit(n_queens, column_j, row0);
+            uint64_t free_rows = ~(c | up | down) & full;
+            if (limit < 64)
+            {
+                free_rows &= (1ULL << limit) - 1;
+            }
+            const uint32_t branching = (uint32_t)__builtin_popcountll(free_rows);
+            if (branching == 0)
+            {
+                break;
+            }
+            // Each of the `branching` children is a queen placement
+            product *= branching;
+            nodes += product;
+
+            // Pick the k-th free row uniformly
+            uint32_t k = (uint32_t)(next_random(seed) % branching);
+            while (k--)
+            {
+                free_rows &= free_rows - 1;
+            }
+            const uint64_t bit = free_rows & -free_rows;
+            if (column_j == 0)
+            {
+                row0 = (uint32_t)__builtin_ctzll(bit);
+            }
+            c |= bit;
+            up = ((up | bit) << 1) & full;
+            down = (down | bit) >> 1;
+        }
+        total += nodes;
+    }
+    return samples ? total / samples : 0.0;
+}
+
+double estimator_prefix(uint32_t n_queens, const uint32_t *prefix, uint32_t depth, uint64_t index,
+                        uint32_t samples)
+{
+    // One seed per prefix so that the weights do not depend on the order
+    uint64_t seed = 0x9E3779B97F4A7C15ULL ^ (index + 1) * 0xBF58476D1CE4E5B9ULL;
+    return estimator_subtree(n_queens, prefix, depth, samples, &seed);
+}
+
+void estimator_frontier(uint32_t n_queens, const uint32_t *prefixes, uint32_t stride,
+                        uint64_t count, uint32_t depth, uint32_t samples, double *weights)
+{
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        weights[i] = estimator_prefix(n_queens, &prefixes[i * stride], depth, i, samples);
+    }
+}
+
+void estimator_weighted_split(const double *weights, uint64_t count, uint32_t parts, uint64_t *bounds)
+{
+    double total = 0.0;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        total += weights[i];
+    }
+
+    // Part p ends where the running sum of weights crosses (p + 1) / parts of
+    // the total; a part never takes more items than are left for the others
+    double running = 0.0;
+    uint64_t i = 0;
+    bounds[0] = 0;
+    for (uint32_t p = 0; p < parts; ++p)
+    {
+        const double target = total * (p + 1) / parts;
+        const uint64_t keep = parts - p - 1;
+        while (i < count && count - i > keep && (running + weights[i] / 2 <= target || i == bounds[p]))
+        {
+            running += weights[i];
+            ++i;
+        }
+        bounds[p + 1] = p + 1 == parts ? count : i;
+    }
+}
+
+static const double *sort_weights;
+
+static int compare_heavier_first(const void *a, const void *b)
+{
+    const double x = sort_weights[*(const uint64_t *)a];
+    const double y = sort_weights[*(const uint64_t *)b];
+    if (x != y)
+    {
+        return x < y ? 1 : -1;
+    }
+    // Equal weights keep the generation order
+    return *(const uint64_t *)a < *(const uint64_t *)b ? -1 : 1;
+}
+
+void estimator_lpt_order(const double *weights, uint64_t count, uint64_t *order)
+{
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        order[i] = i;
+    }
+    sort_weights = weights;
+    qsort(order, count, sizeof(uint64_t), compare_heavier_first);
+}
+
+// Exact node count with bitmasks, used to calibrate the node rate
+static uint64_t count_nodes(uint64_t full, uint64_t columns, uint64_t up, uint64_t down)
+{
+    uint64_t nodes = 0;
+    uint64_t free_rows = ~(columns | up | down) & full;
+    while (free_rows)
+    {
+        const uint64_t bit = free_rows & -free_rows;
+        free_rows ^= bit;
+        nodes += 1 + count_nodes(full, columns | bit, ((up | bit) << 1) & full, (down | bit) >> 1);
+    }
+    return nodes;
+}
+
+double estimator_predict_seconds(uint32_t n_queens, uint32_t workers, uint32_t samples,
+                                 double *nodes, double *nodes_per_second)
+{
+    uint64_t seed = 0x2545F4914F6CDD1DULL;
+    const double total_nodes = estimator_subtree(n_queens, NULL, 0, samples, &seed);
+
+    // Calibrate on a full count of a board small enough to take a few milliseconds
+    const uint32_t calibration_n = n_queens < 11 ? n_queens : 11;
+    const uint64_t full = (1ULL << calibration_n) - 1;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    const uint64_t calibration_nodes = count_nodes(full, 0, 0, 0);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) * 1e-9;
+    if (seconds <= 0.0)
+    {
+        seconds = 1e-9;
+    }
+    const double rate = (double)calibration_nodes / seconds;
+
+    if (nodes != NULL)
+    {
+        *nodes = total_nodes;
+    }
+    if (nodes_per_second != NULL)
+    {
+        *nodes_per_second = rate;
+    }
+    return total_nodes / rate / (workers ? workers : 1);
+}
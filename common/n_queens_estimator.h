@@ -0,0 +1,40 @@
+#ifndef N_QUEENS_ESTIMATOR_H
+#define N_QUEENS_ESTIMATOR_H
+
+#include <stdint.h>
+
+/* Nombre de sondages aléatoires par préfixe utilisé par défaut */
+#define ESTIMATOR_DEFAULT_SAMPLES 32
+
+/* Estimer le nombre de noeuds (placements de reines) du sous-arbre sous un
+ * préfixe de `depth` colonnes, par la méthode de Knuth : chaque sondage descend
+ * en choisissant une ligne libre au hasard et multiplie les facteurs de
+ * branchement rencontrés. `seed` est mis à jour entre deux appels. */
+double estimator_subtree(uint32_t n_queens, const uint32_t *prefix, uint32_t depth,
+                         uint32_t samples, uint64_t *seed);
+
+/* Estimer le préfixe de rang `index` d'un frontier, avec la graine propre à
+ * ce rang : le même poids que estimator_frontier, sans le frontier entier */
+double estimator_prefix(uint32_t n_queens, const uint32_t *prefix, uint32_t depth, uint64_t index,
+                        uint32_t samples);
+
+/* Estimer chaque préfixe d'un frontier. Le préfixe i commence à
+ * prefixes[i * stride]. La graine est fixe : tous les processus obtiennent
+ * les mêmes poids pour le même frontier. */
+void estimator_frontier(uint32_t n_queens, const uint32_t *prefixes, uint32_t stride,
+                        uint64_t count, uint32_t depth, uint32_t samples, double *weights);
+
+/* Découper [0, count) en `parts` intervalles contigus de poids proches :
+ * la part p est [bounds[p], bounds[p + 1]) (bounds a parts + 1 cases) */
+void estimator_weighted_split(const double *weights, uint64_t count, uint32_t parts, uint64_t *bounds);
+
+/* Ordre LPT (Longest Processing Time first) : indices par poids décroissant */
+void estimator_lpt_order(const double *weights, uint64_t count, uint64_t *order);
+
+/* Prédire le temps d'un comptage complet sur `workers` coeurs : estimation du
+ * nombre total de noeuds, et vitesse mesurée sur un petit comptage exact.
+ * `nodes` et `nodes_per_second` sont renseignés s'ils ne sont pas NULL. */
+double estimator_predict_seconds(uint32_t n_queens, uint32_t workers, uint32_t samples,
+                                 double *nodes, double *nodes_per_second);
+
+#endif
@@ -0,0 +1,560 @@
+#include "n_queens_first.h"
+#include "n_queens_core.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Placements between two checks of the stop flag (or of the MPI messages)
+#define POLL_PLACEMENTS 4096
+// Worker 0 walks the rows in order, worker 1 from the middle out, the others at random
+#define NATURAL_WORKER 0
+#define MIDDLE_WORKER 1
+
+#ifdef NQ_WITH_MPI
+#define TAG_SOLUTION 1
+#define TAG_EXHAUSTED 2
+#endif
+
+typedef enum search_status
+{
+    SEARCH_BUDGET,
+    SEARCH_FOUND,
+    SEARCH_EXHAUSTED
+} SEARCH_STATUS;
+
+// One worker's depth-first search, resumable after each solution or budget
+typedef struct first_search
+{
+    CHESS_BOARD *board;
+    uint32_t *order;  // rows in the order of this worker
+    uint32_t *offset; // per column rotation of that order
+    uint32_t *next;   // per column position of the next row to try in the order
+    uint64_t placements;
+    int worker;
+} FIRST_SEARCH;
+
+// Solutions gathered from all workers, distinct, up to k
+typedef struct first_shared
+{
+    pthread_mutex_t mutex;
+    uint32_t n_queens;
+    uint32_t k;
+    uint32_t found;
+    uint32_t *positions;
+    int stop;
+    int exhausted;
+    int first_worker;
+    double start;
+    double first_seconds;
+} FIRST_SHARED;
+
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+static uint32_t online_cpus(void)
+{
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (uint32_t)cpus : 1;
+}
+
+// splitmix64: independent streams for close seeds (seed + worker)
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void search_init(FIRST_SEARCH *search, uint32_t n_queens, int worker, uint64_t seed)
+{
+    initialize_board(n_queens, &search->board, 0, n_queens);
+    search->order = malloc(sizeof(uint32_t) * 3 * (n_queens + 1));
+    if (search->order == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the search orders.\n");
+        exit(EXIT_FAILURE);
+    }
+    search->offset = search->order + n_queens + 1;
+    search->next = search->offset + n_queens + 1;
+    search->placements = 0;
+    search->worker = worker;
+    memset(search->offset, 0, sizeof(uint32_t) * (n_queens + 1));
+    memset(search->next, 0, sizeof(uint32_t) * (n_queens + 1));
+    for (uint32_t i = 0; i < n_queens; ++i)
+    {
+        search->order[i] = i;
+    }
+    if (worker == MIDDLE_WORKER)
+    {
+        // n/2, n/2 - 1, n/2 + 1, n/2 - 2, ...
+        for (uint32_t i = 0; i < n_queens; ++i)
+        {
+            const uint32_t step = (i + 1) / 2;
+            search->order[i] = (i & 1) ? n_queens / 2 - step : n_queens / 2 + step;
+        }
+    }
+    else if (worker != NATURAL_WORKER)
+    {
+        uint64_t state = seed + (uint64_t)worker;
+        for (uint32_t i = n_queens - 1; i > 0; --i)
+        {
+            const uint32_t j = (uint32_t)(next_random(&state) % (i + 1));
+            const uint32_t row = search->order[i];
+            search->order[i] = search->order[j];
+            search->order[j] = row;
+        }
+        for (uint32_t j = 0; j < n_queens; ++j)
+        {
+            search->offset[j] = (uint32_t)(next_random(&state) % n_queens);
+        }
+    }
+}
+
+static void search_destroy(FIRST_SEARCH *search)
+{
+    smash_board(search->board);
+    free(search->order);
+}
+
+// Place queens until a solution, the end of the tree or `budget` placements.
+// After a solution, the next call goes on from it.
+static SEARCH_STATUS search_run(FIRST_SEARCH *search, uint64_t budget)
+{
+    CHESS_BOARD *board = search->board;
+    const uint32_t n = board->n_size;
+    if (board->column_j == n)
+    {
+        remove_queen(board->queen_positions[n - 1], board);
+    }
+    while (budget > 0)
+    {
+        const uint32_t j = board->column_j;
+        uint32_t i = search->next[j];
+        for (; i < n; ++i)
+        {
+            uint32_t row = search->order[i] + search->offset[j];
+            row = row >= n ? row - n : row;
+            if (square_is_free(row, board))
+            {
+                break;
+            }
+        }
+        if (i < n)
+        {
+            uint32_t row = search->order[i] + search->offset[j];
+            row = row >= n ? row - n : row;
+            search->next[j] = i + 1;
+            search->next[j + 1] = 0;
+            set_queen(row, board);
+            ++search->placements;
+            --budget;
+            if (board->column_j == n)
+            {
+                return SEARCH_FOUND;
+            }
+        }
+        else if (j == 0)
+        {
+            return SEARCH_EXHAUSTED;
+        }
+        else
+        {
+            remove_queen(board->queen_positions[j - 1], board);
+        }
+    }
+    return SEARCH_BUDGET;
+}
+
+static void shared_init(FIRST_SHARED *shared, uint32_t n_queens, uint32_t k)
+{
+    pthread_mutex_init(&shared->mutex, NULL);
+    shared->n_queens = n_queens;
+    shared->k = k;
+    shared->found = 0;
+    shared->positions = malloc(sizeof(uint32_t) * n_queens * k);
+    if (shared->positions == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the solutions.\n");
+        exit(EXIT_FAILURE);
+    }
+    shared->stop = 0;
+    shared->exhausted = 0;
+    shared->first_worker = -1;
+    shared->start = now();
+    shared->first_seconds = 0.0;
+}
+
+// Keep a solution unless another worker found it first; returns 1 once there are k
+static int shared_add(FIRST_SHARED *shared, const uint32_t *positions, int worker)
+{
+    const uint32_t n = shared->n_queens;
+    pthread_mutex_lock(&shared->mutex);
+    int known = 0;
+    for (uint32_t i = 0; i < shared->found && !known; ++i)
+    {
+        known = memcmp(&shared->positions[i * n], positions, sizeof(uint32_t) * n) == 0;
+    }
+    if (!known && shared->found < shared->k)
+    {
+        if (shared->found == 0)
+        {
+            shared->first_seconds = now() - shared->start;
+            shared->first_worker = worker;
+        }
+        memcpy(&shared->positions[shared->found * n], positions, sizeof(uint32_t) * n);
+        ++shared->found;
+    }
+    const int enough = shared->found >= shared->k;
+    if (enough)
+    {
+        __atomic_store_n(&shared->stop, 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&shared->mutex);
+    return enough;
+}
+
+// A worker went through the whole tree: every solution is already in
+static void shared_exhausted(FIRST_SHARED *shared)
+{
+    pthread_mutex_lock(&shared->mutex);
+    shared->exhausted = 1;
+    __atomic_store_n(&shared->stop, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&shared->mutex);
+}
+
+static int shared_stopped(FIRST_SHARED *shared)
+{
+    return __atomic_load_n(&shared->stop, __ATOMIC_ACQUIRE);
+}
+
+// One search until it (or another worker) has enough solutions
+static void search_until_stop(FIRST_SEARCH *search, FIRST_SHARED *shared)
+{
+    while (!shared_stopped(shared))
+    {
+        const SEARCH_STATUS status = search_run(search, POLL_PLACEMENTS);
+        if (status == SEARCH_FOUND)
+        {
+            shared_add(shared, search->board->queen_positions, search->worker);
+        }
+        else if (status == SEARCH_EXHAUSTED)
+        {
+            shared_exhausted(shared);
+        }
+    }
+}
+
+typedef struct first_thread
+{
+    FIRST_SEARCH *search;
+    FIRST_SHARED *shared;
+} FIRST_THREAD;
+
+static void *first_thread_main(void *arg)
+{
+    FIRST_THREAD *thread = arg;
+    search_until_stop(thread->search, thread->shared);
+    return NULL;
+}
+
+#ifdef _OPENMP
+// The searches stop at a cancellation point once one of them cancels the
+// region; without OMP_CANCELLATION=true the stop flag ends them instead
+static void solve_openmp(FIRST_SEARCH *searches, uint32_t workers, FIRST_SHARED *shared)
+{
+    #pragma omp parallel num_threads(workers)
+    {
+        FIRST_SEARCH *search = &searches[omp_get_thread_num()];
+        while (!shared_stopped(shared))
+        {
+            const SEARCH_STATUS status = search_run(search, POLL_PLACEMENTS);
+            if (status == SEARCH_FOUND && shared_add(shared, search->board->queen_positions, search->worker))
+            {
+                #pragma omp cancel parallel
+            }
+            else if (status == SEARCH_EXHAUSTED)
+            {
+                shared_exhausted(shared);
+                #pragma omp cancel parallel
+            }
+            #pragma omp cancellation point parallel
+        }
+    }
+}
+#endif
+
+#ifdef NQ_WITH_MPI
+// Rank 0 gathers the solutions; a rank with k solutions of its own or at the
+// end of its tree stops searching (rank 0 has, or will receive, enough), and
+// rank 0 ends the others with a non-blocking broadcast they test between batches
+static void solve_mpi(const NQ_FIRST_CONFIG *config, FIRST_SHARED *shared, uint64_t *placements)
+{
+    MPI_Comm comm;
+    int rank, size;
+    MPI_Comm_dup(config->comm, &comm);
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    const uint32_t n = config->n_queens;
+    FIRST_SEARCH search;
+    search_init(&search, n, rank, config->seed);
+    uint32_t *message = malloc(sizeof(uint32_t) * n);
+    if (message == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the MPI messages.\n");
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
+    int stop_flag = 1;
+    MPI_Request stop_request;
+    if (rank != 0)
+    {
+        MPI_Ibcast(&stop_flag, 1, MPI_INT, 0, comm, &stop_request);
+    }
+
+    int searching = 1, sent = 0, received = 0;
+    uint32_t own = 0;
+    while (1)
+    {
+        if (searching)
+        {
+            const SEARCH_STATUS status = search_run(&search, POLL_PLACEMENTS);
+            if (status == SEARCH_FOUND)
+            {
+                ++own;
+                if (rank == 0)
+                {
+                    shared_add(shared, search.board->queen_positions, 0);
+                }
+                else
+                {
+                    MPI_Send(search.board->queen_positions, (int)n, MPI_UINT32_T, 0, TAG_SOLUTION, comm);
+                    ++sent;
+                }
+                searching = own < config->k;
+            }
+            else if (status == SEARCH_EXHAUSTED)
+            {
+                if (rank == 0)
+                {
+                    shared_exhausted(shared);
+                }
+                else
+                {
+                    MPI_Send(NULL, 0, MPI_UINT32_T, 0, TAG_EXHAUSTED, comm);
+                    ++sent;
+                }
+                searching = 0;
+            }
+        }
+        if (rank == 0)
+        {
+            int pending;
+            MPI_Status status;
+            MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, comm, &pending, &status);
+            while (pending)
+            {
+                MPI_Recv(message, (int)n, MPI_UINT32_T, status.MPI_SOURCE, status.MPI_TAG, comm, MPI_STATUS_IGNORE);
+                ++received;
+                if (status.MPI_TAG == TAG_SOLUTION)
+                {
+                    shared_add(shared, message, status.MPI_SOURCE);
+                }
+                else
+                {
+                    shared_exhausted(shared);
+                }
+                MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, comm, &pending, &status);
+            }
+            if (shared_stopped(shared))
+            {
+                MPI_Ibcast(&stop_flag, 1, MPI_INT, 0, comm, &stop_request);
+                MPI_Wait(&stop_request, MPI_STATUS_IGNORE);
+                break;
+            }
+        }
+        else
+        {
+            int stopped;
+            if (searching)
+            {
+                MPI_Test(&stop_request, &stopped, MPI_STATUS_IGNORE);
+            }
+            else
+            {
+                MPI_Wait(&stop_request, MPI_STATUS_IGNORE);
+                stopped = 1;
+            }
+            if (stopped)
+            {
+                break;
+            }
+        }
+    }
+
+    // messages sent before the stop arrived are received, and dropped once there are k
+    int *sent_by = rank == 0 ? malloc(sizeof(int) * size) : NULL;
+    MPI_Gather(&sent, 1, MPI_INT, sent_by, 1, MPI_INT, 0, comm);
+    if (rank == 0)
+    {
+        int total = 0;
+        for (int r = 1; r < size; ++r)
+        {
+            total += sent_by[r];
+        }
+        for (; received < total; ++received)
+        {
+            MPI_Status status;
+            MPI_Recv(message, (int)n, MPI_UINT32_T, MPI_ANY_SOURCE, MPI_ANY_TAG, comm, &status);
+            if (status.MPI_TAG == TAG_SOLUTION)
+            {
+                shared_add(shared, message, status.MPI_SOURCE);
+            }
+        }
+        free(sent_by);
+    }
+    MPI_Reduce(&search.placements, placements, 1, MPI_UINT64_T, MPI_SUM, 0, comm);
+    free(message);
+    search_destroy(&search);
+    MPI_Comm_free(&comm);
+}
+#endif
+
+void nq_first_config_default(NQ_FIRST_CONFIG *config, uint32_t n_queens)
+{
+    config->n_queens = n_queens;
+    config->k = 1;
+    config->backend = NQ_BACKEND_SEQUENTIAL;
+    config->threads = 0;
+    config->seed = 0x6E715F6669727374ULL;
+#ifdef NQ_WITH_MPI
+    config->comm = MPI_COMM_WORLD;
+#endif
+}
+
+int nq_first_solve(const NQ_FIRST_CONFIG *config, NQ_FIRST_RESULT *result)
+{
+    memset(result, 0, sizeof(NQ_FIRST_RESULT));
+    result->first_worker = -1;
+    if (config->n_queens < 1 || config->k < 1)
+    {
+        fprintf(stderr, "The search needs N >= 1 and k >= 1.\n");
+        return -1;
+    }
+    if (config->backend == NQ_BACKEND_UNKNOWN)
+    {
+        fprintf(stderr, "The backend must be sequential, pthread, openmp or mpi.\n");
+        return -1;
+    }
+    FIRST_SHARED shared;
+    shared_init(&shared, config->n_queens, config->k);
+    uint64_t placements = 0;
+
+    if (config->backend == NQ_BACKEND_SEQUENTIAL ||
+        config->backend == NQ_BACKEND_PTHREAD || config->backend == NQ_BACKEND_OPENMP)
+    {
+        const uint32_t workers = config->backend == NQ_BACKEND_SEQUENTIAL ? 1
+                                 : config->threads               ? config->threads
+                                                                 : online_cpus();
+        FIRST_SEARCH *searches = malloc(sizeof(FIRST_SEARCH) * workers);
+        if (searches == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed for the searches.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (uint32_t w = 0; w < workers; ++w)
+        {
+            search_init(&searches[w], config->n_queens, (int)w, config->seed);
+        }
+        if (config->backend == NQ_BACKEND_SEQUENTIAL)
+        {
+            search_until_stop(&searches[0], &shared);
+        }
+        else if (config->backend == NQ_BACKEND_PTHREAD)
+        {
+            pthread_t *threads = malloc(sizeof(pthread_t) * workers);
+            FIRST_THREAD *args = malloc(sizeof(FIRST_THREAD) * workers);
+            if (threads == NULL || args == NULL)
+            {
+                fprintf(stderr, "Memory allocation failed for the search threads.\n");
+                exit(EXIT_FAILURE);
+            }
+            for (uint32_t w = 0; w < workers; ++w)
+            {
+                args[w].search = &searches[w];
+                args[w].shared = &shared;
+                if (pthread_create(&threads[w], NULL, first_thread_main, &args[w]) != 0)
+                {
+                    fprintf(stderr, "Failed to create a search thread.\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            for (uint32_t w = 0; w < workers; ++w)
+            {
+                pthread_join(threads[w], NULL);
+            }
+            free(threads);
+            free(args);
+        }
+        else
+        {
+#ifdef _OPENMP
+            solve_openmp(searches, workers, &shared);
+#else
+            fprintf(stderr, "The openmp backend needs -fopenmp.\n");
+            for (uint32_t w = 0; w < workers; ++w)
+            {
+                search_destroy(&searches[w]);
+            }
+            free(searches);
+            free(shared.positions);
+            pthread_mutex_destroy(&shared.mutex);
+            return -1;
+#endif
+        }
+        for (uint32_t w = 0; w < workers; ++w)
+        {
+            placements += searches[w].placements;
+            search_destroy(&searches[w]);
+        }
+        free(searches);
+    }
+    else
+    {
+#ifdef NQ_WITH_MPI
+        solve_mpi(config, &shared, &placements);
+#else
+        fprintf(stderr, "The mpi backend needs -DNQ_WITH_MPI.\n");
+        free(shared.positions);
+        pthread_mutex_destroy(&shared.mutex);
+        return -1;
+#endif
+    }
+
+    result->found = shared.found;
+    result->positions = shared.positions;
+    result->exhausted = shared.exhausted;
+    result->first_worker = shared.first_worker;
+    result->first_seconds = shared.first_seconds;
+    result->seconds = now() - shared.start;
+    result->placements = placements;
+    pthread_mutex_destroy(&shared.mutex);
+    return 0;
+}
+
+void nq_first_result_free(NQ_FIRST_RESULT *result)
+{
+    free(result->positions);
+    result->positions = NULL;
+    result->found = 0;
+}
@@ -0,0 +1,49 @@
+#ifndef N_QUEENS_FIRST_H
+#define N_QUEENS_FIRST_H
+
+#include <stdint.h>
+
+#include "n_queens_solver.h"
+
+/* Première solution, ou les k premières, au lieu du comptage : chaque worker
+ * (thread ou processus MPI) parcourt seul tout l'arbre, sur un CHESS_BOARD,
+ * mais dans un ordre des lignes différent (portefeuille) : le worker 0 dans
+ * l'ordre naturel, le 1 du milieu vers les bords, les autres dans un ordre
+ * tiré au hasard décalé d'une colonne à l'autre. Le premier qui trouve assez
+ * de solutions arrête les autres : drapeau partagé (pthread), `omp cancel`
+ * (OpenMP, avec OMP_CANCELLATION=true), diffusion non bloquante (MPI). Les
+ * solutions trouvées par plusieurs workers ne comptent qu'une fois. */
+
+typedef struct nq_first_config
+{
+    uint32_t n_queens;
+    uint32_t k;        // solutions voulues
+    NQ_BACKEND backend;
+    uint32_t threads;  // workers pthread ou OpenMP (0 : un par CPU) ; MPI : un par processus
+    uint64_t seed;     // ordres tirés au hasard des workers 2 et suivants
+#ifdef NQ_WITH_MPI
+    MPI_Comm comm;
+#endif
+} NQ_FIRST_CONFIG;
+
+typedef struct nq_first_result
+{
+    uint32_t found;
+    // found x N lignes, rangées comme queen_positions : positions[i * N + colonne]
+    uint32_t *positions;
+    int exhausted;        // l'arbre entier a été parcouru : il y a moins de k solutions
+    int first_worker;     // worker de la première solution (-1 : aucune)
+    double first_seconds; // temps jusqu'à la première solution
+    double seconds;       // temps jusqu'à l'arrêt de tous les workers
+    uint64_t placements;  // reines placées par tous les workers
+} NQ_FIRST_RESULT;
+
+/* k = 1, backend séquentiel, threads et graine par défaut */
+void nq_first_config_default(NQ_FIRST_CONFIG *config, uint32_t n_queens);
+
+/* Chercher les solutions ; 0 si tout va bien, -1 si la configuration est
+ * invalide. Avec MPI, le résultat n'est complet que sur le rang 0. */
+int nq_first_solve(const NQ_FIRST_CONFIG *config, NQ_FIRST_RESULT *result);
+void nq_first_result_free(NQ_FIRST_RESULT *result);
+
+#endif
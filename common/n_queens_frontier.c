@@ -0,0 +1,498 @@
+#include "n_queens_frontier.h"
+#include "n_queens_estimator.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FRONTIER_MAGIC "NQFRONT\0"
+
+// Rows that may be tried in `column`, with the half-board symmetry
+static uint64_t allowed_rows(const NQ_PREFIX_STREAM *stream, uint32_t column)
+{
+    const uint32_t n = stream->n_queens;
+    uint64_t free_rows = stream->full & ~(stream->cols[column] | stream->diag_up[column] | stream->diag_down[column]);
+    if (column == 0)
+    {
+        free_rows &= (1ULL << ((n + 1) >> 1)) - 1;
+    }
+    else if (column == 1 && (n & 1) && stream->rows[0] == n >> 1)
+    {
+        free_rows &= (1ULL << (n >> 1)) - 1;
+    }
+    return free_rows;
+}
+
+void nq_stream_init(NQ_PREFIX_STREAM *stream, uint32_t n_queens, uint32_t depth)
+{
+    if (n_queens < 1 || n_queens > NQ_CORE_MAX_N || depth < 1 || depth > n_queens || depth > NQ_PREFIX_MAX_DEPTH)
+    {
+        fprintf(stderr, "A frontier of depth %u cannot be built for N = %u (depth 1 to %d).\n", depth, n_queens,
+                NQ_PREFIX_MAX_DEPTH);
+        exit(EXIT_FAILURE);
+    }
+    stream->n_queens = n_queens;
+    stream->depth = depth;
+    stream->full = (1ULL << n_queens) - 1;
+    stream->cols[0] = 0;
+    stream->diag_up[0] = 0;
+    stream->diag_down[0] = 0;
+    stream->untried[0] = allowed_rows(stream, 0);
+    stream->column = 0;
+    stream->next_index = 0;
+    stream->placements = 0;
+    pthread_mutex_init(&stream->mutex, NULL);
+}
+
+void nq_stream_destroy(NQ_PREFIX_STREAM *stream)
+{
+    pthread_mutex_destroy(&stream->mutex);
+}
+
+int nq_stream_next(NQ_PREFIX_STREAM *stream, NQ_PREFIX *prefix)
+{
+    // resume the depth-first walk where the previous prefix left it
+    while (stream->column >= 0)
+    {
+        const uint32_t column = (uint32_t)stream->column;
+        if (stream->untried[column] == 0)
+        {
+            --stream->column;
+            continue;
+        }
+        const uint64_t bit = stream->untried[column] & -stream->untried[column];
+        stream->untried[column] ^= bit;
+        ++stream->placements;
+        stream->rows[column] = (uint32_t)__builtin_ctzll(bit);
+        const uint64_t cols = stream->cols[column] | bit;
+        const uint64_t diag_up = (stream->diag_up[column] | bit) << 1;
+        const uint64_t diag_down = (stream->diag_down[column] | bit) >> 1;
+        if (column + 1 == stream->depth)
+        {
+            prefix->index = stream->next_index++;
+            prefix->depth = stream->depth;
+            for (uint32_t j = 0; j < stream->depth; ++j)
+            {
+                prefix->rows[j] = stream->rows[j];
+            }
+            prefix->cols = cols;
+            prefix->diag_up = diag_up;
+            prefix->diag_down = diag_down;
+            return 1;
+        }
+        stream->cols[column + 1] = cols;
+        stream->diag_up[column + 1] = diag_up;
+        stream->diag_down[column + 1] = diag_down;
+        stream->untried[column + 1] = allowed_rows(stream, column + 1);
+        ++stream->column;
+    }
+    return 0;
+}
+
+uint32_t nq_stream_next_batch(NQ_PREFIX_STREAM *stream, NQ_PREFIX *prefixes, uint32_t max)
+{
+    uint32_t count = 0;
+    pthread_mutex_lock(&stream->mutex);
+    while (count < max && nq_stream_next(stream, &prefixes[count]))
+    {
+        ++count;
+    }
+    pthread_mutex_unlock(&stream->mutex);
+    return count;
+}
+
+void nq_stream_skip_to(NQ_PREFIX_STREAM *stream, uint64_t index)
+{
+    if (index < stream->next_index)
+    {
+        // the walk only goes forward: start it again
+        stream->cols[0] = 0;
+        stream->diag_up[0] = 0;
+        stream->diag_down[0] = 0;
+        stream->untried[0] = allowed_rows(stream, 0);
+        stream->column = 0;
+        stream->next_index = 0;
+        stream->placements = 0;
+    }
+    NQ_PREFIX skipped;
+    while (stream->next_index < index && nq_stream_next(stream, &skipped))
+    {
+    }
+}
+
+void nq_prefix_place(const NQ_PREFIX *prefix, CHESS_BOARD *board)
+{
+    for (uint32_t j = 0; j < prefix->depth; ++j)
+    {
+        set_queen(prefix->rows[j], board);
+    }
+    const uint32_t n = board->n_size;
+    board->start = 0;
+    // after a first queen on the middle row (odd N), the second one stays above it
+    board->end = prefix->depth == 1 && (n & 1) && prefix->rows[0] == n >> 1 ? n >> 1 : n;
+}
+
+void nq_prefix_remove(const NQ_PREFIX *prefix, CHESS_BOARD *board)
+{
+    for (uint32_t j = prefix->depth; j-- > 0;)
+    {
+        remove_queen(prefix->rows[j], board);
+    }
+}
+
+// One level of the breadth-first build: thread t expands parents [begin, end)
+typedef struct level_share
+{
+    const NQ_FRONTIER_ARRAY *array;
+    const NQ_FRONTIER_ENTRY *parents;
+    uint32_t column;
+    uint64_t begin;
+    uint64_t end;
+    NQ_FRONTIER_ENTRY *children;
+    uint64_t count;
+    uint64_t capacity;
+    // place of the children in the next level
+    NQ_FRONTIER_ENTRY *destination;
+} LEVEL_SHARE;
+
+static uint32_t online_threads(uint32_t threads)
+{
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return threads ? threads : (cpus > 0 ? (uint32_t)cpus : 1);
+}
+
+static void run_shares(void *(*work)(void *), LEVEL_SHARE *shares, uint32_t threads)
+{
+    pthread_t *th = malloc(sizeof(pthread_t) * threads);
+    if (th == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the frontier threads.\n");
+        exit(EXIT_FAILURE);
+    }
+    // the calling thread takes the first share
+    for (uint32_t t = 1; t < threads; ++t)
+    {
+        if (pthread_create(&th[t], NULL, work, &shares[t]) != 0)
+        {
+            perror("Failed to create the thread");
+            exit(EXIT_FAILURE);
+        }
+    }
+    work(&shares[0]);
+    for (uint32_t t = 1; t < threads; ++t)
+    {
+        pthread_join(th[t], NULL);
+    }
+    free(th);
+}
+
+static void *expand_share(void *args)
+{
+    LEVEL_SHARE *share = args;
+    const uint32_t n = share->array->n_queens;
+    const uint64_t full = (1ULL << n) - 1;
+    const uint32_t column = share->column;
+    for (uint64_t i = share->begin; i < share->end; ++i)
+    {
+        const NQ_FRONTIER_ENTRY *parent = &share->parents[i];
+        uint64_t free_rows = full & ~(parent->cols | parent->diag_up | parent->diag_down);
+        if (column == 0)
+        {
+            free_rows &= (1ULL << ((n + 1) >> 1)) - 1;
+        }
+        else if (column == 1 && (n & 1) && (parent->rows & 31) == n >> 1)
+        {
+            free_rows &= (1ULL << (n >> 1)) - 1;
+        }
+        while (free_rows)
+        {
+            const uint64_t bit = free_rows & -free_rows;
+            free_rows ^= bit;
+            if (share->count == share->capacity)
+            {
+                share->capacity = share->capacity ? 2 * share->capacity : 1024;
+                share->children = realloc(share->children, sizeof(NQ_FRONTIER_ENTRY) * share->capacity);
+                if (share->children == NULL)
+                {
+                    fprintf(stderr, "Memory allocation failed for the frontier.\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            NQ_FRONTIER_ENTRY *child = &share->children[share->count++];
+            child->cols = parent->cols | bit;
+            child->diag_up = (parent->diag_up | bit) << 1;
+            child->diag_down = (parent->diag_down | bit) >> 1;
+            child->rows = parent->rows | (uint64_t)__builtin_ctzll(bit) << (5 * column);
+        }
+    }
+    return NULL;
+}
+
+static void *copy_share(void *args)
+{
+    LEVEL_SHARE *share = args;
+    memcpy(share->destination, share->children, sizeof(NQ_FRONTIER_ENTRY) * share->count);
+    return NULL;
+}
+
+void nq_frontier_build(NQ_FRONTIER_ARRAY *array, uint32_t n_queens, uint32_t depth, uint32_t threads)
+{
+    if (n_queens < 1 || n_queens > NQ_CORE_MAX_N || depth < 1 || depth > n_queens ||
+        depth > NQ_FRONTIER_FILE_MAX_DEPTH)
+    {
+        fprintf(stderr, "A frontier of depth %u cannot be built for N = %u (depth 1 to %d).\n", depth, n_queens,
+                NQ_FRONTIER_FILE_MAX_DEPTH);
+        exit(EXIT_FAILURE);
+    }
+    threads = online_threads(threads);
+    array->n_queens = n_queens;
+    array->depth = depth;
+    array->count = 1;
+    array->placements = 0;
+    array->entries = calloc(1, sizeof(NQ_FRONTIER_ENTRY));
+    LEVEL_SHARE *shares = calloc(threads, sizeof(LEVEL_SHARE));
+    if (array->entries == NULL || shares == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the frontier.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (uint32_t column = 0; column < depth; ++column)
+    {
+        // the shallow levels are too small to be worth the threads
+        const uint32_t used = array->count < (uint64_t)threads * 64 ? 1 : threads;
+        for (uint32_t t = 0; t < used; ++t)
+        {
+            shares[t].array = array;
+            shares[t].parents = array->entries;
+            shares[t].column = column;
+            shares[t].begin = array->count * t / used;
+            shares[t].end = array->count * (t + 1) / used;
+            shares[t].count = 0;
+        }
+        run_shares(expand_share, shares, used);
+
+        // prefix sum of the buffer sizes: where each thread's children go
+        uint64_t total = 0;
+        for (uint32_t t = 0; t < used; ++t)
+        {
+            total += shares[t].count;
+        }
+        NQ_FRONTIER_ENTRY *next;
+        if (used == 1)
+        {
+            // a single buffer already is the next level
+            next = shares[0].children;
+            shares[0].children = NULL;
+            shares[0].capacity = 0;
+        }
+        else
+        {
+            next = malloc(sizeof(NQ_FRONTIER_ENTRY) * (total + 1));
+            if (next == NULL)
+            {
+                fprintf(stderr, "Memory allocation failed for the frontier.\n");
+                exit(EXIT_FAILURE);
+            }
+            uint64_t offset = 0;
+            for (uint32_t t = 0; t < used; ++t)
+            {
+                shares[t].destination = &next[offset];
+                offset += shares[t].count;
+            }
+            run_shares(copy_share, shares, used);
+        }
+        free(array->entries);
+        array->entries = next;
+        array->count = total;
+        array->placements += total;
+    }
+    for (uint32_t t = 0; t < threads; ++t)
+    {
+        free(shares[t].children);
+    }
+    free(shares);
+}
+
+void nq_frontier_array_free(NQ_FRONTIER_ARRAY *array)
+{
+    free(array->entries);
+    array->entries = NULL;
+    array->count = 0;
+}
+
+// Weights of the prefixes [begin, end) of a frontier array
+typedef struct weight_share
+{
+    const NQ_FRONTIER_ARRAY *array;
+    uint64_t begin;
+    uint64_t end;
+    double *weights;
+} WEIGHT_SHARE;
+
+static void *weigh_share(void *args)
+{
+    WEIGHT_SHARE *share = args;
+    const uint32_t depth = share->array->depth;
+    uint32_t rows[NQ_FRONTIER_FILE_MAX_DEPTH];
+    for (uint64_t i = share->begin; i < share->end; ++i)
+    {
+        for (uint32_t j = 0; j < depth; ++j)
+        {
+            rows[j] = (uint32_t)(share->array->entries[i].rows >> (5 * j)) & 31;
+        }
+        share->weights[i] =
+            estimator_prefix(share->array->n_queens, rows, depth, i, ESTIMATOR_DEFAULT_SAMPLES);
+    }
+    return NULL;
+}
+
+int nq_frontier_write(const char *path, uint32_t n_queens, uint32_t depth, int weights, uint32_t threads)
+{
+    if (depth > NQ_FRONTIER_FILE_MAX_DEPTH)
+    {
+        fprintf(stderr, "A frontier file holds prefixes of at most %d columns.\n", NQ_FRONTIER_FILE_MAX_DEPTH);
+        return 0;
+    }
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        perror("Failed to open the frontier file");
+        return 0;
+    }
+    NQ_FRONTIER_ARRAY array;
+    nq_frontier_build(&array, n_queens, depth, threads);
+    double *estimates = NULL;
+    if (weights)
+    {
+        // the estimates take far longer than the build: they are shared out as well
+        threads = online_threads(threads);
+        estimates = malloc(sizeof(double) * (array.count + 1));
+        WEIGHT_SHARE *shares = malloc(sizeof(WEIGHT_SHARE) * threads);
+        pthread_t *th = malloc(sizeof(pthread_t) * threads);
+        if (estimates == NULL || shares == NULL || th == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed for the frontier weights.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (uint32_t t = 0; t < threads; ++t)
+        {
+            shares[t] = (WEIGHT_SHARE){&array, array.count * t / threads, array.count * (t + 1) / threads, estimates};
+            if (t > 0 && pthread_create(&th[t], NULL, weigh_share, &shares[t]) != 0)
+            {
+                perror("Failed to create the thread");
+                exit(EXIT_FAILURE);
+            }
+        }
+        weigh_share(&shares[0]);
+        for (uint32_t t = 1; t < threads; ++t)
+        {
+            pthread_join(th[t], NULL);
+        }
+        free(th);
+        free(shares);
+    }
+
+    NQ_FRONTIER_HEADER header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FRONTIER_MAGIC, sizeof(header.magic));
+    header.version = NQ_FRONTIER_FILE_VERSION;
+    header.n_queens = n_queens;
+    header.depth = depth;
+    header.symmetry = NQ_SYMMETRY_HALF;
+    header.flags = weights ? NQ_FRONTIER_WEIGHTS : 0;
+    header.record_size = weights ? sizeof(uint64_t) + sizeof(double) : sizeof(uint64_t);
+    header.count = array.count;
+    header.placements = array.placements;
+    int written = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (uint64_t i = 0; i < array.count && written; ++i)
+    {
+        written = fwrite(&array.entries[i].rows, sizeof(uint64_t), 1, file) == 1 &&
+                  (!weights || fwrite(&estimates[i], sizeof(double), 1, file) == 1);
+    }
+    nq_frontier_array_free(&array);
+    free(estimates);
+    if (fclose(file) != 0 || !written)
+    {
+        perror("Failed to write the frontier file");
+        return 0;
+    }
+    return 1;
+}
+
+NQ_FRONTIER_FILE *nq_frontier_map(const char *path)
+{
+    NQ_FRONTIER_FILE *file = malloc(sizeof(NQ_FRONTIER_FILE));
+    if (file == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the frontier file.\n");
+        exit(EXIT_FAILURE);
+    }
+    file->fd = open(path, O_RDONLY);
+    struct stat st;
+    if (file->fd < 0 || fstat(file->fd, &st) != 0)
+    {
+        perror("Failed to open the frontier file");
+        if (file->fd >= 0)
+        {
+            close(file->fd);
+        }
+        free(file);
+        return NULL;
+    }
+    file->size = (uint64_t)st.st_size;
+    void *map = file->size >= sizeof(NQ_FRONTIER_HEADER)
+                    ? mmap(NULL, file->size, PROT_READ, MAP_SHARED, file->fd, 0)
+                    : MAP_FAILED;
+    const NQ_FRONTIER_HEADER *header = map;
+    // the record count is bounded before it is multiplied, so a forged one cannot wrap around
+    if (map == MAP_FAILED || memcmp(header->magic, FRONTIER_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != NQ_FRONTIER_FILE_VERSION || header->n_queens < 1 ||
+        header->n_queens > NQ_CORE_MAX_N || header->depth < 1 || header->depth > header->n_queens ||
+        header->depth > NQ_FRONTIER_FILE_MAX_DEPTH ||
+        (header->symmetry != NQ_SYMMETRY_NONE && header->symmetry != NQ_SYMMETRY_HALF) ||
+        header->record_size < sizeof(uint64_t) + ((header->flags & NQ_FRONTIER_WEIGHTS) ? sizeof(double) : 0) ||
+        header->count > (file->size - sizeof(NQ_FRONTIER_HEADER)) / header->record_size ||
+        file->size != sizeof(NQ_FRONTIER_HEADER) + header->count * header->record_size)
+    {
+        fprintf(stderr, "%s is not a frontier file of version %d.\n", path, NQ_FRONTIER_FILE_VERSION);
+        if (map != MAP_FAILED)
+        {
+            munmap(map, file->size);
+        }
+        close(file->fd);
+        free(file);
+        return NULL;
+    }
+    file->header = header;
+    file->records = (const uint8_t *)(header + 1);
+    return file;
+}
+
+void nq_frontier_unmap(NQ_FRONTIER_FILE *file)
+{
+    munmap((void *)file->header, file->size);
+    close(file->fd);
+    free(file);
+}
+
+void nq_frontier_get(const NQ_FRONTIER_FILE *file, uint64_t i, NQ_PREFIX *prefix)
+{
+    const uint64_t rows = nq_frontier_rows(file, i);
+    prefix->index = i;
+    prefix->depth = file->header->depth;
+    prefix->cols = 0;
+    prefix->diag_up = 0;
+    prefix->diag_down = 0;
+    for (uint32_t j = 0; j < prefix->depth; ++j)
+    {
+        prefix->rows[j] = (uint32_t)(rows >> (5 * j)) & 31;
+        const uint64_t bit = 1ULL << prefix->rows[j];
+        prefix->cols |= bit;
+        prefix->diag_up = (prefix->diag_up | bit) << 1;
+        prefix->diag_down = (prefix->diag_down | bit) >> 1;
+    }
+}
@@ -0,0 +1,158 @@
+#ifndef N_QUEENS_FRONTIER_H
+#define N_QUEENS_FRONTIER_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "n_queens_core.h"
+#include "n_queens_store.h"
+
+/* Frontier des préfixes de `depth` colonnes, produit à la demande au lieu
+ * d'être rangé d'avance dans un tableau. Le générateur ne garde que la pile
+ * d'un parcours en profondeur (O(depth)) et rend les préfixes toujours dans le
+ * même ordre (lignes croissantes, colonne après colonne), avec la symétrie de
+ * la demi-planche des programmes : première reine dans la moitié haute, et
+ * seconde reine au-dessus d'elle si la première est sur la ligne du milieu. */
+
+#define NQ_PREFIX_MAX_DEPTH 16
+
+typedef struct nq_prefix
+{
+    uint64_t index; // rang dans le frontier
+    uint32_t depth;
+    uint32_t rows[NQ_PREFIX_MAX_DEPTH];
+    // lignes et diagonales occupées pour la colonne `depth` (noyaux bitboard)
+    uint64_t cols;
+    uint64_t diag_up;
+    uint64_t diag_down;
+} NQ_PREFIX;
+
+typedef struct nq_prefix_stream
+{
+    uint32_t n_queens;
+    uint32_t depth;
+    uint64_t full;
+    // colonne j : lignes pas encore essayées, et l'état avant d'y placer une reine
+    uint64_t untried[NQ_PREFIX_MAX_DEPTH];
+    uint64_t cols[NQ_PREFIX_MAX_DEPTH];
+    uint64_t diag_up[NQ_PREFIX_MAX_DEPTH];
+    uint64_t diag_down[NQ_PREFIX_MAX_DEPTH];
+    uint32_t rows[NQ_PREFIX_MAX_DEPTH];
+    int32_t column; // colonne en cours, -1 une fois le frontier épuisé
+    uint64_t next_index;
+    uint64_t placements; // reines placées par le parcours
+    // pour nq_stream_next_batch, appelé par plusieurs threads
+    pthread_mutex_t mutex;
+} NQ_PREFIX_STREAM;
+
+/* Préparer le frontier de profondeur `depth` (1 à min(N, NQ_PREFIX_MAX_DEPTH)) */
+void nq_stream_init(NQ_PREFIX_STREAM *stream, uint32_t n_queens, uint32_t depth);
+void nq_stream_destroy(NQ_PREFIX_STREAM *stream);
+
+/* Préfixe suivant ; 0 quand il n'y en a plus. Sans verrou : un seul thread. */
+int nq_stream_next(NQ_PREFIX_STREAM *stream, NQ_PREFIX *prefix);
+
+/* Jusqu'à `max` préfixes suivants, sous le verrou du générateur : des
+ * threads peuvent y puiser en même temps. Renvoie le nombre obtenu (0 : fini). */
+uint32_t nq_stream_next_batch(NQ_PREFIX_STREAM *stream, NQ_PREFIX *prefixes, uint32_t max);
+
+/* Reprendre au préfixe de rang `index` (découpage entre processus, reprise
+ * après un point de contrôle). Le parcours est rejoué jusque-là : temps
+ * proportionnel à `index`, sans mémoire supplémentaire. */
+void nq_stream_skip_to(NQ_PREFIX_STREAM *stream, uint64_t index);
+
+/* Placer les reines du préfixe sur un échiquier vide (ou vidé par
+ * nq_prefix_remove) et fixer les lignes [start, end) de la colonne suivante */
+void nq_prefix_place(const NQ_PREFIX *prefix, CHESS_BOARD *board);
+/* Retirer les reines du préfixe, l'échiquier redevient vide */
+void nq_prefix_remove(const NQ_PREFIX *prefix, CHESS_BOARD *board);
+
+/* Frontier rangé d'un bloc, construit en largeur : chaque niveau est
+ * développé en parallèle, chaque thread une tranche contiguë des parents dans
+ * son propre tampon ; une somme préfixe des tailles donne la place de chaque
+ * tampon dans le tableau du niveau suivant, recopié en parallèle. Les
+ * préfixes sont dans le même ordre que ceux du générateur. */
+
+typedef struct nq_frontier_entry
+{
+    uint64_t cols;
+    uint64_t diag_up;
+    uint64_t diag_down;
+    uint64_t rows; // ligne de la colonne j sur les bits [5j, 5j + 5)
+} NQ_FRONTIER_ENTRY;
+
+typedef struct nq_frontier_array
+{
+    uint32_t n_queens;
+    uint32_t depth;
+    uint64_t count;
+    uint64_t placements; // reines placées pour construire le frontier
+    NQ_FRONTIER_ENTRY *entries;
+} NQ_FRONTIER_ARRAY;
+
+/* Construire le frontier de profondeur `depth` (1 à min(N, NQ_FRONTIER_FILE_MAX_DEPTH))
+ * avec `threads` threads (0 : un par CPU) ; à libérer par nq_frontier_array_free */
+void nq_frontier_build(NQ_FRONTIER_ARRAY *array, uint32_t n_queens, uint32_t depth, uint32_t threads);
+void nq_frontier_array_free(NQ_FRONTIER_ARRAY *array);
+
+/* Fichier de frontier : écrit une fois, projeté en lecture seule (mmap) par
+ * tous les threads et processus d'un nœud, qui partagent ainsi les mêmes
+ * pages. Un en-tête versionné, puis `count` enregistrements de taille fixe :
+ * les lignes du préfixe sur 5 bits par colonne (comme les clés du magasin de
+ * résultats), suivies du poids estimé du sous-arbre si le fichier en a. */
+
+#define NQ_FRONTIER_FILE_VERSION 1
+// lignes du préfixe sur 5 bits chacune dans un mot de 64 bits
+#define NQ_FRONTIER_FILE_MAX_DEPTH 12
+// les enregistrements portent un poids (double) après les lignes
+#define NQ_FRONTIER_WEIGHTS 1u
+
+typedef struct nq_frontier_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t n_queens;
+    uint32_t depth;
+    uint32_t symmetry; // NQ_SYMMETRY
+    uint32_t flags;
+    uint32_t record_size;
+    uint64_t count;
+    // reines placées pour produire le frontier
+    uint64_t placements;
+    uint64_t reserved;
+} NQ_FRONTIER_HEADER;
+
+typedef struct nq_frontier_file
+{
+    int fd;
+    uint64_t size;
+    const NQ_FRONTIER_HEADER *header;
+    const uint8_t *records;
+} NQ_FRONTIER_FILE;
+
+/* Écrire le frontier de profondeur `depth` (au plus NQ_FRONTIER_FILE_MAX_DEPTH)
+ * dans `path`, avec les poids estimés si `weights` ; le frontier et les poids
+ * sont calculés sur `threads` threads (0 : un par CPU). 0 en cas d'erreur */
+int nq_frontier_write(const char *path, uint32_t n_queens, uint32_t depth, int weights, uint32_t threads);
+
+/* Projeter un fichier de frontier en lecture seule ; NULL s'il est illisible
+ * ou d'une autre version */
+NQ_FRONTIER_FILE *nq_frontier_map(const char *path);
+void nq_frontier_unmap(NQ_FRONTIER_FILE *file);
+
+/* Lignes (5 bits par colonne) et poids du préfixe i, lus en place */
+static inline uint64_t nq_frontier_rows(const NQ_FRONTIER_FILE *file, uint64_t i)
+{
+    return *(const uint64_t *)(file->records + i * file->header->record_size);
+}
+static inline double nq_frontier_weight(const NQ_FRONTIER_FILE *file, uint64_t i)
+{
+    return (file->header->flags & NQ_FRONTIER_WEIGHTS)
+               ? *(const double *)(file->records + i * file->header->record_size + sizeof(uint64_t))
+               : 0.0;
+}
+
+/* Décoder le préfixe i (lignes et masques) */
+void nq_frontier_get(const NQ_FRONTIER_FILE *file, uint64_t i, NQ_PREFIX *prefix);
+
+#endif
@@ -0,0 +1,562 @@
+#include "n_queens_local.h"
+#include "n_queens_placement.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Steps between two looks at the clock and at the stop flag
+#define POLL_STEPS 1024
+#define DEFAULT_SAMPLES 8
+// Up to this N a step tries every row and lists the queens its move attacks;
+// above, it tries STEP_SAMPLES rows and the queens in conflict are listed
+// again by a full rescan every N / STEP_SAMPLES steps (the same cost per step)
+#define FULL_SCAN_MAX 2048
+#define STEP_SAMPLES 64
+// Fingerprint table: starts with this many slots, doubles when half full
+#define SEEN_INITIAL 1024
+
+// One thread's search: the placement and its counters
+typedef struct local_search
+{
+    uint32_t n;
+    uint32_t *positions;  // row of the queen of each column
+    uint32_t *rows;       // queens per row
+    uint32_t *diag_up;    // queens per rising diagonal, column - row + n - 1
+    uint32_t *diag_down;  // queens per falling diagonal, column + row
+    uint32_t *conflicted; // columns that may be in conflict (every queen in conflict is there)
+    uint8_t *listed;
+    uint32_t listed_count;
+    uint32_t *empty;       // rows without a queen, and the place of each row in that list
+    uint32_t *empty_index;
+    uint32_t empty_count;
+    uint32_t since_rescan;
+    uint64_t random;
+    uint64_t steps;
+    uint64_t restarts;
+} LOCAL_SEARCH;
+
+// Distinct solutions of all threads, and the stop condition
+typedef struct local_shared
+{
+    pthread_mutex_t mutex;
+    const NQ_LOCAL_CONFIG *config;
+    uint64_t *seen; // fingerprints, 0 for a free slot
+    uint64_t seen_capacity;
+    uint64_t solutions;
+    uint64_t duplicates;
+    uint64_t invalid;
+    uint32_t kept;
+    uint32_t *positions;
+    double deadline;
+    int stop;
+} LOCAL_SHARED;
+
+typedef struct local_thread
+{
+    LOCAL_SEARCH search;
+    LOCAL_SHARED *shared;
+} LOCAL_THREAD;
+
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+static uint32_t online_cpus(void)
+{
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (uint32_t)cpus : 1;
+}
+
+// xorshift64*, seeded through splitmix64 so that close seeds differ
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static uint64_t mix_seed(uint64_t seed)
+{
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return z ? z : 1;
+}
+
+static uint32_t random_below(LOCAL_SEARCH *search, uint32_t bound)
+{
+    return (uint32_t)(((next_random(&search->random) >> 32) * bound) >> 32);
+}
+
+static void search_init(LOCAL_SEARCH *search, uint32_t n, uint64_t seed)
+{
+    search->n = n;
+    // positions, rows, two diagonals of 2n - 1, the listed columns and the
+    // empty rows in one block
+    search->positions = malloc(sizeof(uint32_t) * (9 * (size_t)n) + n);
+    if (search->positions == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the local search.\n");
+        exit(EXIT_FAILURE);
+    }
+    search->rows = search->positions + n;
+    search->diag_up = search->rows + n;
+    search->diag_down = search->diag_up + 2 * n - 1;
+    search->conflicted = search->diag_down + 2 * n - 1;
+    search->empty = search->conflicted + n;
+    search->empty_index = search->empty + n;
+    search->listed = (uint8_t *)(search->empty_index + n + 2);
+    search->listed_count = 0;
+    search->random = mix_seed(seed);
+    search->steps = 0;
+    search->restarts = 0;
+}
+
+static void search_destroy(LOCAL_SEARCH *search)
+{
+    free(search->positions);
+}
+
+static inline uint32_t square_load(const LOCAL_SEARCH *search, uint32_t column, uint32_t row)
+{
+    return search->rows[row] + search->diag_up[column + search->n - 1 - row] + search->diag_down[column + row];
+}
+
+static inline void place(LOCAL_SEARCH *search, uint32_t column, uint32_t row)
+{
+    search->positions[column] = row;
+    if (search->rows[row]++ == 0)
+    {
+        // swap the row out of the empty list
+        const uint32_t last = search->empty[--search->empty_count];
+        search->empty[search->empty_index[row]] = last;
+        search->empty_index[last] = search->empty_index[row];
+    }
+    ++search->diag_up[column + search->n - 1 - row];
+    ++search->diag_down[column + row];
+}
+
+static inline void lift(LOCAL_SEARCH *search, uint32_t column)
+{
+    const uint32_t row = search->positions[column];
+    if (--search->rows[row] == 0)
+    {
+        search->empty_index[row] = search->empty_count;
+        search->empty[search->empty_count++] = row;
+    }
+    --search->diag_up[column + search->n - 1 - row];
+    --search->diag_down[column + row];
+}
+
+// Queens attacking the queen of `column`
+static inline uint32_t conflicts(const LOCAL_SEARCH *search, uint32_t column)
+{
+    return square_load(search, column, search->positions[column]) - 3;
+}
+
+static void list_add(LOCAL_SEARCH *search, uint32_t column)
+{
+    if (!search->listed[column])
+    {
+        search->listed[column] = 1;
+        search->conflicted[search->listed_count++] = column;
+    }
+}
+
+static void list_remove(LOCAL_SEARCH *search, uint32_t index)
+{
+    search->listed[search->conflicted[index]] = 0;
+    search->conflicted[index] = search->conflicted[--search->listed_count];
+}
+
+// List every queen in conflict; 0 when there is none (a solution)
+static uint32_t search_rescan(LOCAL_SEARCH *search)
+{
+    search->since_rescan = 0;
+    for (uint32_t column = 0; column < search->n; ++column)
+    {
+        if (conflicts(search, column) > 0)
+        {
+            list_add(search, column);
+        }
+    }
+    return search->listed_count;
+}
+
+// Greedy start: each column takes the least attacked of a few random empty
+// rows, so that only diagonals are in conflict
+static void search_restart(LOCAL_SEARCH *search, uint32_t samples)
+{
+    const uint32_t n = search->n;
+    memset(search->rows, 0, sizeof(uint32_t) * (5 * (size_t)n - 2));
+    memset(search->listed, 0, n);
+    search->listed_count = 0;
+    for (uint32_t row = 0; row < n; ++row)
+    {
+        search->empty[row] = row;
+        search->empty_index[row] = row;
+    }
+    search->empty_count = n;
+    for (uint32_t column = 0; column < n; ++column)
+    {
+        uint32_t best = search->empty[random_below(search, search->empty_count)];
+        uint32_t best_load = square_load(search, column, best);
+        for (uint32_t s = 1; s < samples && best_load > 0; ++s)
+        {
+            const uint32_t row = search->empty[random_below(search, search->empty_count)];
+            const uint32_t load = square_load(search, column, row);
+            if (load < best_load)
+            {
+                best = row;
+                best_load = load;
+            }
+        }
+        place(search, column, best);
+    }
+    search_rescan(search);
+    ++search->restarts;
+}
+
+// Move a few queens at random, then list every queen in conflict
+static void search_kick(LOCAL_SEARCH *search, uint32_t kick)
+{
+    for (uint32_t k = 0; k < kick; ++k)
+    {
+        const uint32_t column = random_below(search, search->n);
+        lift(search, column);
+        place(search, column, random_below(search, search->n));
+    }
+    search_rescan(search);
+}
+
+// Keep `row` for the queen of `column` if it is the least attacked so far
+static inline void consider(LOCAL_SEARCH *search, uint32_t column, uint32_t row, uint32_t current, uint32_t *best,
+                            uint32_t *best_load, uint32_t *ties)
+{
+    const uint32_t load = row == current ? UINT32_MAX : square_load(search, column, row);
+    if (load < *best_load)
+    {
+        *best = row;
+        *best_load = load;
+        *ties = 1;
+    }
+    else if (load == *best_load && random_below(search, ++*ties) == 0)
+    {
+        // each of the tied rows is kept with the same probability
+        *best = row;
+    }
+}
+
+// One min-conflicts step on a random listed column
+static void search_step(LOCAL_SEARCH *search)
+{
+    const uint32_t n = search->n;
+    const uint32_t index = random_below(search, search->listed_count);
+    const uint32_t column = search->conflicted[index];
+    if (conflicts(search, column) == 0)
+    {
+        list_remove(search, index);
+        return;
+    }
+    // the queen always moves: staying put would keep a local minimum forever
+    const uint32_t current = search->positions[column];
+    lift(search, column);
+    uint32_t best = current, best_load = UINT32_MAX, ties = 0;
+    const int full_scan = n <= FULL_SCAN_MAX;
+    if (full_scan)
+    {
+        for (uint32_t row = 0; row < n; ++row)
+        {
+            consider(search, column, row, current, &best, &best_load, &ties);
+        }
+    }
+    else
+    {
+        // near a solution the few empty rows are where the free squares are:
+        // up to half the samples go through them, the rest are random rows
+        const uint32_t empty_count = search->empty_count;
+        const uint32_t from_empty = empty_count < STEP_SAMPLES / 2 ? empty_count : STEP_SAMPLES / 2;
+        const uint32_t first = empty_count ? random_below(search, empty_count) : 0;
+        for (uint32_t t = 0; t < from_empty; ++t)
+        {
+            const uint32_t i = first + t < empty_count ? first + t : first + t - empty_count;
+            consider(search, column, search->empty[i], current, &best, &best_load, &ties);
+        }
+        for (uint32_t t = from_empty; t < STEP_SAMPLES && best_load > 0; ++t)
+        {
+            consider(search, column, random_below(search, n), current, &best, &best_load, &ties);
+        }
+    }
+    if (best_load == UINT32_MAX)
+    {
+        // every sample hit the current row
+        best_load = square_load(search, column, current);
+    }
+    place(search, column, best);
+    ++search->steps;
+    if (best_load == 0)
+    {
+        list_remove(search, index);
+        return;
+    }
+    if (!full_scan)
+    {
+        if (++search->since_rescan >= n / STEP_SAMPLES)
+        {
+            search_rescan(search);
+        }
+        return;
+    }
+    // the queens it now attacks may have to move too: list them (another O(n)
+    // pass, like the choice of the row)
+    for (uint32_t other = 0; other < n; ++other)
+    {
+        const uint32_t row = search->positions[other];
+        const uint32_t rows_apart = row > best ? row - best : best - row;
+        const uint32_t columns_apart = other > column ? other - column : column - other;
+        if (other != column && (row == best || rows_apart == columns_apart))
+        {
+            list_add(search, other);
+        }
+    }
+}
+
+static uint64_t fingerprint(const uint32_t *positions, uint32_t n)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (uint32_t j = 0; j < n; ++j)
+    {
+        hash = (hash ^ positions[j]) * 0x100000001B3ULL;
+        hash ^= hash >> 29;
+    }
+    return hash ? hash : 1;
+}
+
+// 1 if the fingerprint is new; the table is held under the mutex
+static int seen_insert(LOCAL_SHARED *shared, uint64_t key)
+{
+    if (2 * (shared->solutions + 1) > shared->seen_capacity)
+    {
+        const uint64_t capacity = shared->seen_capacity * 2;
+        uint64_t *seen = calloc(capacity, sizeof(uint64_t));
+        if (seen == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed for the solution fingerprints.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (uint64_t i = 0; i < shared->seen_capacity; ++i)
+        {
+            if (shared->seen[i])
+            {
+                uint64_t slot = shared->seen[i] & (capacity - 1);
+                while (seen[slot])
+                {
+                    slot = (slot + 1) & (capacity - 1);
+                }
+                seen[slot] = shared->seen[i];
+            }
+        }
+        free(shared->seen);
+        shared->seen = seen;
+        shared->seen_capacity = capacity;
+    }
+    uint64_t slot = key & (shared->seen_capacity - 1);
+    while (shared->seen[slot])
+    {
+        if (shared->seen[slot] == key)
+        {
+            return 0;
+        }
+        slot = (slot + 1) & (shared->seen_capacity - 1);
+    }
+    shared->seen[slot] = key;
+    return 1;
+}
+
+static void shared_solution(LOCAL_SHARED *shared, const LOCAL_SEARCH *search)
+{
+    const NQ_LOCAL_CONFIG *config = shared->config;
+    // checked outside the lock, by the same path as the other placements
+    const int valid = !config->verify || nq_verify_placement(search->n, search->positions, 1);
+    const uint64_t key = fingerprint(search->positions, search->n);
+    pthread_mutex_lock(&shared->mutex);
+    if (!valid)
+    {
+        ++shared->invalid;
+    }
+    else if (!seen_insert(shared, key))
+    {
+        ++shared->duplicates;
+    }
+    else
+    {
+        ++shared->solutions;
+        if (shared->kept < config->keep)
+        {
+            memcpy(&shared->positions[(size_t)shared->kept * search->n], search->positions,
+                   sizeof(uint32_t) * search->n);
+            ++shared->kept;
+        }
+        if (config->target && shared->solutions >= config->target)
+        {
+            __atomic_store_n(&shared->stop, 1, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&shared->mutex);
+}
+
+static int shared_stopped(LOCAL_SHARED *shared)
+{
+    if (__atomic_load_n(&shared->stop, __ATOMIC_ACQUIRE))
+    {
+        return 1;
+    }
+    if (shared->deadline > 0 && now() >= shared->deadline)
+    {
+        __atomic_store_n(&shared->stop, 1, __ATOMIC_RELEASE);
+        return 1;
+    }
+    return 0;
+}
+
+static void *local_thread_main(void *arg)
+{
+    LOCAL_THREAD *thread = arg;
+    LOCAL_SEARCH *search = &thread->search;
+    LOCAL_SHARED *shared = thread->shared;
+    const NQ_LOCAL_CONFIG *config = shared->config;
+    const uint32_t n = config->n_queens;
+    const uint32_t samples = config->samples ? config->samples : DEFAULT_SAMPLES;
+    const uint32_t kick = config->kick ? config->kick : 4 + n / 256;
+    const uint64_t max_steps = config->max_steps ? config->max_steps : 100 * (uint64_t)n;
+
+    search_restart(search, samples);
+    uint64_t since_solution = 0;
+    uint32_t poll = 0;
+    while (1)
+    {
+        if (search->listed_count == 0 && search_rescan(search) == 0)
+        {
+            shared_solution(shared, search);
+            if (shared_stopped(shared))
+            {
+                break;
+            }
+            search_kick(search, kick);
+            since_solution = 0;
+            continue;
+        }
+        search_step(search);
+        if (++since_solution > max_steps)
+        {
+            search_restart(search, samples);
+            since_solution = 0;
+        }
+        if (++poll == POLL_STEPS)
+        {
+            poll = 0;
+            if (shared_stopped(shared))
+            {
+                break;
+            }
+        }
+    }
+    return NULL;
+}
+
+void nq_local_config_default(NQ_LOCAL_CONFIG *config, uint32_t n_queens)
+{
+    config->n_queens = n_queens;
+    config->threads = 0;
+    config->seed = 0x6D696E636F6E66ULL;
+    config->target = 1;
+    config->seconds = 10.0;
+    config->samples = DEFAULT_SAMPLES;
+    config->kick = 0;
+    config->max_steps = 0;
+    config->keep = 1;
+    config->verify = 1;
+}
+
+int nq_local_search(const NQ_LOCAL_CONFIG *config, NQ_LOCAL_RESULT *result)
+{
+    memset(result, 0, sizeof(NQ_LOCAL_RESULT));
+    if (config->n_queens < 1 || (config->target == 0 && config->seconds <= 0))
+    {
+        fprintf(stderr, "The local search needs N >= 1 and a target or a time limit.\n");
+        return -1;
+    }
+    if ((config->n_queens == 2 || config->n_queens == 3) && config->seconds <= 0)
+    {
+        fprintf(stderr, "N = %u has no solution: the local search needs a time limit.\n", config->n_queens);
+        return -1;
+    }
+    const uint32_t n = config->n_queens;
+    const uint32_t threads = config->threads ? config->threads : online_cpus();
+    const double start = now();
+
+    LOCAL_SHARED shared;
+    pthread_mutex_init(&shared.mutex, NULL);
+    shared.config = config;
+    shared.seen_capacity = SEEN_INITIAL;
+    shared.seen = calloc(SEEN_INITIAL, sizeof(uint64_t));
+    shared.positions = malloc(sizeof(uint32_t) * n * (size_t)(config->keep ? config->keep : 1));
+    LOCAL_THREAD *workers = malloc(sizeof(LOCAL_THREAD) * threads);
+    pthread_t *ids = malloc(sizeof(pthread_t) * threads);
+    if (shared.seen == NULL || shared.positions == NULL || workers == NULL || ids == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the local search.\n");
+        exit(EXIT_FAILURE);
+    }
+    shared.solutions = shared.duplicates = shared.invalid = 0;
+    shared.kept = 0;
+    shared.deadline = config->seconds > 0 ? start + config->seconds : 0.0;
+    shared.stop = 0;
+
+    for (uint32_t t = 0; t < threads; ++t)
+    {
+        search_init(&workers[t].search, n, config->seed + t);
+        workers[t].shared = &shared;
+        if (pthread_create(&ids[t], NULL, local_thread_main, &workers[t]) != 0)
+        {
+            fprintf(stderr, "Failed to create a local search thread.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (uint32_t t = 0; t < threads; ++t)
+    {
+        pthread_join(ids[t], NULL);
+        result->steps += workers[t].search.steps;
+        result->restarts += workers[t].search.restarts;
+        search_destroy(&workers[t].search);
+    }
+    result->seconds = now() - start;
+    result->solutions = shared.solutions;
+    result->duplicates = shared.duplicates;
+    result->invalid = shared.invalid;
+    result->kept = shared.kept;
+    result->positions = shared.positions;
+    free(shared.seen);
+    free(workers);
+    free(ids);
+    pthread_mutex_destroy(&shared.mutex);
+    return 0;
+}
+
+void nq_local_result_free(NQ_LOCAL_RESULT *result)
+{
+    free(result->positions);
+    result->positions = NULL;
+    result->kept = 0;
+}
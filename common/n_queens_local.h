@@ -0,0 +1,53 @@
+#ifndef N_QUEENS_LOCAL_H
+#define N_QUEENS_LOCAL_H
+
+#include <stdint.h>
+
+/* Recherche locale min-conflicts pour les grands N, quand il faut beaucoup de
+ * placements différents et non la seule construction explicite. Le placement
+ * est rangé comme queen_positions (ligne de la reine de chaque colonne) ; des
+ * compteurs de reines par ligne et par diagonale donnent les conflits d'une
+ * case et se mettent à jour en O(1) quand une reine bouge. Départ glouton
+ * (meilleure de quelques lignes tirées au hasard), puis une colonne en
+ * conflit, tirée au hasard, prend la ligne de moindre conflit (égalités
+ * tirées au hasard) ; au-delà de N = 2048 elle n'essaie que 64 lignes et les
+ * conflits sont recomptés tous les N / 64 pas. Après une solution, quelques
+ * reines sont déplacées au hasard et réparées ; au-delà de max_steps pas sans
+ * solution, la recherche repart de zéro. Un thread par recherche, chacun avec
+ * sa graine ; les solutions sont dédoublonnées par leur empreinte de 64
+ * bits. */
+
+typedef struct nq_local_config
+{
+    uint32_t n_queens;
+    uint32_t threads;   // 0 : un par CPU
+    uint64_t seed;
+    uint64_t target;    // solutions distinctes voulues (0 : jusqu'à la limite de temps)
+    double seconds;     // limite de temps (0 : aucune, il faut alors un target)
+    uint32_t samples;   // lignes essayées par colonne au départ glouton
+    uint32_t kick;      // reines déplacées après une solution (0 : 4 + N / 256)
+    uint64_t max_steps; // pas sans solution avant de repartir (0 : 100 N)
+    uint32_t keep;      // solutions gardées dans le résultat
+    int verify;         // vérifier chaque solution avec nq_verify_placement
+} NQ_LOCAL_CONFIG;
+
+typedef struct nq_local_result
+{
+    uint64_t solutions;  // solutions distinctes
+    uint64_t duplicates; // solutions déjà trouvées (par ce thread ou un autre)
+    uint64_t invalid;    // solutions refusées par la vérification (0 attendu)
+    uint64_t steps;      // reines déplacées par la réparation
+    uint64_t restarts;
+    double seconds;
+    uint32_t kept;
+    uint32_t *positions; // kept x N lignes, comme queen_positions
+} NQ_LOCAL_RESULT;
+
+/* 1 solution, 10 s au plus, threads et graine par défaut, vérification */
+void nq_local_config_default(NQ_LOCAL_CONFIG *config, uint32_t n_queens);
+
+/* 0 si tout va bien, -1 si la configuration est invalide */
+int nq_local_search(const NQ_LOCAL_CONFIG *config, NQ_LOCAL_RESULT *result);
+void nq_local_result_free(NQ_LOCAL_RESULT *result);
+
+#endif
@@ -0,0 +1,207 @@
+#include "n_queens_memo.h"
+#include "n_queens_core.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MEMO_COUNT_BITS 56
+#define MEMO_COUNT_MASK ((1ULL << MEMO_COUNT_BITS) - 1)
+
+static uint64_t mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Reverse the n low bits (swap halves, quarters, ... of the 64-bit word)
+static uint64_t reverse_rows(uint64_t x, uint32_t n)
+{
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    x = __builtin_bswap64(x);
+    return x >> (64 - n);
+}
+
+// Key of a state, the same for its mirror image: flipping the rows turns the
+// rising diagonals into falling ones
+static uint64_t canonical_key(uint32_t n, uint64_t cols, uint64_t diag_up, uint64_t diag_down)
+{
+    const uint64_t key = cols | (diag_up << n) | (diag_down << (2 * n));
+    const uint64_t mirror = reverse_rows(cols, n) | (reverse_rows(diag_down, n) << n) |
+                            (reverse_rows(diag_up, n) << (2 * n));
+    // never 0: at least one queen is on the board
+    return key < mirror ? key : mirror;
+}
+
+static uint32_t log2_size(uint64_t nodes)
+{
+    uint32_t bits = 0;
+    while (nodes)
+    {
+        ++bits;
+        nodes >>= 1;
+    }
+    return bits;
+}
+
+NQ_MEMO *nq_memo_create(uint32_t n_queens, uint64_t bytes, uint32_t min_depth, uint32_t max_depth)
+{
+    if (n_queens < 1 || n_queens > NQ_MEMO_MAX_N)
+    {
+        fprintf(stderr, "The transposition table needs between 1 and %d queens.\n", NQ_MEMO_MAX_N);
+        exit(EXIT_FAILURE);
+    }
+    NQ_MEMO *memo = malloc(sizeof(NQ_MEMO));
+    if (memo == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the transposition table.\n");
+        exit(EXIT_FAILURE);
+    }
+    // a power of two of buckets, at least one
+    uint64_t buckets = 1;
+    while (2 * buckets * NQ_MEMO_BUCKET * sizeof(NQ_MEMO_ENTRY) <= bytes)
+    {
+        buckets *= 2;
+    }
+    memo->entries = calloc(buckets * NQ_MEMO_BUCKET, sizeof(NQ_MEMO_ENTRY));
+    if (memo->entries == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the transposition table.\n");
+        exit(EXIT_FAILURE);
+    }
+    memo->bucket_mask = buckets - 1;
+    memo->n_queens = n_queens;
+    memo->min_depth = min_depth ? min_depth : (n_queens / 2 > 0 ? n_queens / 2 : 1);
+    memo->max_depth = max_depth ? max_depth : memo->min_depth;
+    return memo;
+}
+
+void nq_memo_destroy(NQ_MEMO *memo)
+{
+    free(memo->entries);
+    free(memo);
+}
+
+uint64_t nq_memo_occupancy(const NQ_MEMO *memo)
+{
+    uint64_t used = 0;
+    for (uint64_t i = 0; i < (memo->bucket_mask + 1) * NQ_MEMO_BUCKET; ++i)
+    {
+        used += __atomic_load_n(&memo->entries[i].data, __ATOMIC_RELAXED) != 0;
+    }
+    return used;
+}
+
+void nq_memo_stats_add(NQ_MEMO_STATS *into, const NQ_MEMO_STATS *from)
+{
+    into->hits += from->hits;
+    into->misses += from->misses;
+    into->stores += from->stores;
+    into->replacements += from->replacements;
+}
+
+static NQ_MEMO_ENTRY *bucket_of(NQ_MEMO *memo, uint64_t key)
+{
+    return &memo->entries[(mix(key) & memo->bucket_mask) * NQ_MEMO_BUCKET];
+}
+
+static int memo_lookup(NQ_MEMO *memo, uint64_t key, uint64_t *solutions)
+{
+    NQ_MEMO_ENTRY *bucket = bucket_of(memo, key);
+    for (int i = 0; i < NQ_MEMO_BUCKET; ++i)
+    {
+        const uint64_t data = __atomic_load_n(&bucket[i].data, __ATOMIC_RELAXED);
+        const uint64_t check = __atomic_load_n(&bucket[i].check, __ATOMIC_RELAXED);
+        if (data != 0 && (check ^ data) == key)
+        {
+            *solutions = data & MEMO_COUNT_MASK;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void memo_store(NQ_MEMO *memo, uint64_t key, uint64_t solutions, uint64_t nodes, NQ_MEMO_STATS *stats)
+{
+    // the size is stored +1 so that an entry is never all zeros
+    const uint64_t data = (solutions & MEMO_COUNT_MASK) | ((uint64_t)(log2_size(nodes) + 1) << MEMO_COUNT_BITS);
+    NQ_MEMO_ENTRY *bucket = bucket_of(memo, key);
+    int victim = 0;
+    uint64_t victim_size = UINT64_MAX;
+    for (int i = 0; i < NQ_MEMO_BUCKET; ++i)
+    {
+        const uint64_t old = __atomic_load_n(&bucket[i].data, __ATOMIC_RELAXED);
+        if (old == 0)
+        {
+            victim = i;
+            victim_size = 0;
+            break;
+        }
+        if ((old >> MEMO_COUNT_BITS) < victim_size)
+        {
+            victim = i;
+            victim_size = old >> MEMO_COUNT_BITS;
+        }
+    }
+    if (victim_size != 0)
+    {
+        ++stats->replacements;
+    }
+    ++stats->stores;
+    __atomic_store_n(&bucket[victim].data, data, __ATOMIC_RELAXED);
+    __atomic_store_n(&bucket[victim].check, key ^ data, __ATOMIC_RELAXED);
+}
+
+static uint64_t memo_search(NQ_MEMO *memo, uint64_t full, uint64_t cols, uint64_t diag_up, uint64_t diag_down,
+                            uint32_t depth, uint64_t *placements, NQ_MEMO_STATS *stats)
+{
+    if (depth > memo->max_depth)
+    {
+        return nq_bitboard_subtree(full, cols, diag_up, diag_down, placements);
+    }
+    if (cols == full)
+    {
+        return 1;
+    }
+    const int memoised = depth >= memo->min_depth;
+    uint64_t key = 0, solutions = 0;
+    if (memoised)
+    {
+        // the diagonals outside the board never matter again
+        key = canonical_key(memo->n_queens, cols, diag_up & full, diag_down);
+        if (memo_lookup(memo, key, &solutions))
+        {
+            ++stats->hits;
+            return solutions;
+        }
+        ++stats->misses;
+    }
+    const uint64_t visited = *placements;
+    uint64_t free_rows = full & ~(cols | diag_up | diag_down);
+    while (free_rows)
+    {
+        const uint64_t bit = free_rows & -free_rows;
+        free_rows ^= bit;
+        ++*placements;
+        solutions += memo_search(memo, full, cols | bit, (diag_up | bit) << 1, (diag_down | bit) >> 1, depth + 1,
+                                 placements, stats);
+    }
+    if (memoised)
+    {
+        memo_store(memo, key, solutions, *placements - visited, stats);
+    }
+    return solutions;
+}
+
+uint64_t nq_memo_subtree(NQ_MEMO *memo, uint64_t cols, uint64_t diag_up, uint64_t diag_down,
+                         uint64_t *placements, NQ_MEMO_STATS *stats)
+{
+    const uint64_t full = (1ULL << memo->n_queens) - 1;
+    return memo_search(memo, full, cols, diag_up, diag_down, (uint32_t)__builtin_popcountll(cols), placements,
+                       stats);
+}
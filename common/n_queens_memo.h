@@ -0,0 +1,64 @@
+#ifndef N_QUEENS_MEMO_H
+#define N_QUEENS_MEMO_H
+
+#include <stdint.h>
+
+/* Table de transposition : des préfixes différents laissent souvent le même
+ * état (lignes occupées, diagonales qui touchent la colonne suivante) et donc
+ * le même nombre de solutions en dessous. La table garde ce nombre pour les
+ * états des profondeurs [min_depth, max_depth].
+ *
+ * - taille fixe, partagée par tous les threads, sans verrou : une entrée est
+ *   une paire (clé ^ données, données) écrite en deux mots ; une lecture qui
+ *   croise une écriture voit une paire incohérente et la traite comme absente
+ * - l'état et son image miroir (lignes inversées) ont la même clé
+ * - remplacement : dans un seau de 4 entrées (une ligne de cache), une
+ *   entrée libre, sinon celle du plus petit sous-arbre
+ *
+ * La clé tient sur 3 * N bits, d'où la limite de N. */
+
+#define NQ_MEMO_MAX_N 21
+#define NQ_MEMO_BUCKET 4
+
+typedef struct nq_memo_entry
+{
+    uint64_t check; // clé ^ data
+    uint64_t data;  // solutions (56 bits), log2 de la taille du sous-arbre (8 bits)
+} NQ_MEMO_ENTRY;
+
+typedef struct nq_memo
+{
+    NQ_MEMO_ENTRY *entries;
+    uint64_t bucket_mask;
+    uint32_t n_queens;
+    uint32_t min_depth;
+    uint32_t max_depth;
+} NQ_MEMO;
+
+/* Compteurs d'un appelant (un thread, une tâche), additionnés ensuite */
+typedef struct nq_memo_stats
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t stores;
+    uint64_t replacements; // entrées occupées écrasées
+} NQ_MEMO_STATS;
+
+/* Créer une table d'au plus `bytes` octets pour N = n_queens. Les profondeurs
+ * à 0 prennent les valeurs par défaut : min_depth = N / 2 (1 au moins), et
+ * max_depth = min_depth, soit la seule profondeur N / 2. */
+NQ_MEMO *nq_memo_create(uint32_t n_queens, uint64_t bytes, uint32_t min_depth, uint32_t max_depth);
+void nq_memo_destroy(NQ_MEMO *memo);
+
+/* Nombre d'entrées occupées */
+uint64_t nq_memo_occupancy(const NQ_MEMO *memo);
+
+/* Comme nq_bitboard_subtree, en consultant et remplissant la table ; les
+ * placements des sous-arbres trouvés dans la table ne sont pas comptés */
+uint64_t nq_memo_subtree(NQ_MEMO *memo, uint64_t cols, uint64_t diag_up, uint64_t diag_down,
+                         uint64_t *placements, NQ_MEMO_STATS *stats);
+
+/* Additionner les compteurs de `from` dans `into` */
+void nq_memo_stats_add(NQ_MEMO_STATS *into, const NQ_MEMO_STATS *from);
+
+#endif
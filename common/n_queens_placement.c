@@ -0,0 +1,126 @@
+#include "n_queens_placement.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static int placement_threads(uint32_t threads)
+{
+#ifdef _OPENMP
+    return threads ? (int)threads : omp_get_max_threads();
+#else
+    (void)threads;
+    return 1;
+#endif
+}
+
+// Row (from 1) of column i (from 0): the even rows, then the odd ones
+static uint64_t construct_row(uint64_t n_queens, uint64_t i)
+{
+    const uint64_t evens = n_queens / 2;
+    const uint64_t odds = n_queens - evens;
+    switch (n_queens % 6)
+    {
+    case 2:
+        // 2, 4, ..., n then 3, 1, 7, 9, ..., n - 1, 5
+        if (i < evens)
+        {
+            return 2 * i + 2;
+        }
+        i -= evens;
+        return i == 0 ? 3 : (i == 1 ? 1 : (i == odds - 1 ? 5 : 2 * i + 3));
+    case 3:
+        // 4, 6, ..., n - 1, 2 then 5, 7, ..., n, 1, 3
+        if (i < evens)
+        {
+            return i == evens - 1 ? 2 : 2 * i + 4;
+        }
+        i -= evens;
+        return i == odds - 2 ? 1 : (i == odds - 1 ? 3 : 2 * i + 5);
+    default:
+        // 2, 4, ..., then 1, 3, ...
+        return i < evens ? 2 * i + 2 : 2 * (i - evens) + 1;
+    }
+}
+
+int nq_construct_placement(uint64_t n_queens, uint32_t *positions, uint32_t threads)
+{
+    if (n_queens == 2 || n_queens == 3 || n_queens > UINT32_MAX)
+    {
+        return 0;
+    }
+    if (n_queens == 1)
+    {
+        positions[0] = 0;
+        return 1;
+    }
+    const int workers = placement_threads(threads);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(workers)
+#else
+    (void)workers;
+#endif
+    for (uint64_t i = 0; i < n_queens; ++i)
+    {
+        positions[i] = (uint32_t)(construct_row(n_queens, i) - 1);
+    }
+    return 1;
+}
+
+int nq_verify_placement(uint64_t n_queens, const uint32_t *positions, uint32_t threads)
+{
+    if (n_queens == 0)
+    {
+        return 1;
+    }
+    // rows, then rising and falling diagonals
+    uint8_t *used = calloc(5 * n_queens - 2, 1);
+    if (used == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the placement check.\n");
+        exit(EXIT_FAILURE);
+    }
+    uint8_t *rows = used;
+    uint8_t *diag_up = rows + n_queens;
+    uint8_t *diag_down = diag_up + 2 * n_queens - 1;
+    const int workers = placement_threads(threads);
+    int conflicts = 0;
+    if (workers == 1)
+    {
+        // alone: plain loads and stores, the locked exchanges cost several times more
+        for (uint64_t j = 0; j < n_queens && conflicts == 0; ++j)
+        {
+            const uint64_t row = positions[j];
+            if (row >= n_queens)
+            {
+                ++conflicts;
+                break;
+            }
+            conflicts += rows[row] + diag_up[n_queens - 1 + j - row] + diag_down[j + row];
+            rows[row] = diag_up[n_queens - 1 + j - row] = diag_down[j + row] = 1;
+        }
+        free(used);
+        return conflicts == 0;
+    }
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) reduction(+ : conflicts) num_threads(workers)
+#endif
+    for (uint64_t j = 0; j < n_queens; ++j)
+    {
+        const uint64_t row = positions[j];
+        if (row >= n_queens)
+        {
+            ++conflicts;
+            continue;
+        }
+        // a mark already set means another queen on the same line
+        conflicts += __atomic_exchange_n(&rows[row], 1, __ATOMIC_RELAXED);
+        conflicts += __atomic_exchange_n(&diag_up[n_queens - 1 + j - row], 1, __ATOMIC_RELAXED);
+        conflicts += __atomic_exchange_n(&diag_down[j + row], 1, __ATOMIC_RELAXED);
+    }
+    free(used);
+    return conflicts == 0;
+}
@@ -0,0 +1,21 @@
+#ifndef N_QUEENS_PLACEMENT_H
+#define N_QUEENS_PLACEMENT_H
+
+#include <stdint.h>
+
+/* Placements complètes pour de très grands N, rangées comme queen_positions :
+ * positions[colonne] = ligne de la reine de cette colonne (à partir de 0). */
+
+/* Construction explicite en O(N) selon N mod 6 : les lignes paires puis les
+ * impaires (en comptant à partir de 1), avec 1, 3 et 5 déplacées quand
+ * N mod 6 = 2, et 2, 1 et 3 envoyées à la fin quand N mod 6 = 3. Chaque case
+ * est calculée seule, le remplissage est partagé entre `threads` threads
+ * OpenMP (0 : valeur par défaut). 0 si N = 2 ou 3 (aucune solution). */
+int nq_construct_placement(uint64_t n_queens, uint32_t *positions, uint32_t threads);
+
+/* 1 si les N reines ne se prennent pas : une par ligne et par diagonale.
+ * Chaque thread marque ses reines dans des tableaux d'octets partagés
+ * (échange atomique), 5 N octets en tout. */
+int nq_verify_placement(uint64_t n_queens, const uint32_t *positions, uint32_t threads);
+
+#endif
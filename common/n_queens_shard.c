@@ -0,0 +1,157 @@
+#include "n_queens_shard.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SHARD_FORMAT "nq-shard 1"
+
+int nq_shard_parse(const char *text, uint32_t *shard, uint32_t *shards)
+{
+    unsigned int i, k;
+    char end;
+    if (text == NULL || sscanf(text, "%u/%u%c", &i, &k, &end) != 2 || k == 0 || i >= k)
+    {
+        return 0;
+    }
+    *shard = i;
+    *shards = k;
+    return 1;
+}
+
+int nq_shard_write(const char *path, const NQ_SHARD_MANIFEST *manifest)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        perror("Failed to open the shard manifest");
+        return 0;
+    }
+    fprintf(file, SHARD_FORMAT "\n");
+    fprintf(file, "n_queens %u\n", manifest->n_queens);
+    fprintf(file, "depth %u\n", manifest->depth);
+    fprintf(file, "prefixes %" PRIu64 "\n", manifest->prefixes);
+    fprintf(file, "frontier_hash %016" PRIx64 "\n", manifest->frontier_hash);
+    fprintf(file, "shard %u/%u\n", manifest->shard, manifest->shards);
+    fprintf(file, "range %" PRIu64 " %" PRIu64 "\n", manifest->begin, manifest->end);
+    fprintf(file, "solutions %" PRIu64 "\n", manifest->solutions);
+    fprintf(file, "placements %" PRIu64 "\n", manifest->placements);
+    fprintf(file, "seconds %f\n", manifest->seconds);
+    // a manifest cut short (full disk, killed job) fails the merge
+    if (fclose(file) != 0)
+    {
+        perror("Failed to write the shard manifest");
+        return 0;
+    }
+    return 1;
+}
+
+int nq_shard_read(const char *path, NQ_SHARD_MANIFEST *manifest)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return 0;
+    }
+    char format[32];
+    const int read = fgets(format, sizeof(format), file) != NULL && strcmp(format, SHARD_FORMAT "\n") == 0 &&
+                     fscanf(file, " n_queens %u", &manifest->n_queens) == 1 &&
+                     fscanf(file, " depth %u", &manifest->depth) == 1 &&
+                     fscanf(file, " prefixes %" SCNu64, &manifest->prefixes) == 1 &&
+                     fscanf(file, " frontier_hash %" SCNx64, &manifest->frontier_hash) == 1 &&
+                     fscanf(file, " shard %u/%u", &manifest->shard, &manifest->shards) == 2 &&
+                     fscanf(file, " range %" SCNu64 " %" SCNu64, &manifest->begin, &manifest->end) == 2 &&
+                     fscanf(file, " solutions %" SCNu64, &manifest->solutions) == 1 &&
+                     fscanf(file, " placements %" SCNu64, &manifest->placements) == 1 &&
+                     fscanf(file, " seconds %lf", &manifest->seconds) == 1;
+    fclose(file);
+    if (!read)
+    {
+        fprintf(stderr, "%s is not a complete shard manifest.\n", path);
+    }
+    return read;
+}
+
+int nq_shard_merge(const NQ_SHARD_MANIFEST *manifests, uint32_t count, NQ_SHARD_MANIFEST *total)
+{
+    if (count == 0)
+    {
+        fprintf(stderr, "No shard to merge.\n");
+        return 0;
+    }
+    const NQ_SHARD_MANIFEST *first = &manifests[0];
+    const uint32_t shards = first->shards;
+    const NQ_SHARD_MANIFEST **by_shard = calloc(shards, sizeof(NQ_SHARD_MANIFEST *));
+    if (by_shard == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the shard merge.\n");
+        exit(EXIT_FAILURE);
+    }
+    int valid = 1;
+    for (uint32_t i = 0; i < count && valid; ++i)
+    {
+        const NQ_SHARD_MANIFEST *m = &manifests[i];
+        if (m->n_queens != first->n_queens || m->depth != first->depth || m->prefixes != first->prefixes ||
+            m->frontier_hash != first->frontier_hash || m->shards != shards)
+        {
+            fprintf(stderr, "Shard %u/%u does not belong to the same count as shard %u/%u.\n", m->shard, m->shards,
+                    first->shard, first->shards);
+            valid = 0;
+        }
+        else if (m->shard >= shards || by_shard[m->shard] != NULL)
+        {
+            fprintf(stderr, "Shard %u/%u is given twice or out of range.\n", m->shard, m->shards);
+            valid = 0;
+        }
+        else
+        {
+            by_shard[m->shard] = m;
+        }
+    }
+
+    // every shard present, and their ranges cover the frontier end to end
+    memset(total, 0, sizeof(NQ_SHARD_MANIFEST));
+    uint64_t next = 0;
+    for (uint32_t s = 0; s < shards && valid; ++s)
+    {
+        const NQ_SHARD_MANIFEST *m = by_shard[s];
+        if (m == NULL)
+        {
+            fprintf(stderr, "Shard %u/%u is missing.\n", s, shards);
+            valid = 0;
+        }
+        else if (m->begin != next || m->end < m->begin)
+        {
+            fprintf(stderr, "Shard %u/%u covers [%" PRIu64 ", %" PRIu64 "), expected to start at %" PRIu64 ".\n",
+                    s, shards, m->begin, m->end, next);
+            valid = 0;
+        }
+        else
+        {
+            next = m->end;
+            total->solutions += m->solutions;
+            total->placements += m->placements;
+            total->seconds += m->seconds;
+        }
+    }
+    if (valid && next != first->prefixes)
+    {
+        fprintf(stderr, "The shards cover %" PRIu64 " of the %" PRIu64 " prefixes.\n", next, first->prefixes);
+        valid = 0;
+    }
+    free(by_shard);
+    if (valid)
+    {
+        total->n_queens = first->n_queens;
+        total->depth = first->depth;
+        total->prefixes = first->prefixes;
+        total->frontier_hash = first->frontier_hash;
+        total->shard = 0;
+        total->shards = shards;
+        total->begin = 0;
+        total->end = first->prefixes;
+    }
+    return valid;
+}
@@ -0,0 +1,38 @@
+#ifndef N_QUEENS_SHARD_H
+#define N_QUEENS_SHARD_H
+
+#include <stdint.h>
+
+/* Comptage découpé en tranches indépendantes (tableaux de jobs d'un
+ * ordonnanceur, sans MPI) : chaque job compte une tranche du frontier avec le
+ * solveur (NQ_CONFIG.shard/shards) et écrit un manifeste texte ; la fusion
+ * vérifie que toutes les tranches du même comptage sont là, se suivent sans
+ * trou ni recouvrement, puis additionne leurs comptes. */
+
+typedef struct nq_shard_manifest
+{
+    uint32_t n_queens;
+    uint32_t depth;
+    uint64_t prefixes;      // préfixes du frontier entier
+    uint64_t frontier_hash; // empreinte de la liste des préfixes
+    uint32_t shard;
+    uint32_t shards;
+    uint64_t begin;         // tranche [begin, end) du frontier
+    uint64_t end;
+    uint64_t solutions;
+    uint64_t placements;
+    double seconds;
+} NQ_SHARD_MANIFEST;
+
+/* Lire "i/k" ; 0 si la chaîne n'est pas une tranche valide (i < k) */
+int nq_shard_parse(const char *text, uint32_t *shard, uint32_t *shards);
+
+/* Écrire / relire un manifeste ; 0 en cas d'erreur */
+int nq_shard_write(const char *path, const NQ_SHARD_MANIFEST *manifest);
+int nq_shard_read(const char *path, NQ_SHARD_MANIFEST *manifest);
+
+/* Vérifier les `count` manifestes (dans n'importe quel ordre) et les sommer
+ * dans `total` ; 0 et un message sur stderr s'ils ne forment pas un comptage complet */
+int nq_shard_merge(const NQ_SHARD_MANIFEST *manifests, uint32_t count, NQ_SHARD_MANIFEST *total);
+
+#endif
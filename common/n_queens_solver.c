@@ -0,0 +1,693 @@
+#include "n_queens_solver.h"
+#include "n_queens_core.h"
+#include "n_queens_estimator.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Minimum number of prefixes per thread when the depth is chosen automatically
+#define TASKS_PER_THREAD 8
+// Minimum number of prefixes per shard: the automatic depth of a sharded count
+// must not depend on the threads of the node that runs it
+#define TASKS_PER_SHARD 64
+
+// What a share of the prefixes adds to a solve
+typedef struct nq_tally
+{
+    uint64_t solutions;
+    uint64_t placements;
+    // prefixes answered by the result store
+    uint64_t reused;
+    // prefixes left for a later run after a stop request
+    uint64_t skipped;
+    NQ_MEMO_STATS memo;
+} NQ_TALLY;
+
+// One solve in progress: the workers report into it, the caller waits on it
+typedef struct nq_job
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t done;
+    uint64_t remaining;
+    const NQ_CONFIG *config;
+    NQ_TALLY tally;
+} NQ_JOB;
+
+// A prefix of the board, as bitmasks of the occupied rows and diagonals, and
+// as its rows (5 bits each) for the result store
+typedef struct nq_task
+{
+    NQ_JOB *job;
+    uint64_t full;
+    uint64_t cols;
+    uint64_t diag_up;
+    uint64_t diag_down;
+    uint64_t prefix;
+    uint32_t depth;
+    // position in the frontier, the same in every run of the same N and depth
+    uint64_t id;
+} NQ_TASK;
+
+typedef struct nq_frontier
+{
+    NQ_TASK *tasks;
+    uint64_t count;
+    uint64_t capacity;
+    // prefixes that are already complete solutions, and placements spent generating
+    uint64_t solutions;
+    uint64_t placements;
+    uint32_t depth;
+} NQ_FRONTIER;
+
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+static uint32_t online_cpus(void)
+{
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (uint32_t)cpus : 1;
+}
+
+NQ_BACKEND nq_backend_from_string(const char *name)
+{
+    if (name == NULL || strcmp(name, "sequential") == 0)
+    {
+        return NQ_BACKEND_SEQUENTIAL;
+    }
+    if (strcmp(name, "pthread") == 0)
+    {
+        return NQ_BACKEND_PTHREAD;
+    }
+    if (strcmp(name, "openmp") == 0)
+    {
+        return NQ_BACKEND_OPENMP;
+    }
+    if (strcmp(name, "mpi") == 0)
+    {
+        return NQ_BACKEND_MPI;
+    }
+    fprintf(stderr, "Unknown backend '%s'.\n", name);
+    return NQ_BACKEND_UNKNOWN;
+}
+
+void nq_config_default(NQ_CONFIG *config, uint32_t n_queens)
+{
+    config->n_queens = n_queens;
+    config->backend = NQ_BACKEND_SEQUENTIAL;
+    config->threads = 0;
+    config->depth = 0;
+    config->memo = NULL;
+    config->store = NULL;
+    config->checkpoint = NULL;
+    config->frontier = NULL;
+    config->shard = 0;
+    config->shards = 1;
+#ifdef NQ_WITH_MPI
+    config->comm = MPI_COMM_WORLD;
+#endif
+}
+
+static void push_task(NQ_FRONTIER *frontier, const NQ_TASK *task)
+{
+    if (frontier->count == frontier->capacity)
+    {
+        frontier->capacity = frontier->capacity ? 2 * frontier->capacity : 256;
+        frontier->tasks = realloc(frontier->tasks, sizeof(NQ_TASK) * frontier->capacity);
+        if (frontier->tasks == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed for the solver frontier.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    frontier->tasks[frontier->count] = *task;
+    frontier->tasks[frontier->count].id = frontier->count;
+    ++frontier->count;
+}
+
+// All prefixes of `depth` columns, with the half-board symmetry on the first two columns
+static void generate(uint32_t n_queens, NQ_TASK *task, uint32_t column, uint32_t first_row, uint32_t depth,
+                     NQ_FRONTIER *frontier)
+{
+    if (task->cols == task->full)
+    {
+        ++frontier->solutions;
+        return;
+    }
+    if (column == depth)
+    {
+        push_task(frontier, task);
+        return;
+    }
+    uint64_t free_rows = task->full & ~(task->cols | task->diag_up | task->diag_down);
+    if (column == 0)
+    {
+        free_rows &= (1ULL << ((n_queens + 1) >> 1)) - 1;
+    }
+    else if (column == 1 && (n_queens & 1) && first_row == n_queens >> 1)
+    {
+        free_rows &= (1ULL << (n_queens >> 1)) - 1;
+    }
+    while (free_rows)
+    {
+        const uint64_t bit = free_rows & -free_rows;
+        free_rows ^= bit;
+        ++frontier->placements;
+        NQ_TASK child = *task;
+        child.cols |= bit;
+        child.diag_up = (task->diag_up | bit) << 1;
+        child.diag_down = (task->diag_down | bit) >> 1;
+        if (column < NQ_STORE_MAX_DEPTH)
+        {
+            child.prefix |= (uint64_t)__builtin_ctzll(bit) << (5 * column);
+        }
+        child.depth = column + 1;
+        generate(n_queens, &child, column + 1, column == 0 ? (uint32_t)__builtin_ctzll(bit) : first_row, depth,
+                 frontier);
+    }
+}
+
+// The prefixes of a frontier file, in its order
+static int load_frontier(const NQ_CONFIG *config, NQ_FRONTIER *frontier)
+{
+    const NQ_FRONTIER_HEADER *header = config->frontier->header;
+    if (header->n_queens != config->n_queens || header->symmetry != NQ_SYMMETRY_HALF ||
+        (config->depth != 0 && config->depth != header->depth))
+    {
+        fprintf(stderr, "The frontier file is for N = %u at depth %u.\n", header->n_queens, header->depth);
+        return -1;
+    }
+    const uint64_t full = (1ULL << config->n_queens) - 1;
+    memset(frontier, 0, sizeof(NQ_FRONTIER));
+    frontier->depth = header->depth;
+    frontier->placements = header->placements;
+    for (uint64_t i = 0; i < header->count; ++i)
+    {
+        NQ_PREFIX prefix;
+        nq_frontier_get(config->frontier, i, &prefix);
+        if (prefix.cols == full)
+        {
+            ++frontier->solutions;
+            continue;
+        }
+        const NQ_TASK task = {NULL, full, prefix.cols, prefix.diag_up, prefix.diag_down,
+                              nq_frontier_rows(config->frontier, i), header->depth, 0};
+        push_task(frontier, &task);
+    }
+    return 0;
+}
+
+// The prefixes of `depth` columns, built breadth first on `threads` threads
+static void build_parallel(uint32_t n_queens, uint32_t depth, uint32_t threads, NQ_FRONTIER *frontier)
+{
+    NQ_FRONTIER_ARRAY array;
+    nq_frontier_build(&array, n_queens, depth, threads);
+    const uint64_t full = (1ULL << n_queens) - 1;
+    frontier->placements = array.placements;
+    for (uint64_t i = 0; i < array.count; ++i)
+    {
+        const NQ_FRONTIER_ENTRY *entry = &array.entries[i];
+        if (entry->cols == full)
+        {
+            ++frontier->solutions;
+            continue;
+        }
+        const NQ_TASK task = {NULL, full, entry->cols, entry->diag_up, entry->diag_down, entry->rows, depth, 0};
+        push_task(frontier, &task);
+    }
+    nq_frontier_array_free(&array);
+}
+
+static int build_frontier(const NQ_CONFIG *config, uint64_t min_tasks, uint32_t threads, NQ_FRONTIER *frontier)
+{
+    if (config->frontier != NULL)
+    {
+        return load_frontier(config, frontier);
+    }
+    const uint32_t n = config->n_queens;
+    // a resumed count keeps the depth of its journal, so that the prefixes keep their numbers
+    uint32_t fixed = config->depth;
+    if (fixed == 0 && config->checkpoint != NULL && config->checkpoint->loaded_header.n_queens != 0)
+    {
+        fixed = config->checkpoint->loaded_header.depth;
+    }
+    // at least two columns, so that the symmetry never reaches the workers
+    uint32_t depth = fixed ? fixed : 2;
+    while (1)
+    {
+        memset(frontier, 0, sizeof(NQ_FRONTIER));
+        frontier->depth = depth < n ? depth : n;
+        if (frontier->depth <= NQ_FRONTIER_FILE_MAX_DEPTH)
+        {
+            build_parallel(n, frontier->depth, threads, frontier);
+        }
+        else
+        {
+            // too deep for the packed rows of the parallel build
+            NQ_TASK root = {NULL, (1ULL << n) - 1, 0, 0, 0, 0, 0, 0};
+            generate(n, &root, 0, 0, frontier->depth, frontier);
+        }
+        if (fixed || depth >= n || frontier->count >= min_tasks)
+        {
+            return 0;
+        }
+        free(frontier->tasks);
+        ++depth;
+    }
+}
+
+// Fingerprint of the frontier (its prefixes in order), compared by the shard merge
+static uint64_t frontier_hash(const NQ_FRONTIER *frontier)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL ^ frontier->depth;
+    for (uint64_t i = 0; i < frontier->count; ++i)
+    {
+        hash = (hash ^ frontier->tasks[i].prefix) * 0x100000001B3ULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+// Keep the slice of the prefixes that belongs to the shard: the frontier is cut
+// into contiguous ranges of close estimated subtree sizes, the same on every node
+static int keep_shard(const NQ_CONFIG *config, NQ_FRONTIER *frontier, uint64_t *begin, uint64_t *end)
+{
+    const uint32_t depth = frontier->depth;
+    if (depth > NQ_STORE_MAX_DEPTH)
+    {
+        fprintf(stderr, "A sharded count needs a prefix depth of at most %d.\n", NQ_STORE_MAX_DEPTH);
+        return -1;
+    }
+    uint32_t *rows = malloc(sizeof(uint32_t) * (frontier->count * depth + 1));
+    double *weights = malloc(sizeof(double) * (frontier->count + 1));
+    uint64_t *bounds = malloc(sizeof(uint64_t) * (config->shards + 1));
+    if (rows == NULL || weights == NULL || bounds == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the shard split.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (config->frontier != NULL && (config->frontier->header->flags & NQ_FRONTIER_WEIGHTS))
+    {
+        // the weights estimated when the file was written
+        for (uint64_t i = 0; i < frontier->count; ++i)
+        {
+            weights[i] = nq_frontier_weight(config->frontier, frontier->tasks[i].id);
+        }
+    }
+    else
+    {
+        for (uint64_t i = 0; i < frontier->count; ++i)
+        {
+            for (uint32_t j = 0; j < depth; ++j)
+            {
+                rows[i * depth + j] = (uint32_t)(frontier->tasks[i].prefix >> (5 * j)) & 31;
+            }
+        }
+        estimator_frontier(config->n_queens, rows, depth, frontier->count, depth, ESTIMATOR_DEFAULT_SAMPLES,
+                           weights);
+    }
+    estimator_weighted_split(weights, frontier->count, config->shards, bounds);
+    *begin = bounds[config->shard];
+    *end = bounds[config->shard + 1];
+    free(rows);
+    free(weights);
+    free(bounds);
+
+    memmove(frontier->tasks, &frontier->tasks[*begin], sizeof(NQ_TASK) * (*end - *begin));
+    frontier->count = *end - *begin;
+    // the complete solutions met while generating belong to the first shard only
+    if (config->shard != 0)
+    {
+        frontier->solutions = 0;
+        frontier->placements = 0;
+    }
+    return 0;
+}
+
+static void tally_add(NQ_TALLY *into, const NQ_TALLY *from)
+{
+    into->solutions += from->solutions;
+    into->placements += from->placements;
+    into->reused += from->reused;
+    into->skipped += from->skipped;
+    nq_memo_stats_add(&into->memo, &from->memo);
+}
+
+// Count the solutions under one prefix: from the result store if an earlier
+// run recorded them, else through the transposition table if there is one.
+// With a checkpoint, the prefixes of the journal were added at the start and
+// are skipped, and after a stop request no new prefix is started.
+static void count_task(const NQ_TASK *task, const NQ_CONFIG *config, NQ_TALLY *tally)
+{
+    if (config->checkpoint != NULL)
+    {
+        if (nq_checkpoint_done(config->checkpoint, task->id))
+        {
+            return;
+        }
+        if (nq_checkpoint_stop_requested())
+        {
+            ++tally->skipped;
+            return;
+        }
+    }
+    const NQ_STORE_KEY key = {config->n_queens, NQ_SYMMETRY_HALF, task->depth, task->prefix};
+    const int stored = config->store != NULL && task->depth <= NQ_STORE_MAX_DEPTH;
+    uint64_t solutions, placements = 0;
+    if (stored && nq_store_get(config->store, &key, &solutions, &placements))
+    {
+        ++tally->reused;
+    }
+    else
+    {
+        if (config->memo != NULL)
+        {
+            solutions = nq_memo_subtree(config->memo, task->cols, task->diag_up, task->diag_down, &placements,
+                                        &tally->memo);
+        }
+        else
+        {
+            solutions = nq_bitboard_subtree(task->full, task->cols, task->diag_up, task->diag_down, &placements);
+        }
+        if (stored)
+        {
+            nq_store_put(config->store, &key, solutions, placements);
+        }
+    }
+    tally->solutions += solutions;
+    tally->placements += placements;
+    if (config->checkpoint != NULL)
+    {
+        nq_checkpoint_record(config->checkpoint, task->id, solutions, placements);
+    }
+}
+
+static void *nq_worker(void *args)
+{
+    TASK_POOL *pool = args;
+    NQ_TASK *task;
+    while ((task = pool_take(pool)) != NULL)
+    {
+        NQ_TALLY tally;
+        memset(&tally, 0, sizeof(NQ_TALLY));
+        NQ_JOB *job = task->job;
+        count_task(task, job->config, &tally);
+        pthread_mutex_lock(&job->mutex);
+        tally_add(&job->tally, &tally);
+        if (--job->remaining == 0)
+        {
+            pthread_cond_signal(&job->done);
+        }
+        pthread_mutex_unlock(&job->mutex);
+        pool_task_done(pool);
+    }
+    return NULL;
+}
+
+NQ_WORKERS *nq_workers_create(uint32_t count)
+{
+    NQ_WORKERS *workers = malloc(sizeof(NQ_WORKERS));
+    if (workers == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the solver workers.\n");
+        exit(EXIT_FAILURE);
+    }
+    workers->count = count ? count : online_cpus();
+    workers->threads = malloc(sizeof(pthread_t) * workers->count);
+    if (workers->threads == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the solver workers.\n");
+        exit(EXIT_FAILURE);
+    }
+    pool_init(&workers->pool, POOL_FIFO);
+    for (uint32_t i = 0; i < workers->count; ++i)
+    {
+        if (pthread_create(&workers->threads[i], NULL, &nq_worker, &workers->pool) != 0)
+        {
+            perror("Failed to create the thread");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return workers;
+}
+
+void nq_workers_destroy(NQ_WORKERS *workers)
+{
+    // the workers leave once every solve submitted so far is finished
+    pool_close(&workers->pool);
+    for (uint32_t i = 0; i < workers->count; ++i)
+    {
+        if (pthread_join(workers->threads[i], NULL) != 0)
+        {
+            perror("Failed to join the thread");
+        }
+    }
+    pool_destroy(&workers->pool);
+    free(workers->threads);
+    free(workers);
+}
+
+// Count tasks[begin], tasks[begin + stride], ... on the shared workers
+static void solve_on_workers(NQ_WORKERS *workers, NQ_FRONTIER *frontier, uint64_t begin, uint64_t stride,
+                             const NQ_CONFIG *config, NQ_TALLY *tally)
+{
+    NQ_JOB job;
+    pthread_mutex_init(&job.mutex, NULL);
+    pthread_cond_init(&job.done, NULL);
+    job.remaining = 0;
+    job.config = config;
+    memset(&job.tally, 0, sizeof(NQ_TALLY));
+    for (uint64_t i = begin; i < frontier->count; i += stride)
+    {
+        ++job.remaining;
+    }
+
+    pthread_mutex_lock(&job.mutex);
+    for (uint64_t i = begin; i < frontier->count; i += stride)
+    {
+        frontier->tasks[i].job = &job;
+        pool_submit(&workers->pool, &frontier->tasks[i], 0);
+    }
+    while (job.remaining > 0)
+    {
+        pthread_cond_wait(&job.done, &job.mutex);
+    }
+    pthread_mutex_unlock(&job.mutex);
+
+    tally_add(tally, &job.tally);
+    pthread_cond_destroy(&job.done);
+    pthread_mutex_destroy(&job.mutex);
+}
+
+static void solve_sequential(NQ_FRONTIER *frontier, uint64_t begin, uint64_t stride, const NQ_CONFIG *config,
+                             NQ_TALLY *tally)
+{
+    for (uint64_t i = begin; i < frontier->count; i += stride)
+    {
+        count_task(&frontier->tasks[i], config, tally);
+    }
+}
+
+int nq_solve(const NQ_CONFIG *config, NQ_WORKERS *workers, NQ_RESULT *result)
+{
+    if (config->n_queens < 1 || config->n_queens > NQ_MAX_N)
+    {
+        fprintf(stderr, "The number of queens must be between 1 and %d.\n", NQ_MAX_N);
+        return -1;
+    }
+    if (config->memo != NULL && config->memo->n_queens != config->n_queens)
+    {
+        fprintf(stderr, "The transposition table was created for N = %u.\n", config->memo->n_queens);
+        return -1;
+    }
+    if (config->backend == NQ_BACKEND_UNKNOWN)
+    {
+        fprintf(stderr, "The backend must be sequential, pthread, openmp or mpi.\n");
+        return -1;
+    }
+    if (config->shards == 0 || config->shard >= config->shards)
+    {
+        fprintf(stderr, "Shard %u of %u does not exist.\n", config->shard, config->shards);
+        return -1;
+    }
+#ifndef _OPENMP
+    if (config->backend == NQ_BACKEND_OPENMP)
+    {
+        fprintf(stderr, "The openmp backend needs a build with -fopenmp.\n");
+        return -1;
+    }
+#endif
+#ifndef NQ_WITH_MPI
+    if (config->backend == NQ_BACKEND_MPI)
+    {
+        fprintf(stderr, "The mpi backend needs a build with -DNQ_WITH_MPI.\n");
+        return -1;
+    }
+#endif
+
+    const double start_time = now();
+    // a total recorded by an earlier run; the MPI ranks do not share a store,
+    // so they all count to meet in the reduction, and a shard only has a part of it
+    const NQ_STORE_KEY total_key = {config->n_queens, NQ_SYMMETRY_HALF, 0, 0};
+    const int whole = config->shards == 1;
+    if (whole && config->store != NULL && config->backend != NQ_BACKEND_MPI &&
+        nq_store_get(config->store, &total_key, &result->solutions, &result->placements))
+    {
+        result->tasks = 0;
+        result->reused = 1;
+        memset(&result->memo, 0, sizeof(NQ_MEMO_STATS));
+        result->seconds = now() - start_time;
+        return 0;
+    }
+    const uint32_t threads = workers ? workers->count : (config->threads ? config->threads : online_cpus());
+    NQ_FRONTIER frontier;
+    if (build_frontier(config,
+                       whole ? (uint64_t)TASKS_PER_THREAD * (config->backend == NQ_BACKEND_SEQUENTIAL ? 1 : threads)
+                             : (uint64_t)TASKS_PER_SHARD * config->shards,
+                       config->backend == NQ_BACKEND_SEQUENTIAL ? 1 : threads, &frontier) != 0)
+    {
+        return -1;
+    }
+    result->depth = frontier.depth;
+    result->frontier = frontier.count;
+    result->frontier_hash = frontier_hash(&frontier);
+    result->shard_begin = 0;
+    result->shard_end = frontier.count;
+
+    // the prefixes counted before the restart; with MPI, only rank 0 adds them
+    NQ_TALLY resumed;
+    memset(&resumed, 0, sizeof(NQ_TALLY));
+    if (config->checkpoint != NULL)
+    {
+        if (nq_checkpoint_begin(config->checkpoint, config->n_queens, frontier.depth, frontier.count) != 0)
+        {
+            free(frontier.tasks);
+            return -1;
+        }
+        resumed.solutions = config->checkpoint->resumed_solutions;
+        resumed.placements = config->checkpoint->resumed_placements;
+        resumed.reused = config->checkpoint->resumed_prefixes;
+    }
+    if (!whole && keep_shard(config, &frontier, &result->shard_begin, &result->shard_end) != 0)
+    {
+        free(frontier.tasks);
+        return -1;
+    }
+
+    NQ_TALLY tally;
+    memset(&tally, 0, sizeof(NQ_TALLY));
+    tally.solutions = frontier.solutions;
+    tally.placements = frontier.placements;
+    if (config->backend != NQ_BACKEND_MPI)
+    {
+        tally_add(&tally, &resumed);
+    }
+
+    if (config->backend == NQ_BACKEND_SEQUENTIAL)
+    {
+        solve_sequential(&frontier, 0, 1, config, &tally);
+    }
+    else if (config->backend == NQ_BACKEND_PTHREAD)
+    {
+        NQ_WORKERS *own = workers ? NULL : nq_workers_create(threads);
+        solve_on_workers(workers ? workers : own, &frontier, 0, 1, config, &tally);
+        if (own != NULL)
+        {
+            nq_workers_destroy(own);
+        }
+    }
+#ifdef _OPENMP
+    else if (config->backend == NQ_BACKEND_OPENMP)
+    {
+        #pragma omp parallel num_threads(threads)
+        {
+            NQ_TALLY local;
+            memset(&local, 0, sizeof(NQ_TALLY));
+            #pragma omp for schedule(dynamic, 1)
+            for (uint64_t i = 0; i < frontier.count; ++i)
+            {
+                count_task(&frontier.tasks[i], config, &local);
+            }
+            #pragma omp critical
+            tally_add(&tally, &local);
+        }
+    }
+#endif
+#ifdef NQ_WITH_MPI
+    else if (config->backend == NQ_BACKEND_MPI)
+    {
+        // a private communicator keeps concurrent solves from matching each other's messages
+        MPI_Comm comm;
+        int rank, size;
+        MPI_Comm_dup(config->comm, &comm);
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &size);
+
+        // every rank read the journals in nq_checkpoint_open; none may append to
+        // its own before all have, or a prefix would count both as resumed and anew
+        if (config->checkpoint != NULL)
+        {
+            MPI_Barrier(comm);
+        }
+
+        // every rank builds the same frontier and counts a cyclic share of it
+        NQ_TALLY local;
+        memset(&local, 0, sizeof(NQ_TALLY));
+        if (rank == 0)
+        {
+            tally_add(&local, &resumed);
+        }
+        if (workers != NULL)
+        {
+            solve_on_workers(workers, &frontier, (uint64_t)rank, (uint64_t)size, config, &local);
+        }
+        else
+        {
+            solve_sequential(&frontier, (uint64_t)rank, (uint64_t)size, config, &local);
+        }
+        uint64_t counts[4] = {local.solutions, local.placements, local.reused, local.skipped};
+        uint64_t global[4];
+        MPI_Allreduce(counts, global, 4, MPI_UINT64_T, MPI_SUM, comm);
+        MPI_Comm_free(&comm);
+        tally.solutions += global[0];
+        tally.placements += global[1];
+        tally.reused += global[2];
+        tally.skipped += global[3];
+        // the table counters stay those of this process
+        nq_memo_stats_add(&tally.memo, &local.memo);
+    }
+#endif
+    free(frontier.tasks);
+
+    // every solution but the middle one of N = 1 has a mirror image that was not searched
+    result->solutions = config->n_queens == 1 ? tally.solutions : 2 * tally.solutions;
+    result->placements = tally.placements;
+    result->tasks = frontier.count;
+    result->reused = tally.reused;
+    result->memo = tally.memo;
+    result->seconds = now() - start_time;
+    if (tally.skipped > 0)
+    {
+        // stopped: the counts are partial, the journal holds the finished prefixes
+        if (config->checkpoint != NULL)
+        {
+            nq_checkpoint_flush(config->checkpoint);
+        }
+        return 1;
+    }
+    if (whole && config->store != NULL)
+    {
+        nq_store_put(config->store, &total_key, result->solutions, result->placements);
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+#ifndef N_QUEENS_SOLVER_H
+#define N_QUEENS_SOLVER_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "n_queens_checkpoint.h"
+#include "n_queens_frontier.h"
+#include "n_queens_memo.h"
+#include "n_queens_store.h"
+#include "n_queens_task_pool.h"
+
+#ifdef NQ_WITH_MPI
+#include <mpi.h>
+#endif
+
+/* Solveur réentrant : tout l'état d'un comptage appartient à l'appel de
+ * nq_solve (et au pool de threads qu'on lui passe), aucune variable globale.
+ * Plusieurs comptages peuvent tourner en même temps dans un même processus. */
+
+#define NQ_MAX_N 32
+
+typedef enum nq_backend
+{
+    NQ_BACKEND_SEQUENTIAL,
+    NQ_BACKEND_PTHREAD,
+    NQ_BACKEND_OPENMP,
+    NQ_BACKEND_MPI,
+    NQ_BACKEND_UNKNOWN // nom non reconnu par nq_backend_from_string
+} NQ_BACKEND;
+
+typedef struct nq_config
+{
+    uint32_t n_queens;
+    NQ_BACKEND backend;
+    // threads de la région OpenMP, ou du pool temporaire si aucun n'est donné (0 : un par CPU)
+    uint32_t threads;
+    // profondeur des préfixes distribués (0 : choisie pour avoir assez de tâches par thread)
+    uint32_t depth;
+    // table de transposition partagée (NULL : aucune), créée pour le même N
+    NQ_MEMO *memo;
+    // magasin de résultats (NULL : aucun) : le total et les comptages par
+    // préfixe déjà enregistrés ne sont pas recalculés, les nouveaux y sont ajoutés
+    NQ_STORE *store;
+    // journal de reprise (NULL : aucun) : chaque préfixe terminé y est ajouté,
+    // ceux d'un lancement précédent sont sautés ; la profondeur est celle du journal
+    NQ_CHECKPOINT *checkpoint;
+    // frontier lu dans un fichier projeté en mémoire (NULL : calculé), du même N ;
+    // sa profondeur remplace `depth`, ses poids servent au découpage en tranches
+    const NQ_FRONTIER_FILE *frontier;
+    // tranche `shard` sur `shards` (1 : tout) : le frontier est découpé en
+    // intervalles contigus de tailles estimées proches, identiques sur chaque nœud
+    uint32_t shard;
+    uint32_t shards;
+#ifdef NQ_WITH_MPI
+    // communicateur du backend MPI, dupliqué le temps du comptage
+    MPI_Comm comm;
+#endif
+} NQ_CONFIG;
+
+typedef struct nq_result
+{
+    uint64_t solutions;
+    uint64_t placements;
+    uint64_t tasks;
+    double seconds;
+    // préfixes (ou total) lus dans le magasin de résultats ou le journal de reprise
+    uint64_t reused;
+    // consultations de la table de transposition (sur ce processus)
+    NQ_MEMO_STATS memo;
+    // frontier entier (profondeur, préfixes, empreinte) et tranche comptée [shard_begin, shard_end)
+    uint32_t depth;
+    uint64_t frontier;
+    uint64_t frontier_hash;
+    uint64_t shard_begin;
+    uint64_t shard_end;
+} NQ_RESULT;
+
+/* Pool de threads partagé par les comptages pthread (et MPI) concurrents :
+ * leurs tâches passent par la même file */
+typedef struct nq_workers
+{
+    TASK_POOL pool;
+    uint32_t count;
+    pthread_t *threads;
+} NQ_WORKERS;
+
+/* Convertir "sequential", "pthread", "openmp" ou "mpi" en backend (NULL :
+ * sequential) ; NQ_BACKEND_UNKNOWN pour tout autre nom */
+NQ_BACKEND nq_backend_from_string(const char *name);
+
+/* Remplir une configuration par défaut pour n_queens */
+void nq_config_default(NQ_CONFIG *config, uint32_t n_queens);
+
+/* Démarrer `count` threads (0 : un par CPU) / les arrêter une fois les comptages finis */
+NQ_WORKERS *nq_workers_create(uint32_t count);
+void nq_workers_destroy(NQ_WORKERS *workers);
+
+/* Compter les solutions selon `config` ; `workers` peut être NULL (un pool
+ * temporaire est créé pour le backend pthread). Renvoie 0, -1 si la
+ * configuration est invalide ou le backend absent de cette compilation, ou 1
+ * si le comptage a été arrêté (signal) : le résultat est alors partiel. */
+int nq_solve(const NQ_CONFIG *config, NQ_WORKERS *workers, NQ_RESULT *result);
+
+#endif
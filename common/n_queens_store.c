@@ -0,0 +1,259 @@
+#include "n_queens_store.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define STORE_MAGIC "NQSTORE1"
+#define STORE_INITIAL_CAPACITY 1024
+
+static uint64_t mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static uint64_t file_size(uint64_t capacity)
+{
+    return sizeof(NQ_STORE_HEADER) + capacity * sizeof(NQ_STORE_RECORD);
+}
+
+static int same_key(const NQ_STORE_RECORD *record, const NQ_STORE_KEY *key)
+{
+    return record->prefix == key->prefix && record->n_queens == key->n_queens &&
+           record->depth == key->depth && record->symmetry == (uint8_t)key->symmetry;
+}
+
+// Slot of the key, or of the empty slot where it would go
+static NQ_STORE_RECORD *find_slot(NQ_STORE_RECORD *records, uint64_t capacity, const NQ_STORE_KEY *key)
+{
+    const uint64_t mask = capacity - 1;
+    uint64_t slot = mix(key->prefix ^ ((uint64_t)key->n_queens << 40) ^ ((uint64_t)key->depth << 48) ^
+                        ((uint64_t)key->symmetry << 56)) & mask;
+    while (records[slot].used && !same_key(&records[slot], key))
+    {
+        slot = (slot + 1) & mask;
+    }
+    return &records[slot];
+}
+
+static int map_file(NQ_STORE *store, uint64_t size)
+{
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, store->fd, 0);
+    if (map == MAP_FAILED)
+    {
+        perror("Failed to map the result store");
+        return 0;
+    }
+    store->header = map;
+    store->records = (NQ_STORE_RECORD *)(store->header + 1);
+    store->mapped = size;
+    return 1;
+}
+
+NQ_STORE *nq_store_open(const char *path)
+{
+    NQ_STORE *store = malloc(sizeof(NQ_STORE));
+    if (store == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the result store.\n");
+        exit(EXIT_FAILURE);
+    }
+    store->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (store->fd < 0)
+    {
+        perror("Failed to open the result store");
+        free(store);
+        return NULL;
+    }
+    if (flock(store->fd, LOCK_EX | LOCK_NB) != 0)
+    {
+        fprintf(stderr, "The result store %s is used by another process.\n", path);
+        close(store->fd);
+        free(store);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(store->fd, &st) != 0)
+    {
+        perror("Failed to read the size of the result store");
+        close(store->fd);
+        free(store);
+        return NULL;
+    }
+    const int created = st.st_size == 0;
+    if (created && ftruncate(store->fd, (off_t)file_size(STORE_INITIAL_CAPACITY)) != 0)
+    {
+        perror("Failed to size the result store");
+        close(store->fd);
+        free(store);
+        return NULL;
+    }
+    const uint64_t size = created ? file_size(STORE_INITIAL_CAPACITY) : (uint64_t)st.st_size;
+    if (size < sizeof(NQ_STORE_HEADER) || !map_file(store, size))
+    {
+        close(store->fd);
+        free(store);
+        return NULL;
+    }
+    // a crash between sizing a new file and writing its header leaves it all zeros
+    static const char blank[sizeof(store->header->magic)] = {0};
+    if (created || (size == file_size(STORE_INITIAL_CAPACITY) && store->header->capacity == 0 &&
+                    memcmp(store->header->magic, blank, sizeof(blank)) == 0))
+    {
+        memcpy(store->header->magic, STORE_MAGIC, sizeof(store->header->magic));
+        store->header->capacity = STORE_INITIAL_CAPACITY;
+        store->header->count = 0;
+    }
+    else if (memcmp(store->header->magic, STORE_MAGIC, sizeof(store->header->magic)) != 0 ||
+             file_size(store->header->capacity) != size)
+    {
+        fprintf(stderr, "%s is not a result store.\n", path);
+        munmap(store->header, size);
+        close(store->fd);
+        free(store);
+        return NULL;
+    }
+    store->path = strdup(path);
+    if (store->path == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the result store.\n");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutex_init(&store->mutex, NULL);
+    return store;
+}
+
+void nq_store_close(NQ_STORE *store)
+{
+    msync(store->header, store->mapped, MS_SYNC);
+    munmap(store->header, store->mapped);
+    flock(store->fd, LOCK_UN);
+    close(store->fd);
+    pthread_mutex_destroy(&store->mutex);
+    free(store->path);
+    free(store);
+}
+
+void nq_store_sync(NQ_STORE *store)
+{
+    pthread_mutex_lock(&store->mutex);
+    msync(store->header, store->mapped, MS_SYNC);
+    pthread_mutex_unlock(&store->mutex);
+}
+
+uint64_t nq_store_count(NQ_STORE *store)
+{
+    pthread_mutex_lock(&store->mutex);
+    const uint64_t count = store->header->count;
+    pthread_mutex_unlock(&store->mutex);
+    return count;
+}
+
+int nq_store_get(NQ_STORE *store, const NQ_STORE_KEY *key, uint64_t *solutions, uint64_t *placements)
+{
+    pthread_mutex_lock(&store->mutex);
+    const NQ_STORE_RECORD *record = find_slot(store->records, store->header->capacity, key);
+    const int found = record->used;
+    if (found)
+    {
+        *solutions = record->solutions;
+        if (placements != NULL)
+        {
+            *placements = record->placements;
+        }
+    }
+    pthread_mutex_unlock(&store->mutex);
+    return found;
+}
+
+// Double the table in `path`.tmp and rename it over the store once it is
+// complete and synced: a crash at any point leaves either the old store or the
+// new one, never a half-built table
+static void grow(NQ_STORE *store)
+{
+    const uint64_t old_capacity = store->header->capacity;
+    const uint64_t capacity = 2 * old_capacity;
+    const uint64_t size = file_size(capacity);
+    const size_t length = strlen(store->path) + sizeof(".tmp");
+    char *temporary = malloc(length);
+    if (temporary == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the result store.\n");
+        exit(EXIT_FAILURE);
+    }
+    snprintf(temporary, length, "%s.tmp", store->path);
+
+    // the new file is locked before it takes the store's name
+    const int fd = open(temporary, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || flock(fd, LOCK_EX | LOCK_NB) != 0 || ftruncate(fd, (off_t)size) != 0)
+    {
+        perror("Failed to create the grown result store");
+        exit(EXIT_FAILURE);
+    }
+    NQ_STORE_HEADER *header = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (header == MAP_FAILED)
+    {
+        perror("Failed to map the grown result store");
+        exit(EXIT_FAILURE);
+    }
+    NQ_STORE_RECORD *records = (NQ_STORE_RECORD *)(header + 1);
+    memcpy(header->magic, STORE_MAGIC, sizeof(header->magic));
+    header->capacity = capacity;
+    header->count = store->header->count;
+    for (uint64_t i = 0; i < old_capacity; ++i)
+    {
+        const NQ_STORE_RECORD *record = &store->records[i];
+        if (record->used)
+        {
+            const NQ_STORE_KEY key = {record->n_queens, (NQ_SYMMETRY)record->symmetry, record->depth, record->prefix};
+            *find_slot(records, capacity, &key) = *record;
+        }
+    }
+    if (msync(header, size, MS_SYNC) != 0 || fsync(fd) != 0 || rename(temporary, store->path) != 0)
+    {
+        perror("Failed to replace the result store");
+        exit(EXIT_FAILURE);
+    }
+    free(temporary);
+
+    // closing the replaced file releases its lock
+    munmap(store->header, store->mapped);
+    close(store->fd);
+    store->fd = fd;
+    store->header = header;
+    store->records = records;
+    store->mapped = size;
+}
+
+void nq_store_put(NQ_STORE *store, const NQ_STORE_KEY *key, uint64_t solutions, uint64_t placements)
+{
+    pthread_mutex_lock(&store->mutex);
+    if (2 * (store->header->count + 1) > store->header->capacity)
+    {
+        grow(store);
+    }
+    NQ_STORE_RECORD *record = find_slot(store->records, store->header->capacity, key);
+    if (!record->used)
+    {
+        record->prefix = key->prefix;
+        record->n_queens = key->n_queens;
+        record->depth = (uint16_t)key->depth;
+        record->symmetry = (uint8_t)key->symmetry;
+        ++store->header->count;
+    }
+    record->solutions = solutions;
+    record->placements = placements;
+    // written last: a crash before this line leaves the slot empty
+    record->used = 1;
+    pthread_mutex_unlock(&store->mutex);
+}
@@ -0,0 +1,80 @@
+#ifndef N_QUEENS_STORE_H
+#define N_QUEENS_STORE_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+/* Magasin de résultats persistant : un fichier projeté en mémoire (mmap) qui
+ * garde, d'un lancement à l'autre, les comptages terminés. La clé est
+ * (N, mode de symétrie, préfixe) : un préfixe vide désigne le total de
+ * l'échiquier, un préfixe de d colonnes le sous-problème sous ces d reines.
+ *
+ * Le fichier est une table de hachage à adressage ouvert de
+ * enregistrements de 32 octets, agrandie (et ré-hachée) quand elle se
+ * remplit : la table doublée est écrite dans `path`.tmp, qui ne remplace le
+ * magasin (rename) qu'une fois complète et sur disque. Un seul processus l'ouvre à la fois (verrou flock) ; dans ce
+ * processus les threads y accèdent sous un mutex. */
+
+// lignes du préfixe sur 5 bits chacune dans un mot de 64 bits
+#define NQ_STORE_MAX_DEPTH 12
+
+typedef enum nq_symmetry
+{
+    NQ_SYMMETRY_NONE, // tout l'échiquier est parcouru
+    NQ_SYMMETRY_HALF  // première reine dans la moitié haute, total doublé
+} NQ_SYMMETRY;
+
+typedef struct nq_store_key
+{
+    uint32_t n_queens;
+    NQ_SYMMETRY symmetry;
+    uint32_t depth;  // 0 : total de l'échiquier
+    uint64_t prefix; // ligne de la colonne j sur les bits [5j, 5j + 5)
+} NQ_STORE_KEY;
+
+typedef struct nq_store_record
+{
+    uint64_t prefix;
+    uint32_t n_queens;
+    uint16_t depth;
+    uint8_t symmetry;
+    uint8_t used;
+    uint64_t solutions;
+    uint64_t placements;
+} NQ_STORE_RECORD;
+
+typedef struct nq_store_header
+{
+    char magic[8];
+    uint64_t capacity;
+    uint64_t count;
+    uint64_t reserved;
+} NQ_STORE_HEADER;
+
+typedef struct nq_store
+{
+    int fd;
+    char *path;
+    NQ_STORE_HEADER *header;
+    NQ_STORE_RECORD *records;
+    uint64_t mapped;
+    pthread_mutex_t mutex;
+} NQ_STORE;
+
+/* Ouvrir (ou créer) le magasin `path` ; NULL s'il est déjà ouvert par un
+ * autre processus ou illisible */
+NQ_STORE *nq_store_open(const char *path);
+/* Écrire les pages modifiées sur disque et fermer */
+void nq_store_close(NQ_STORE *store);
+
+/* Lire un résultat : 1 s'il est connu, 0 sinon. `placements` peut être NULL. */
+int nq_store_get(NQ_STORE *store, const NQ_STORE_KEY *key, uint64_t *solutions, uint64_t *placements);
+/* Enregistrer (ou remplacer) un résultat */
+void nq_store_put(NQ_STORE *store, const NQ_STORE_KEY *key, uint64_t solutions, uint64_t placements);
+/* Forcer l'écriture sur disque des résultats déjà enregistrés */
+void nq_store_sync(NQ_STORE *store);
+
+/* Nombre de résultats enregistrés */
+uint64_t nq_store_count(NQ_STORE *store);
+
+#endif
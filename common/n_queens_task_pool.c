@@ -0,0 +1,258 @@
+#include "n_queens_task_pool.h"
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+POOL_ORDER pool_order_from_string(const char *name)
+{
+    if (name != NULL && strcmp(name, "lpt") == 0)
+    {
+        return POOL_LPT;
+    }
+    if (name != NULL && strcmp(name, "fifo") != 0)
+    {
+        fprintf(stderr, "Unknown task order '%s', using fifo.\n", name);
+    }
+    return POOL_FIFO;
+}
+
+void pool_init(TASK_POOL *pool, POOL_ORDER order)
+{
+    pool->tasks = NULL;
+    pool->priorities = NULL;
+    pool->sequences = NULL;
+    pool->count = 0;
+    pool->capacity = 0;
+    pool->next_sequence = 0;
+    pool->pending = 0;
+    pool->available = 0;
+    pool->finished = 0;
+    pool->waiting = 0;
+    pool->closed = 0;
+    // Spinning only pays off when the producer runs on another CPU
+    pool->spin_limit = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? POOL_SPIN_LIMIT : 0;
+    pool->order = order;
+    pool->sleepers = NULL;
+    pthread_mutex_init(&pool->mutex, NULL);
+}
+
+void pool_set_spin(TASK_POOL *pool, uint32_t spin_limit)
+{
+    pool->spin_limit = spin_limit;
+}
+
+void pool_destroy(TASK_POOL *pool)
+{
+    free(pool->tasks);
+    free(pool->priorities);
+    free(pool->sequences);
+    pthread_mutex_destroy(&pool->mutex);
+}
+
+// Backoff rounds of at least this many pauses end with a sched_yield
+#define POOL_YIELD_AFTER 64
+
+static inline void cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// Each thread parks on its own condition; it is only in the sleeper list
+// between pool_take's park and the wakeup that removes it. The condition is
+// created at the first park and destroyed when pool_take tells the thread to
+// exit (NULL), as no other thread can still signal it then
+static __thread POOL_SLEEPER self;
+static __thread int self_ready = 0;
+
+// Called with the mutex held whenever count, pending or closed changes
+static void publish_state(TASK_POOL *pool)
+{
+    __atomic_store_n(&pool->available, pool->count, __ATOMIC_RELEASE);
+    __atomic_store_n(&pool->finished, pool->closed && pool->pending == 0, __ATOMIC_RELEASE);
+}
+
+// Wake up to `count` sleepers, the most recently parked first; called with the mutex held
+static void wake_sleepers(TASK_POOL *pool, uint64_t count)
+{
+    while (count-- > 0 && pool->sleepers != NULL)
+    {
+        POOL_SLEEPER *sleeper = pool->sleepers;
+        pool->sleepers = sleeper->next;
+        sleeper->woken = 1;
+        pthread_cond_signal(&sleeper->cond);
+    }
+}
+
+int pool_hungry(TASK_POOL *pool)
+{
+    return __atomic_load_n(&pool->waiting, __ATOMIC_RELAXED) > __atomic_load_n(&pool->available, __ATOMIC_RELAXED);
+}
+
+// Whether the task in slot a must be served before the task in slot b
+static int before(const TASK_POOL *pool, uint64_t a, uint64_t b)
+{
+    if (pool->order == POOL_LPT && pool->priorities[a] != pool->priorities[b])
+    {
+        return pool->priorities[a] > pool->priorities[b];
+    }
+    return pool->sequences[a] < pool->sequences[b];
+}
+
+static void swap_slots(TASK_POOL *pool, uint64_t a, uint64_t b)
+{
+    void *task = pool->tasks[a];
+    const double priority = pool->priorities[a];
+    const uint64_t sequence = pool->sequences[a];
+    pool->tasks[a] = pool->tasks[b];
+    pool->priorities[a] = pool->priorities[b];
+    pool->sequences[a] = pool->sequences[b];
+    pool->tasks[b] = task;
+    pool->priorities[b] = priority;
+    pool->sequences[b] = sequence;
+}
+
+void pool_submit(TASK_POOL *pool, void *task, double priority)
+{
+    pthread_mutex_lock(&pool->mutex);
+    if (pool->count == pool->capacity)
+    {
+        pool->capacity = pool->capacity ? 2 * pool->capacity : 256;
+        pool->tasks = realloc(pool->tasks, sizeof(void *) * pool->capacity);
+        pool->priorities = realloc(pool->priorities, sizeof(double) * pool->capacity);
+        pool->sequences = realloc(pool->sequences, sizeof(uint64_t) * pool->capacity);
+        if (pool->tasks == NULL || pool->priorities == NULL || pool->sequences == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed for the task pool.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Sift the new task up the heap
+    uint64_t i = pool->count++;
+    pool->tasks[i] = task;
+    pool->priorities[i] = priority;
+    pool->sequences[i] = pool->next_sequence++;
+    while (i > 0 && before(pool, i, (i - 1) / 2))
+    {
+        swap_slots(pool, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    ++pool->pending;
+    publish_state(pool);
+    // One new task, one sleeper; spinning workers find it by themselves
+    wake_sleepers(pool, 1);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void *pool_take(TASK_POOL *pool)
+{
+    __atomic_add_fetch(&pool->waiting, 1, __ATOMIC_RELAXED);
+
+    // Spin with exponential backoff before paying for a futex sleep and wakeup
+    for (uint32_t pauses = 1; pauses <= pool->spin_limit; pauses <<= 1)
+    {
+        if (__atomic_load_n(&pool->available, __ATOMIC_ACQUIRE) > 0 ||
+            __atomic_load_n(&pool->finished, __ATOMIC_ACQUIRE))
+        {
+            break;
+        }
+        for (uint32_t i = 0; i < pauses; ++i)
+        {
+            cpu_relax();
+        }
+        // Long rounds give the CPU back, in case the producer shares it
+        if (pauses >= POOL_YIELD_AFTER)
+        {
+            sched_yield();
+        }
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->count == 0 && !(pool->closed && pool->pending == 0))
+    {
+        if (!self_ready)
+        {
+            pthread_cond_init(&self.cond, NULL);
+            self_ready = 1;
+        }
+        self.woken = 0;
+        self.next = pool->sleepers;
+        pool->sleepers = &self;
+        while (!self.woken)
+        {
+            pthread_cond_wait(&self.cond, &pool->mutex);
+        }
+    }
+    __atomic_sub_fetch(&pool->waiting, 1, __ATOMIC_RELAXED);
+    if (pool->count == 0)
+    {
+        if (self_ready)
+        {
+            pthread_cond_destroy(&self.cond);
+            self_ready = 0;
+        }
+        pthread_mutex_unlock(&pool->mutex);
+        return NULL;
+    }
+
+    // Take the root, move the last task there and sift it down
+    void *task = pool->tasks[0];
+    --pool->count;
+    if (pool->count > 0)
+    {
+        swap_slots(pool, 0, pool->count);
+        uint64_t i = 0;
+        while (1)
+        {
+            const uint64_t left = 2 * i + 1;
+            const uint64_t right = left + 1;
+            uint64_t first = i;
+            if (left < pool->count && before(pool, left, first))
+            {
+                first = left;
+            }
+            if (right < pool->count && before(pool, right, first))
+            {
+                first = right;
+            }
+            if (first == i)
+            {
+                break;
+            }
+            swap_slots(pool, i, first);
+            i = first;
+        }
+    }
+    publish_state(pool);
+    pthread_mutex_unlock(&pool->mutex);
+    return task;
+}
+
+void pool_task_done(TASK_POOL *pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    --pool->pending;
+    publish_state(pool);
+    if (pool->closed && pool->pending == 0)
+    {
+        wake_sleepers(pool, UINT64_MAX);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void pool_close(TASK_POOL *pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    pool->closed = 1;
+    publish_state(pool);
+    if (pool->pending == 0)
+    {
+        wake_sleepers(pool, UINT64_MAX);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
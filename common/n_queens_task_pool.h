@@ -0,0 +1,83 @@
+#ifndef N_QUEENS_TASK_POOL_H
+#define N_QUEENS_TASK_POOL_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+/* Ordre de service des tâches :
+ *  - POOL_FIFO : ordre de soumission
+ *  - POOL_LPT  : plus grande priorité (travail estimé) d'abord */
+typedef enum pool_order
+{
+    POOL_FIFO,
+    POOL_LPT
+} POOL_ORDER;
+
+/* Nombre maximal de pauses d'un thread sans travail avant de s'endormir ; il
+ * attend 1, 2, 4, ... pauses entre deux regards sur la file. Sur une machine à
+ * un seul CPU le pool s'endort tout de suite. */
+#define POOL_SPIN_LIMIT 4096
+
+/* Place d'un thread endormi : chacun attend sur sa propre condition, pour
+ * qu'une soumission ne réveille que le nombre de threads utile */
+typedef struct pool_sleeper
+{
+    pthread_cond_t cond;
+    int woken;
+    struct pool_sleeper *next;
+} POOL_SLEEPER;
+
+/* File de tâches partagée par les threads d'un pool, rangée en tas binaire.
+ * `pending` compte les tâches soumises et pas encore terminées : une fois la
+ * file fermée, les threads sortent quand il n'en reste plus. */
+typedef struct task_pool
+{
+    void **tasks;
+    double *priorities;
+    uint64_t *sequences;
+    uint64_t count;
+    uint64_t capacity;
+    uint64_t next_sequence;
+    uint64_t pending;
+    // copies de count et de l'état de fin, lues sans verrou pendant l'attente active
+    uint64_t available;
+    int finished;
+    // threads sans tâche, qu'ils tournent ou dorment
+    uint64_t waiting;
+    int closed;
+    uint32_t spin_limit;
+    POOL_ORDER order;
+    POOL_SLEEPER *sleepers;
+    pthread_mutex_t mutex;
+} TASK_POOL;
+
+/* Convertir "fifo" ou "lpt" en ordre de service */
+POOL_ORDER pool_order_from_string(const char *name);
+
+/* Initialiser / détruire une file vide */
+void pool_init(TASK_POOL *pool, POOL_ORDER order);
+void pool_destroy(TASK_POOL *pool);
+
+/* Changer le nombre maximal de pauses avant de s'endormir (0 : s'endormir tout de suite) */
+void pool_set_spin(TASK_POOL *pool, uint32_t spin_limit);
+
+/* Ajouter une tâche ; `priority` n'est utilisée qu'avec POOL_LPT */
+void pool_submit(TASK_POOL *pool, void *task, double priority);
+
+/* Retirer la prochaine tâche, en attendant s'il le faut (attente active
+ * bornée, puis sommeil) ; renvoie NULL quand la file est fermée et que toutes
+ * les tâches sont terminées */
+void *pool_take(TASK_POOL *pool);
+
+/* Vrai quand des threads attendent plus de tâches que la file n'en contient.
+ * Lecture sans verrou, faite pour être testée souvent pendant une recherche */
+int pool_hungry(TASK_POOL *pool);
+
+/* Signaler la fin d'une tâche obtenue par pool_take */
+void pool_task_done(TASK_POOL *pool);
+
+/* Plus aucune tâche ne viendra de l'extérieur (les tâches en cours peuvent
+ * encore en soumettre) */
+void pool_close(TASK_POOL *pool);
+
+#endif
@@ -0,0 +1,113 @@
+#include "n_queens_telemetry.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+double telemetry_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+void telemetry_reset(WORKER_STATS *stats)
+{
+    memset(stats, 0, sizeof(WORKER_STATS));
+}
+
+void telemetry_task_done(WORKER_STATS *stats, uint64_t nodes, double seconds)
+{
+    uint32_t bucket = 0;
+    while (bucket + 1 < TELEMETRY_BUCKETS && (nodes >> (bucket + 1)) != 0)
+    {
+        ++bucket;
+    }
+    ++stats->tasks;
+    stats->nodes += nodes;
+    stats->busy += seconds;
+    ++stats->histogram[bucket];
+}
+
+void telemetry_idle(WORKER_STATS *stats, double seconds)
+{
+    stats->idle += seconds;
+}
+
+void telemetry_merge(WORKER_STATS *into, const WORKER_STATS *from)
+{
+    into->tasks += from->tasks;
+    into->nodes += from->nodes;
+    into->steals += from->steals;
+    into->busy += from->busy;
+    into->idle += from->idle;
+    for (uint32_t k = 0; k < TELEMETRY_BUCKETS; ++k)
+    {
+        into->histogram[k] += from->histogram[k];
+    }
+}
+
+// Print mean, max, max/mean and coefficient of variation of one counter
+static void report_line(const char *name, const double *values, uint32_t count)
+{
+    double sum = 0.0, max = 0.0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        sum += values[i];
+        if (values[i] > max)
+        {
+            max = values[i];
+        }
+    }
+    const double mean = sum / count;
+    double variance = 0.0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        variance += (values[i] - mean) * (values[i] - mean);
+    }
+    variance /= count;
+    const double ratio = mean > 0.0 ? max / mean : 0.0;
+    const double cv = mean > 0.0 ? sqrt(variance) / mean : 0.0;
+    printf("  %-7s : mean %14.3f  max %14.3f  max/mean %6.3f  cv %6.3f\n", name, mean, max, ratio, cv);
+}
+
+void telemetry_report(const char *label, const WORKER_STATS *stats, uint32_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    double values[3][count];
+    WORKER_STATS total;
+    telemetry_reset(&total);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        values[0][i] = (double)stats[i].tasks;
+        values[1][i] = (double)stats[i].nodes;
+        values[2][i] = stats[i].busy;
+        telemetry_merge(&total, &stats[i]);
+    }
+
+    printf("load balance over %u %s%s\n", count, label, count > 1 ? "s" : "");
+    report_line("tasks", values[0], count);
+    report_line("nodes", values[1], count);
+    report_line("busy s", values[2], count);
+    const double elapsed = total.busy + total.idle;
+    printf("  idle    : %.3f s (%.1f%% of worker time), steals : %lu\n",
+           total.idle, elapsed > 0.0 ? 100.0 * total.idle / elapsed : 0.0, total.steals);
+
+    printf("  nodes per task histogram :\n");
+    for (uint32_t k = 0; k < TELEMETRY_BUCKETS; ++k)
+    {
+        // the first class also holds the tasks that visited no node
+        if (total.histogram[k] != 0 && k == 0)
+        {
+            printf("    [0   , 2^1 ) : %lu\n", total.histogram[k]);
+        }
+        else if (total.histogram[k] != 0)
+        {
+            printf("    [2^%-2u, 2^%-2u) : %lu\n", k, k + 1, total.histogram[k]);
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef N_QUEENS_TELEMETRY_H
+#define N_QUEENS_TELEMETRY_H
+
+#include <stdint.h>
+
+/* Nombre de classes de l'histogramme : la classe k compte les tâches ayant
+ * visité entre 2^k et 2^(k+1)-1 noeuds, la classe 0 aussi celles sans noeud */
+#define TELEMETRY_BUCKETS 48
+
+/* Compteurs de charge d'un travailleur (thread ou processus). La structure
+ * ne contient pas de pointeur : elle peut être envoyée telle quelle par MPI. */
+typedef struct worker_stats
+{
+    uint64_t tasks;
+    uint64_t nodes;
+    uint64_t steals;
+    double busy;
+    double idle;
+    uint64_t histogram[TELEMETRY_BUCKETS];
+} WORKER_STATS;
+
+/* Horloge monotone en secondes */
+double telemetry_now(void);
+
+/* Remettre les compteurs à zéro */
+void telemetry_reset(WORKER_STATS *stats);
+
+/* Enregistrer une tâche terminée : noeuds visités et durée */
+void telemetry_task_done(WORKER_STATS *stats, uint64_t nodes, double seconds);
+
+/* Ajouter du temps passé à attendre du travail */
+void telemetry_idle(WORKER_STATS *stats, double seconds);
+
+/* Additionner les compteurs de `from` dans `into` */
+void telemetry_merge(WORKER_STATS *into, const WORKER_STATS *from);
+
+/* Afficher le résumé de déséquilibre : max/moyenne, coefficient de variation,
+ * temps d'attente et histogramme des tailles de tâches */
+void telemetry_report(const char *label, const WORKER_STATS *stats, uint32_t count);
+
+#endif
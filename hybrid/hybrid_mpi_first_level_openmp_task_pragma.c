@@ -5,32 +5,26 @@
 #include <pthread.h>
 #include <time.h>
 #include <mpi.h>
+#include <omp.h>
+#include "../common/n_queens_affinity.h"
+#include "../common/n_queens_telemetry.h"
+#include "../common/n_queens_core.h"
 
 uint64_t partial_solutions = 0;
 uint64_t total_solutions = 0;
 uint64_t solutions = 0; // Shared variable to store the sum of solutions
 
 int nthreads = 4;
+// index of this rank's first thread among all the threads of its node
+int worker_offset = 0;
+// load counters of each thread, merged into the rank's counters
+WORKER_STATS thread_stats;
+WORKER_STATS rank_stats;
 
 // An abstract representation of an NxN chess board to tracking open positions
-struct chess_board
-{
-    uint32_t n_size;           // Number of queens on the NxN chess board
-    uint32_t *queen_positions; // Store queen positions on the board
-    uint32_t *column;          // Store available column moves/attacks
-    uint32_t *diagonal_up;     // Store available diagonal moves/attacks
-    uint32_t *diagonal_down;
-    uint32_t column_j;   // Stores column to place the next queen in
-    uint64_t placements; // Tracks total number queen placements
-    uint64_t solutions;  // Tracks number of solutions
-    //indicate the intervals of rows that will be verified for each thread or process
-    uint64_t start;
-    uint64_t end;
-};
 
 struct chess_board *board;
 
-struct chess_board *copyBoard(const struct chess_board *board);
 
 void place_next_queen_sequential(const uint32_t row_boundary, struct chess_board  *board);
 
@@ -40,85 +34,7 @@ void place_next_queen_parallel(const uint32_t row_boundary, struct chess_board
 void place_queens(const uint32_t row_boundary, struct chess_board  *board);
 
 
-// Handles dynamic memory allocation of the arrays and sets initial values
-static void initialize_board(const uint32_t n_queens, struct chess_board **board, uint32_t start, uint32_t end)
-{
-    if (n_queens < 1)
-    {
-        fprintf(stderr, "The number of queens must be greater than 0.\n");
-        exit(EXIT_SUCCESS);
-    }
-
-    // Dynamically allocate memory for chessboard struct
-    *board = malloc(sizeof(struct chess_board));
-    if (*board == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed for chess board.\n");
-        exit(EXIT_FAILURE);
-    }
-
-    // Dynamically allocate memory for chessboard arrays that track positions
-    const uint32_t diagonal_size = 2 * n_queens - 1;
-    const uint32_t total_size = 2 * (n_queens + diagonal_size);
-    (*board)->queen_positions = malloc(sizeof(uint32_t) * total_size);
-    if ((*board)->queen_positions == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed for the chess board arrays.\n");
-        free(*board);
-        exit(EXIT_FAILURE);
-    }
-    (*board)->column = &(*board)->queen_positions[n_queens];
-    (*board)->diagonal_up = &(*board)->column[n_queens];
-    (*board)->diagonal_down = &(*board)->diagonal_up[diagonal_size];
-
-    // Initialize the chess board parameters
-    (*board)->n_size = n_queens;
-    for (uint32_t i = 0; i < n_queens; ++i)
-    {
-        (*board)->queen_positions[i] = 0;
-    }
-    for (uint32_t i = n_queens; i < total_size; ++i)
-    {
-        // Initializes values for column, diagonal_up, and diagonal_down
-        (*board)->queen_positions[i] = 1;
-    }
-    (*board)->column_j = 0;
-    (*board)->placements = 0;
-    (*board)->solutions = 0;
-    (*board)->start = start;
-    (*board)->end = end;
-}
-
-// Check if a queen can be placed in at row 'i' of the current column
-static uint32_t square_is_free(const uint32_t row_i, struct chess_board *board)
-{
-    return board->column[row_i] &
-           board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] &
-           board->diagonal_down[board->column_j + row_i];
-}
-
-// Place a queen on the chess board at row 'i' of the current column
-static void set_queen(const uint32_t row_i, struct chess_board *board)
-{
-    board->queen_positions[board->column_j] = row_i;
-    board->column[row_i] = 0;
-    board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] = 0;
-    board->diagonal_down[board->column_j + row_i] = 0;
-    ++board->column_j;
-    ++board->placements;
-}
-
-// Removes a queen from the NxN chess board in the given column to backtrack
-static void remove_queen(const uint32_t row_i, struct chess_board *board)
-{
-    --board->column_j;
-    board->diagonal_down[board->column_j + row_i] = 1;
-    board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] = 1;
-    board->column[row_i] = 1;
-}
-
-
-#pragma omp threadprivate(partial_solutions)
+#pragma omp threadprivate(partial_solutions, thread_stats)
 /** Lancer le processus de placement parallèle des reines sur l'échiquier. **/
 void place_queens(const uint32_t row_boundary, struct chess_board *board)
 
@@ -126,8 +42,14 @@ void place_queens(const uint32_t row_boundary, struct chess_board *board)
     //crée une région parallèle avec nqueens threads
     #pragma omp parallel num_threads(nthreads) 
     {
+        //Fixer chaque thread sur son CPU selon NQ_PLACEMENT, sans chevaucher les
+        //threads des autres processus du même noeud
+        placement_bind_worker(worker_offset + omp_get_thread_num());
+
         //Initialiser le nombre de solutions partielles et de placements partiels pour chaque thread
         partial_solutions = 0;
+        telemetry_reset(&thread_stats);
+        const double region_start = telemetry_now();
 
         //Assurer que la ligne suivante soit appelée par un seul thread et que les autres threads ne l'attendent pas
         #pragma omp single 
@@ -137,8 +59,14 @@ void place_queens(const uint32_t row_boundary, struct chess_board *board)
         }
 
         //Additionner le nombre de solutions et de placements trouvés par chaque thread
+        //le temps de la région qui n'a pas servi à une tâche séquentielle est compté comme attente
+        telemetry_idle(&thread_stats, telemetry_now() - region_start - thread_stats.busy);
+
         #pragma omp critical
-        total_solutions += partial_solutions;
+        {
+            total_solutions += partial_solutions;
+            telemetry_merge(&rank_stats, &thread_stats);
+        }
     }
 
     
@@ -193,7 +121,10 @@ void place_next_queen_parallel(const uint32_t row_boundary, struct chess_board *
                 
                     place_next_queen_parallel(limit, local_board);
                 } else {
+                    const double task_start = telemetry_now();
+                    const uint64_t placements = local_board->placements;
                     place_next_queen_sequential(limit, local_board);
+                    telemetry_task_done(&thread_stats, local_board->placements - placements, telemetry_now() - task_start);
                 }
 
             #pragma omp taskyield
@@ -232,62 +163,6 @@ void place_next_queen_sequential(const uint32_t row_boundary, struct chess_board
 }
 
 
-struct chess_board *copyBoard(const struct chess_board *board)
-
-{
-  struct chess_board *task = malloc(sizeof(struct chess_board));
-
-  if (board->n_size < 1)
-  {
-    fprintf(stderr, "The number of queens must be greater than 0.\n");
-    exit(EXIT_SUCCESS);
-  }
-
-  // Dynamically allocate memory for chessboard struct
-  task = malloc(sizeof(struct chess_board));
-  if (task == NULL)
-  {
-    fprintf(stderr, "Memory allocation failed for chess board.\n");
-    exit(EXIT_FAILURE);
-  }
-
-  // Dynamically allocate memory for chessboard arrays that track positions
-  const uint32_t diagonal_size = 2 * board->n_size - 1;
-  const uint32_t total_size = 2 * (board->n_size + diagonal_size);
-  (task)->queen_positions = malloc(sizeof(uint32_t) * total_size);
-  if ((task)->queen_positions == NULL)
-  {
-    fprintf(stderr, "Memory allocation failed for the chess board arrays.\n");
-    free(task);
-    exit(EXIT_FAILURE);
-  }
-  (task)->column = &(task)->queen_positions[board->n_size];
-  (task)->diagonal_up = &(task)->column[board->n_size];
-  (task)->diagonal_down = &(task)->diagonal_up[diagonal_size];
-
-  // Initialize the chess board parameters
-  (task)->n_size = board->n_size;
-  for (uint32_t i = 0; i < board->n_size; ++i)
-  {
-    task->queen_positions[i] = board->queen_positions[i];
-  }
-  for (uint32_t i = board->n_size; i < total_size; ++i)
-  {
-    // Initializes values for column, diagonal_up, and diagonal_down
-    task->queen_positions[i] = board->queen_positions[i];
-  }
-  task->column_j = board->column_j;
-  task->placements = board->placements;
-  task->start = board->start;
-  task->end = board->end;
-
-  return task;
-}
-
-
-
-
-
 int main(int argc, char *argv[])
 {
     static const uint32_t default_n = 4;
@@ -300,6 +175,15 @@ int main(int argc, char *argv[])
     MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
 
+    // Ranks sharing a node get disjoint CPU ranges
+    MPI_Comm node_comm;
+    int node_rank;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+    MPI_Comm_rank(node_comm, &node_rank);
+    MPI_Comm_free(&node_comm);
+    placement_init(PLACEMENT_NONE);
+    worker_offset = placement_first_worker(node_rank, nthreads);
+
     const uint32_t row_boundary = (n_queens >> 1) + (n_queens & 1);
 
 
@@ -318,12 +202,18 @@ int main(int argc, char *argv[])
     uint64_t totalS = 0;
     printf(" %lu solutions\n", total_solutions);
     MPI_Reduce(&total_solutions, &totalS, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+    // Rassembler les compteurs de charge des processus avec la réduction
+    WORKER_STATS *all_stats = rank == 0 ? malloc(sizeof(WORKER_STATS) * num_procs) : NULL;
+    MPI_Gather(&rank_stats, sizeof(WORKER_STATS), MPI_BYTE, all_stats, sizeof(WORKER_STATS), MPI_BYTE, 0, MPI_COMM_WORLD);
     // Print the total number of solutions from the root process
     if (rank == 0) {
         clock_t end_time = clock();
         double time_totale = (double)(end_time-start_time)/CLOCKS_PER_SEC;
         printf("program takes : %f s \n",time_totale);
         printf("The %u-Queens problem has %lu solutions\n", n_queens, totalS);
+        placement_report(nthreads);
+        telemetry_report("rank", all_stats, num_procs);
+        free(all_stats);
     }
 
     // Clean up the MPI environment
@@ -334,6 +224,5 @@ int main(int argc, char *argv[])
 }
 
 
-
     
 
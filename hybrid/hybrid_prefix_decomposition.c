@@ -0,0 +1,219 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <mpi.h>
+#include <omp.h>
+#include "../common/n_queens_affinity.h"
+#include "../common/n_queens_telemetry.h"
+#include "../common/n_queens_estimator.h"
+#include "../common/n_queens_core.h"
+
+// Profondeur maximale d'un préfixe (niveau processus + niveau thread)
+#define MAX_DEPTH 12
+// Nombre minimal de préfixes par processus (resp. par thread) visé lors du
+// choix automatique des profondeurs d et d+k
+#define PREFIXES_PER_WORKER 8
+
+int nthreads = 4;
+
+// Un préfixe : les lignes des reines des premières colonnes de l'échiquier
+typedef struct prefix
+{
+    uint32_t rows[MAX_DEPTH];
+} Prefix;
+
+
+// Replacer les reines d'un préfixe de longueur `depth` sur l'échiquier
+static void apply_prefix(const Prefix *prefix, uint32_t depth, struct chess_board *board)
+{
+    for (uint32_t j = 0; j < depth && j < board->n_size; ++j)
+    {
+        set_queen(prefix->rows[j], board);
+    }
+}
+
+// Retirer les reines posées par apply_prefix, l'échiquier redevient vide
+static void undo_prefix(const Prefix *prefix, uint32_t depth, struct chess_board *board)
+{
+    for (uint32_t j = depth < board->n_size ? depth : board->n_size; j > 0; --j)
+    {
+        remove_queen(prefix->rows[j - 1], board);
+    }
+}
+
+// Choisir la plus petite profondeur (> base_depth) dont le frontier sous les
+// préfixes donnés contient au moins `target` préfixes
+static uint32_t choose_depth(const uint32_t n_queens, const Prefix *base, uint64_t base_count,
+                             uint32_t base_depth, uint64_t target)
+{
+    uint32_t depth = base_depth;
+    uint64_t count = base_count;
+    struct chess_board *board;
+    initialize_board(n_queens, &board, 0, 0);
+    uint32_t *prefixes = NULL;
+    uint64_t capacity = 0;
+    while (count < target && depth < MAX_DEPTH && depth < n_queens)
+    {
+        ++depth;
+        count = 0;
+        for (uint64_t i = 0; i < base_count; ++i)
+        {
+            apply_prefix(&base[i], base_depth, board);
+            nq_half_board_expand(board, depth, MAX_DEPTH, &prefixes, &count, &capacity);
+            undo_prefix(&base[i], base_depth, board);
+        }
+    }
+    free(prefixes);
+    smash_board(board);
+    return depth;
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t default_n = 4;
+    int num_procs = 2;
+    int rank;
+
+    const uint32_t n_queens = (argc > 1) ? (uint32_t)atoi(argv[1]) : default_n;
+    nthreads = (argc > 2) ? atoi(argv[2]) : nthreads;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    // Les processus d'un même noeud reçoivent des plages de CPU disjointes
+    MPI_Comm node_comm;
+    int node_rank;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+    MPI_Comm_rank(node_comm, &node_rank);
+    MPI_Comm_free(&node_comm);
+    placement_init(PLACEMENT_NONE);
+    const uint32_t worker_offset = placement_first_worker(node_rank, nthreads);
+    omp_set_num_threads(nthreads);
+
+    double start_time = MPI_Wtime();
+
+    // Niveau processus : la profondeur d est choisie pour donner au moins
+    // PREFIXES_PER_WORKER préfixes à chaque processus. Tous les processus
+    // génèrent le même frontier de façon déterministe, sans communication.
+    Prefix root = {{0}};
+    const uint32_t rank_depth = choose_depth(n_queens, &root, 1, 0,
+                                             (uint64_t)PREFIXES_PER_WORKER * num_procs);
+    uint32_t *rows = NULL;
+    uint64_t frontier_count = 0, capacity = 0;
+    struct chess_board *board;
+    initialize_board(n_queens, &board, 0, 0);
+    nq_half_board_expand(board, rank_depth, MAX_DEPTH, &rows, &frontier_count, &capacity);
+    smash_board(board);
+    Prefix *frontier = (Prefix *)rows;
+
+    // Chaque processus prend un intervalle contigu du frontier, de poids estimé
+    // proche de celui des autres ; la graine de l'estimateur est fixe, tous les
+    // processus obtiennent donc les mêmes bornes
+    double *weights = malloc(sizeof(double) * (frontier_count ? frontier_count : 1));
+    uint64_t *bounds = malloc(sizeof(uint64_t) * (num_procs + 1));
+    estimator_frontier(n_queens, frontier[0].rows, MAX_DEPTH, frontier_count,
+                       rank_depth < n_queens ? rank_depth : n_queens, ESTIMATOR_DEFAULT_SAMPLES, weights);
+    estimator_weighted_split(weights, frontier_count, num_procs, bounds);
+    const uint64_t rank_count = bounds[rank + 1] - bounds[rank];
+    Prefix *rank_prefixes = malloc(sizeof(Prefix) * (rank_count ? rank_count : 1));
+    memcpy(rank_prefixes, &frontier[bounds[rank]], sizeof(Prefix) * rank_count);
+    free(bounds);
+    free(weights);
+    free(frontier);
+
+    // Niveau thread : chaque préfixe du processus est redécoupé à la profondeur
+    // d+k, k étant choisi pour donner au moins PREFIXES_PER_WORKER tâches par thread
+    const uint32_t thread_depth = choose_depth(n_queens, rank_prefixes, rank_count, rank_depth,
+                                               (uint64_t)PREFIXES_PER_WORKER * nthreads);
+    rows = NULL;
+    uint64_t task_count = 0;
+    capacity = 0;
+    initialize_board(n_queens, &board, 0, 0);
+    for (uint64_t i = 0; i < rank_count; ++i)
+    {
+        apply_prefix(&rank_prefixes[i], rank_depth, board);
+        nq_half_board_expand(board, thread_depth, MAX_DEPTH, &rows, &task_count, &capacity);
+        undo_prefix(&rank_prefixes[i], rank_depth, board);
+    }
+    smash_board(board);
+    Prefix *tasks = (Prefix *)rows;
+    free(rank_prefixes);
+
+    uint64_t total_solutions = 0;
+    // Compteurs de chaque thread, rassemblés tels quels sur le processus 0 pour
+    // voir aussi le déséquilibre entre threads d'un même processus
+    WORKER_STATS *thread_stats = calloc(nthreads, sizeof(WORKER_STATS));
+    WORKER_STATS rank_stats;
+    telemetry_reset(&rank_stats);
+    const double region_start = telemetry_now();
+    #pragma omp parallel reduction(+ : total_solutions)
+    {
+        // Placer le thread puis allouer son échiquier (first touch sur son noeud)
+        placement_bind_worker(worker_offset + omp_get_thread_num());
+
+        // Un échiquier par thread, réutilisé par toutes ses tâches
+        struct chess_board *local_board;
+        initialize_board(n_queens, &local_board, 0, 0);
+
+        WORKER_STATS stats;
+        telemetry_reset(&stats);
+
+        #pragma omp for schedule(dynamic, 1) nowait
+        for (uint64_t i = 0; i < task_count; ++i)
+        {
+            const double task_start = telemetry_now();
+            const uint64_t placements = local_board->placements;
+            nq_half_board_solve(NQ_KERNEL_BITBOARD, tasks[i].rows, thread_depth, local_board);
+            telemetry_task_done(&stats, local_board->placements - placements, telemetry_now() - task_start);
+        }
+
+        // Un thread sans tâche attend la fin de la région parallèle
+        #pragma omp barrier
+        telemetry_idle(&stats, telemetry_now() - region_start - stats.busy);
+        thread_stats[omp_get_thread_num()] = stats;
+
+        total_solutions += local_board->solutions;
+        smash_board(local_board);
+    }
+    free(tasks);
+
+    uint64_t totalS = 0;
+    MPI_Reduce(&total_solutions, &totalS, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+    // Rassembler les compteurs de charge des processus avec la réduction
+    for (int t = 0; t < nthreads; ++t)
+    {
+        telemetry_merge(&rank_stats, &thread_stats[t]);
+    }
+    WORKER_STATS *all_stats = rank == 0 ? malloc(sizeof(WORKER_STATS) * num_procs) : NULL;
+    MPI_Gather(&rank_stats, sizeof(WORKER_STATS), MPI_BYTE, all_stats, sizeof(WORKER_STATS), MPI_BYTE, 0, MPI_COMM_WORLD);
+    WORKER_STATS *all_threads = rank == 0 ? malloc(sizeof(WORKER_STATS) * num_procs * nthreads) : NULL;
+    MPI_Gather(thread_stats, nthreads * sizeof(WORKER_STATS), MPI_BYTE, all_threads, nthreads * sizeof(WORKER_STATS),
+               MPI_BYTE, 0, MPI_COMM_WORLD);
+    free(thread_stats);
+    // Print the total number of solutions from the root process
+    if (rank == 0)
+    {
+        // The next line fixes double-counting when solving the 1-queen problem
+        if (n_queens == 1)
+        {
+            totalS = 1;
+        }
+        double end_time = MPI_Wtime();
+        printf("depth per rank : %u, depth per thread : %u\n", rank_depth, thread_depth);
+        printf("program takes : %f s \n", end_time - start_time);
+        printf("The %u-Queens problem has %lu solutions\n", n_queens, totalS);
+        placement_report(nthreads);
+        telemetry_report("rank", all_stats, num_procs);
+        telemetry_report("thread", all_threads, num_procs * nthreads);
+        free(all_stats);
+        free(all_threads);
+    }
+
+    // Clean up the MPI environment
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+}
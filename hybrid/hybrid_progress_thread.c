@@ -0,0 +1,460 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <mpi.h>
+#include <omp.h>
+#include "../common/n_queens_affinity.h"
+#include "../common/n_queens_telemetry.h"
+#include "../common/n_queens_core.h"
+
+// Profondeur maximale d'un préfixe
+#define MAX_DEPTH 12
+// Nombre minimal de tâches visé par thread de calcul, toutes machines confondues
+#define PREFIXES_PER_WORKER 16
+// Intervalle minimal entre deux rapports de charge envoyés au processus 0
+#define REPORT_INTERVAL 0.005
+// Attente maximale avant une nouvelle demande de vol après un refus
+#define MAX_STEAL_BACKOFF 0.01
+
+// Étiquettes des messages servis par le thread de progression
+#define TAG_STEAL_REQUEST 1
+#define TAG_STEAL_REPLY 2
+#define TAG_LOAD_REPORT 3
+#define TAG_DONE 4
+
+int nthreads = 4;
+
+// Un préfixe : les lignes des reines des premières colonnes de l'échiquier
+typedef struct prefix
+{
+    uint32_t rows[MAX_DEPTH];
+} Prefix;
+
+// File locale des tâches d'un processus, partagée entre les threads de calcul
+// (qui dépilent) et le thread de progression (qui donne ou reçoit des tâches)
+typedef struct task_pool
+{
+    Prefix *tasks;
+    uint64_t count;
+    uint64_t capacity;
+    omp_lock_t lock;
+} TaskPool;
+
+// Un envoi non bloquant en cours et le tampon à libérer une fois terminé
+typedef struct pending_send
+{
+    MPI_Request request;
+    void *buffer;
+} PendingSend;
+
+TaskPool pool;
+PendingSend *pending = NULL;
+int pending_count = 0;
+int pending_capacity = 0;
+
+// Drapeau de fin et nombre de tâches terminées par ce processus, lus par le
+// thread de progression pendant que les threads de calcul travaillent
+int done = 0;
+uint64_t completed_tasks = 0;
+
+
+// Ajouter des tâches dans la file locale
+static void pool_push(const Prefix *tasks, uint64_t count)
+{
+    omp_set_lock(&pool.lock);
+    if (pool.count + count > pool.capacity)
+    {
+        pool.capacity = 2 * (pool.count + count);
+        pool.tasks = realloc(pool.tasks, sizeof(Prefix) * pool.capacity);
+        if (pool.tasks == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed for the task pool.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memcpy(&pool.tasks[pool.count], tasks, sizeof(Prefix) * count);
+    pool.count += count;
+    omp_unset_lock(&pool.lock);
+}
+
+// Dépiler une tâche ; renvoie 0 si la file est vide
+static int pool_pop(Prefix *task)
+{
+    int found = 0;
+    omp_set_lock(&pool.lock);
+    if (pool.count > 0)
+    {
+        *task = pool.tasks[--pool.count];
+        found = 1;
+    }
+    omp_unset_lock(&pool.lock);
+    return found;
+}
+
+// Retirer la moitié de la file (les tâches les plus anciennes) pour un voleur
+static uint64_t pool_split(Prefix **stolen)
+{
+    omp_set_lock(&pool.lock);
+    const uint64_t count = pool.count / 2;
+    *stolen = malloc(sizeof(Prefix) * (count ? count : 1));
+    memcpy(*stolen, pool.tasks, sizeof(Prefix) * count);
+    memmove(pool.tasks, &pool.tasks[count], sizeof(Prefix) * (pool.count - count));
+    pool.count -= count;
+    omp_unset_lock(&pool.lock);
+    return count;
+}
+
+static uint64_t pool_size(void)
+{
+    omp_set_lock(&pool.lock);
+    const uint64_t count = pool.count;
+    omp_unset_lock(&pool.lock);
+    return count;
+}
+
+// Envoyer un message sans bloquer le thread de progression ; le tampon est
+// libéré lorsque l'envoi est terminé
+static void send_async(void *buffer, int bytes, int dest, int tag)
+{
+    if (pending_count == pending_capacity)
+    {
+        pending_capacity = pending_capacity ? 2 * pending_capacity : 16;
+        pending = realloc(pending, sizeof(PendingSend) * pending_capacity);
+    }
+    pending[pending_count].buffer = buffer;
+    MPI_Isend(buffer, bytes, MPI_BYTE, dest, tag, MPI_COMM_WORLD, &pending[pending_count].request);
+    ++pending_count;
+}
+
+// Libérer les envois terminés ; renvoie 1 s'il n'en reste plus
+static int progress_sends(void)
+{
+    int i = 0;
+    while (i < pending_count)
+    {
+        int finished;
+        MPI_Test(&pending[i].request, &finished, MPI_STATUS_IGNORE);
+        if (finished)
+        {
+            free(pending[i].buffer);
+            pending[i] = pending[--pending_count];
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    return pending_count == 0;
+}
+
+// Recevoir et ignorer tout message arrivé après la fin du calcul
+static void discard_messages(void)
+{
+    int flag;
+    MPI_Status status;
+    MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &flag, &status);
+    if (flag)
+    {
+        int bytes;
+        MPI_Get_count(&status, MPI_BYTE, &bytes);
+        char *buffer = malloc(bytes ? bytes : 1);
+        MPI_Recv(buffer, bytes, MPI_BYTE, status.MPI_SOURCE, status.MPI_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        free(buffer);
+    }
+}
+
+// Boucle du thread de progression : sert les demandes de vol et les rapports
+// de charge, vole du travail quand la file locale est vide, et détecte la fin
+// (processus 0) quand toutes les tâches du frontier ont été terminées
+static void progress_loop(int rank, int num_procs, uint64_t total_tasks, uint64_t *steals)
+{
+    uint64_t *completed_by_rank = calloc(num_procs, sizeof(uint64_t));
+    uint64_t last_reported = (uint64_t)-1;
+    double last_report_time = 0.0;
+    double next_steal_time = 0.0;
+    double steal_backoff = 0.0001;
+    int steal_pending = 0;
+    unsigned int seed = (unsigned int)rank * 7919u + 1u;
+
+    while (!__atomic_load_n(&done, __ATOMIC_ACQUIRE))
+    {
+        int flag;
+        MPI_Status status;
+        MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &flag, &status);
+        if (flag)
+        {
+            int bytes;
+            MPI_Get_count(&status, MPI_BYTE, &bytes);
+            if (status.MPI_TAG == TAG_STEAL_REQUEST)
+            {
+                MPI_Recv(NULL, 0, MPI_BYTE, status.MPI_SOURCE, TAG_STEAL_REQUEST, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                Prefix *stolen;
+                const uint64_t count = pool_split(&stolen);
+                send_async(stolen, (int)(count * sizeof(Prefix)), status.MPI_SOURCE, TAG_STEAL_REPLY);
+            }
+            else if (status.MPI_TAG == TAG_STEAL_REPLY)
+            {
+                Prefix *received = malloc(bytes ? bytes : 1);
+                MPI_Recv(received, bytes, MPI_BYTE, status.MPI_SOURCE, TAG_STEAL_REPLY, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                const uint64_t count = bytes / sizeof(Prefix);
+                steal_pending = 0;
+                if (count > 0)
+                {
+                    // Les tâches reçues alimentent directement la file des threads de calcul
+                    pool_push(received, count);
+                    ++*steals;
+                    steal_backoff = 0.0001;
+                }
+                else if (steal_backoff < MAX_STEAL_BACKOFF)
+                {
+                    steal_backoff *= 2;
+                }
+                next_steal_time = MPI_Wtime() + (count > 0 ? 0.0 : steal_backoff);
+                free(received);
+            }
+            else if (status.MPI_TAG == TAG_LOAD_REPORT)
+            {
+                uint64_t report;
+                MPI_Recv(&report, 1, MPI_UINT64_T, status.MPI_SOURCE, TAG_LOAD_REPORT, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                completed_by_rank[status.MPI_SOURCE] = report;
+            }
+            else if (status.MPI_TAG == TAG_DONE)
+            {
+                MPI_Recv(NULL, 0, MPI_BYTE, status.MPI_SOURCE, TAG_DONE, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+            }
+        }
+
+        const double now = MPI_Wtime();
+        const uint64_t completed = __atomic_load_n(&completed_tasks, __ATOMIC_RELAXED);
+
+        // Rapport de charge : nombre cumulé de tâches terminées par ce processus
+        if (rank != 0 && completed != last_reported && now - last_report_time > REPORT_INTERVAL)
+        {
+            uint64_t *report = malloc(sizeof(uint64_t));
+            *report = completed;
+            send_async(report, sizeof(uint64_t), 0, TAG_LOAD_REPORT);
+            last_reported = completed;
+            last_report_time = now;
+        }
+
+        // Détection de la fin par le processus 0
+        if (rank == 0)
+        {
+            completed_by_rank[0] = completed;
+            uint64_t sum = 0;
+            for (int r = 0; r < num_procs; ++r)
+            {
+                sum += completed_by_rank[r];
+            }
+            if (sum == total_tasks)
+            {
+                for (int r = 1; r < num_procs; ++r)
+                {
+                    send_async(NULL, 0, r, TAG_DONE);
+                }
+                __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+            }
+        }
+
+        // Voler du travail à un processus choisi au hasard si la file est vide
+        if (num_procs > 1 && !steal_pending && now >= next_steal_time && pool_size() == 0)
+        {
+            int victim = rand_r(&seed) % (num_procs - 1);
+            if (victim >= rank)
+            {
+                ++victim;
+            }
+            send_async(NULL, 0, victim, TAG_STEAL_REQUEST);
+            steal_pending = 1;
+        }
+
+        progress_sends();
+        if (!flag)
+        {
+            sched_yield();
+        }
+    }
+
+    // Terminer nos envois puis attendre que tous les processus aient fait de
+    // même, en consommant les messages encore en transit
+    while (!progress_sends())
+    {
+        discard_messages();
+    }
+    MPI_Request barrier;
+    int finished = 0;
+    MPI_Ibarrier(MPI_COMM_WORLD, &barrier);
+    while (!finished)
+    {
+        discard_messages();
+        MPI_Test(&barrier, &finished, MPI_STATUS_IGNORE);
+    }
+    free(completed_by_rank);
+}
+
+// Boucle d'un thread de calcul : dépiler et explorer les tâches jusqu'à la fin
+static void compute_loop(uint32_t depth, struct chess_board *board, WORKER_STATS *stats)
+{
+    Prefix task;
+    double wait_start = telemetry_now();
+    while (1)
+    {
+        if (pool_pop(&task))
+        {
+            const double task_start = telemetry_now();
+            const uint64_t placements = board->placements;
+            telemetry_idle(stats, task_start - wait_start);
+            nq_half_board_solve(NQ_KERNEL_BITBOARD, task.rows, depth, board);
+            wait_start = telemetry_now();
+            telemetry_task_done(stats, board->placements - placements, wait_start - task_start);
+            __atomic_fetch_add(&completed_tasks, 1, __ATOMIC_RELAXED);
+        }
+        else if (__atomic_load_n(&done, __ATOMIC_ACQUIRE))
+        {
+            telemetry_idle(stats, telemetry_now() - wait_start);
+            break;
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t default_n = 4;
+    int num_procs = 2;
+    int rank;
+    int provided;
+
+    const uint32_t n_queens = (argc > 1) ? (uint32_t)atoi(argv[1]) : default_n;
+    nthreads = (argc > 2) ? atoi(argv[2]) : nthreads;
+    // Un thread de progression plus au moins un thread de calcul
+    if (nthreads < 2)
+    {
+        nthreads = 2;
+    }
+
+    // Seul le thread maître (thread 0) appelle MPI : FUNNELED suffit
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    if (provided < MPI_THREAD_FUNNELED)
+    {
+        fprintf(stderr, "The MPI library does not provide the required thread support.\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    // Les processus d'un même noeud reçoivent des plages de CPU disjointes
+    MPI_Comm node_comm;
+    int node_rank;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+    MPI_Comm_rank(node_comm, &node_rank);
+    MPI_Comm_free(&node_comm);
+    placement_init(PLACEMENT_NONE);
+    const uint32_t worker_offset = placement_first_worker(node_rank, nthreads);
+
+    double start_time = MPI_Wtime();
+
+    // Frontier déterministe, assez fin pour que le vol de travail ait de quoi
+    // équilibrer ; chaque processus prend une part cyclique des préfixes
+    const uint64_t target = (uint64_t)PREFIXES_PER_WORKER * num_procs * (nthreads - 1);
+    uint32_t *rows = NULL;
+    uint64_t frontier_count = 0, capacity = 0;
+    uint32_t depth = 0;
+    struct chess_board *board;
+    initialize_board(n_queens, &board, 0, 0);
+    while (frontier_count < target && depth < MAX_DEPTH && depth < n_queens)
+    {
+        ++depth;
+        frontier_count = 0;
+        nq_half_board_expand(board, depth, MAX_DEPTH, &rows, &frontier_count, &capacity);
+    }
+    smash_board(board);
+    Prefix *frontier = (Prefix *)rows;
+
+    pool.tasks = NULL;
+    pool.count = 0;
+    pool.capacity = 0;
+    omp_init_lock(&pool.lock);
+    for (uint64_t i = rank; i < frontier_count; i += num_procs)
+    {
+        pool_push(&frontier[i], 1);
+    }
+    free(frontier);
+
+    uint64_t total_solutions = 0;
+    uint64_t steals = 0;
+    // Compteurs de chaque thread de calcul (le thread 0 ne fait que la
+    // progression), rassemblés tels quels sur le processus 0
+    const int workers = nthreads - 1;
+    WORKER_STATS *thread_stats = calloc(workers, sizeof(WORKER_STATS));
+    WORKER_STATS rank_stats;
+    telemetry_reset(&rank_stats);
+    #pragma omp parallel num_threads(nthreads) reduction(+ : total_solutions)
+    {
+        // Placer le thread (de progression ou de calcul) avant toute allocation
+        placement_bind_worker(worker_offset + omp_get_thread_num());
+
+        if (omp_get_thread_num() == 0)
+        {
+            progress_loop(rank, num_procs, frontier_count, &steals);
+        }
+        else
+        {
+            struct chess_board *local_board;
+            WORKER_STATS stats;
+            telemetry_reset(&stats);
+            initialize_board(n_queens, &local_board, 0, 0);
+            compute_loop(depth, local_board, &stats);
+            thread_stats[omp_get_thread_num() - 1] = stats;
+            total_solutions += local_board->solutions;
+            smash_board(local_board);
+        }
+    }
+    omp_destroy_lock(&pool.lock);
+    free(pool.tasks);
+    free(pending);
+
+    uint64_t totalS = 0;
+    MPI_Reduce(&total_solutions, &totalS, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+    rank_stats.steals = steals;
+    // Rassembler les compteurs de charge des processus avec la réduction
+    for (int t = 0; t < workers; ++t)
+    {
+        telemetry_merge(&rank_stats, &thread_stats[t]);
+    }
+    WORKER_STATS *all_stats = rank == 0 ? malloc(sizeof(WORKER_STATS) * num_procs) : NULL;
+    MPI_Gather(&rank_stats, sizeof(WORKER_STATS), MPI_BYTE, all_stats, sizeof(WORKER_STATS), MPI_BYTE, 0, MPI_COMM_WORLD);
+    WORKER_STATS *all_threads = rank == 0 ? malloc(sizeof(WORKER_STATS) * num_procs * workers) : NULL;
+    MPI_Gather(thread_stats, workers * sizeof(WORKER_STATS), MPI_BYTE, all_threads, workers * sizeof(WORKER_STATS),
+               MPI_BYTE, 0, MPI_COMM_WORLD);
+    free(thread_stats);
+    // Print the total number of solutions from the root process
+    if (rank == 0)
+    {
+        // The next line fixes double-counting when solving the 1-queen problem
+        if (n_queens == 1)
+        {
+            totalS = 1;
+        }
+        double end_time = MPI_Wtime();
+        printf("program takes : %f s \n", end_time - start_time);
+        printf("The %u-Queens problem has %lu solutions\n", n_queens, totalS);
+        placement_report(nthreads);
+        telemetry_report("rank", all_stats, num_procs);
+        telemetry_report("thread", all_threads, num_procs * workers);
+        free(all_stats);
+        free(all_threads);
+    }
+
+    // Clean up the MPI environment
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,177 @@
+// N-Queens backend differential check
+//
+// Purpose:
+//   Counts every N of a range with each backend of common/n_queens_solver
+//   (sequential, pthread, openmp, mpi, and hybrid: the mpi backend with a pool
+//   of threads on each rank) and with the half-board prefixes of
+//   common/n_queens_core that the MPI and hybrid programs distribute, and
+//   compares each count with nq_count. Prints one line per N and flags every
+//   count that differs; the exit status is non-zero if any does. Backends
+//   left out of the build (no -fopenmp, no -DNQ_WITH_MPI) are shown as "-".
+// Arguments: [first N] [last N] [threads]
+// Compilation and Execution:
+//   $ gcc -O2 -fopenmp n_queens_backends.c common/n_queens_solver.c common/n_queens_checkpoint.c common/n_queens_frontier.c common/n_queens_core.c common/n_queens_estimator.c common/n_queens_memo.c common/n_queens_store.c common/n_queens_task_pool.c -lpthread -o n_queens_backends
+//   $ ./n_queens_backends 1 12 4
+//   With the mpi and hybrid backends:
+//   $ mpicc -O2 -fopenmp -DNQ_WITH_MPI n_queens_backends.c common/n_queens_solver.c common/n_queens_checkpoint.c common/n_queens_frontier.c common/n_queens_core.c common/n_queens_estimator.c common/n_queens_memo.c common/n_queens_store.c common/n_queens_task_pool.c -lpthread -o n_queens_backends
+//   $ mpirun -np 3 ./n_queens_backends 1 12 2
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "common/n_queens_core.h"
+#include "common/n_queens_solver.h"
+
+// Depths of the half-board prefixes checked, as the programs choose them
+#define PREFIX_DEPTHS 3
+static const uint32_t prefix_depths[PREFIX_DEPTHS] = {1, 2, 5};
+
+#define BACKENDS 5
+static const char *names[BACKENDS] = {"sequential", "pthread", "openmp", "mpi", "hybrid"};
+
+// Count with one backend; 0 when it is not in this build
+static int solve_backend(int backend, uint32_t n_queens, uint32_t threads, NQ_WORKERS *workers,
+                         uint64_t *solutions)
+{
+    NQ_CONFIG config;
+    NQ_RESULT result;
+    nq_config_default(&config, n_queens);
+    config.threads = threads;
+    switch (backend)
+    {
+    case 0:
+        config.backend = NQ_BACKEND_SEQUENTIAL;
+        break;
+    case 1:
+        config.backend = NQ_BACKEND_PTHREAD;
+        break;
+    case 2:
+#ifndef _OPENMP
+        return 0;
+#endif
+        config.backend = NQ_BACKEND_OPENMP;
+        break;
+    default:
+#ifndef NQ_WITH_MPI
+        return 0;
+#endif
+        config.backend = NQ_BACKEND_MPI;
+        // mpi: one search per rank; hybrid: the ranks share out their prefixes to a thread pool
+        if (backend == 3)
+        {
+            workers = NULL;
+        }
+        break;
+    }
+    if (nq_solve(&config, workers, &result) != 0)
+    {
+        fprintf(stderr, "N = %u : the %s count failed.\n", n_queens, names[backend]);
+        exit(EXIT_FAILURE);
+    }
+    *solutions = result.solutions;
+    return 1;
+}
+
+// Count through the half-board prefixes of `depth` columns
+static uint64_t solve_prefixes(uint32_t n_queens, uint32_t depth)
+{
+    uint32_t *prefixes = NULL;
+    uint64_t count = 0, capacity = 0;
+    CHESS_BOARD *board;
+    initialize_board(n_queens, &board, 0, 0);
+    nq_half_board_expand(board, depth, depth, &prefixes, &count, &capacity);
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        nq_half_board_solve(NQ_KERNEL_BITBOARD, &prefixes[i * depth], depth, board);
+    }
+    // the middle queen of N = 1 has no mirror image
+    const uint64_t solutions = n_queens == 1 ? board->solutions / 2 : board->solutions;
+    smash_board(board);
+    free(prefixes);
+    return solutions;
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t default_first = 1, default_last = 12;
+    const uint32_t first_n = (argc > 1) ? (uint32_t)atoi(argv[1]) : default_first;
+    const uint32_t last_n = (argc > 2) ? (uint32_t)atoi(argv[2]) : default_last;
+    const uint32_t threads = (argc > 3) ? (uint32_t)atoi(argv[3]) : 2;
+    int rank = 0;
+#ifdef NQ_WITH_MPI
+    int provided;
+    // the hybrid backend calls MPI from the thread of nq_solve only
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+    if (first_n < 1 || last_n > NQ_CORE_MAX_N || first_n > last_n)
+    {
+        fprintf(stderr, "The number of queens must be between 1 and %d.\n", NQ_CORE_MAX_N);
+        return EXIT_FAILURE;
+    }
+
+    NQ_WORKERS *workers = nq_workers_create(threads);
+    int mismatches = 0;
+    if (rank == 0)
+    {
+        printf("%2s %10s", "N", "nq_count");
+        for (int backend = 0; backend < BACKENDS; ++backend)
+        {
+            printf(" %11s", names[backend]);
+        }
+        for (int d = 0; d < PREFIX_DEPTHS; ++d)
+        {
+            printf("  prefixes d=%u", prefix_depths[d]);
+        }
+        printf("\n");
+    }
+    for (uint32_t n = first_n; n <= last_n; ++n)
+    {
+        uint64_t placements = 0;
+        const uint64_t reference = nq_count(NQ_KERNEL_BITBOARD, n, &placements);
+        if (rank == 0)
+        {
+            printf("%2u %10" PRIu64, n, reference);
+        }
+        for (int backend = 0; backend < BACKENDS; ++backend)
+        {
+            uint64_t solutions;
+            // every rank takes part in the mpi counts
+            if (!solve_backend(backend, n, threads, workers, &solutions))
+            {
+                if (rank == 0)
+                {
+                    printf(" %11s", "-");
+                }
+                continue;
+            }
+            mismatches += solutions != reference;
+            if (rank == 0)
+            {
+                printf(" %10" PRIu64 "%c", solutions, solutions != reference ? '!' : ' ');
+            }
+        }
+        for (int d = 0; d < PREFIX_DEPTHS; ++d)
+        {
+            const uint64_t solutions = solve_prefixes(n, prefix_depths[d]);
+            mismatches += solutions != reference;
+            if (rank == 0)
+            {
+                printf(" %12" PRIu64 "%c", solutions, solutions != reference ? '!' : ' ');
+            }
+        }
+        if (rank == 0)
+        {
+            printf("\n");
+        }
+    }
+    nq_workers_destroy(workers);
+    if (rank == 0)
+    {
+        printf("%d mismatch%s\n", mismatches, mismatches == 1 ? "" : "es");
+    }
+#ifdef NQ_WITH_MPI
+    MPI_Finalize();
+#endif
+    return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,191 @@
+// N-Queens count with checkpoint/restart
+//
+// Purpose:
+//   Counts the N-Queens solutions with one backend of common/n_queens_solver
+//   while every finished prefix is appended to a journal (common/n_queens_checkpoint),
+//   written to disk at least every `interval` seconds. On SIGTERM or SIGINT
+//   the running prefixes are finished, the journal is flushed and the program
+//   exits with status 2; running it again with `resume` skips the prefixes
+//   already counted. Each MPI rank writes its own journal `<journal>.<rank>`,
+//   and a resumed run reads them all, whatever its number of ranks. `check`
+//   simulates two crashes in a row: it counts with a new journal, cuts it in
+//   the middle of a record, resumes, cuts it again, resumes again, and compares
+//   both totals with nq_count.
+// Arguments: N backend journal [resume|new|check] [depth] [interval]
+// Compilation and Execution:
+//   $ gcc -O2 -fopenmp n_queens_checkpointed_count.c common/n_queens_solver.c common/n_queens_checkpoint.c common/n_queens_frontier.c common/n_queens_core.c common/n_queens_estimator.c common/n_queens_memo.c common/n_queens_store.c common/n_queens_task_pool.c -lpthread -o n_queens_checkpointed_count
+//   $ ./n_queens_checkpointed_count 17 pthread run17 new 4 10
+//   $ ./n_queens_checkpointed_count 17 pthread run17 resume
+//   With the MPI backend:
+//   $ mpicc -O2 -fopenmp -DNQ_WITH_MPI n_queens_checkpointed_count.c common/n_queens_solver.c common/n_queens_checkpoint.c common/n_queens_frontier.c common/n_queens_core.c common/n_queens_estimator.c common/n_queens_memo.c common/n_queens_store.c common/n_queens_task_pool.c -lpthread -o n_queens_checkpointed_count
+//   $ mpirun -np 4 ./n_queens_checkpointed_count 18 mpi run18 new 5
+//   $ mpirun -np 2 ./n_queens_checkpointed_count 18 mpi run18 resume
+//   $ mpirun -np 2 ./n_queens_checkpointed_count 15 mpi check15 check 5
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "common/n_queens_core.h"
+#include "common/n_queens_solver.h"
+
+#define EXIT_INTERRUPTED 2
+// `check` crashes and resumes this many times
+#define CHECK_CRASHES 2
+
+// Count once with the journal of this rank, new or resumed, as main does
+static int count(uint32_t n_queens, NQ_BACKEND backend, const char *journal, int rank, int resume,
+                 uint32_t depth, NQ_RESULT *result)
+{
+    // no periodic flush: closing the journal writes it whole
+    NQ_CHECKPOINT *checkpoint = nq_checkpoint_open(journal, rank, resume, 1e9);
+    if (checkpoint == NULL)
+    {
+        return -1;
+    }
+    NQ_CONFIG config;
+    nq_config_default(&config, n_queens);
+    config.backend = backend;
+    config.depth = depth;
+    config.checkpoint = checkpoint;
+    const int status = nq_solve(&config, NULL, result);
+    nq_checkpoint_close(checkpoint);
+    return status;
+}
+
+// Cut the journal of this rank in the middle of a record, as a crash while
+// writing it would: the `cut`-th cut keeps cut / (cut + 1) of its records, so
+// that the second one falls among the records appended after the first, then
+// the prefix number of the next record
+static int cut_journal(const char *journal, int rank, int cut)
+{
+    char path[4096];
+    snprintf(path, sizeof(path), "%s.%d", journal, rank);
+    struct stat st;
+    if (stat(path, &st) != 0 || (uint64_t)st.st_size < sizeof(NQ_CHECKPOINT_HEADER))
+    {
+        perror("Failed to cut the checkpoint journal");
+        return 0;
+    }
+    const uint64_t records = ((uint64_t)st.st_size - sizeof(NQ_CHECKPOINT_HEADER)) / sizeof(NQ_CHECKPOINT_RECORD);
+    const uint64_t size = sizeof(NQ_CHECKPOINT_HEADER) +
+                          records * (uint64_t)cut / (uint64_t)(cut + 1) * sizeof(NQ_CHECKPOINT_RECORD) +
+                          sizeof(uint64_t);
+    if (size < (uint64_t)st.st_size && truncate(path, (off_t)size) != 0)
+    {
+        perror("Failed to cut the checkpoint journal");
+        return 0;
+    }
+    return 1;
+}
+
+// Count, then crash and resume CHECK_CRASHES times; 0 if every total is nq_count
+static int check(uint32_t n_queens, NQ_BACKEND backend, const char *journal, int rank, uint32_t depth)
+{
+    uint64_t placements = 0;
+    const uint64_t reference = nq_count(NQ_KERNEL_BITBOARD, n_queens, &placements);
+    int failures = 0;
+    for (int run = 0; run <= CHECK_CRASHES; ++run)
+    {
+        NQ_RESULT result;
+        if (run > 0 && !cut_journal(journal, rank, run))
+        {
+            return -1;
+        }
+#ifdef NQ_WITH_MPI
+        // no rank may read the journals before every one is cut
+        MPI_Barrier(MPI_COMM_WORLD);
+#endif
+        if (count(n_queens, backend, journal, rank, run > 0, depth, &result) != 0)
+        {
+            return -1;
+        }
+        failures += result.solutions != reference;
+        if (rank == 0)
+        {
+            printf("%s: N = %u : %" PRIu64 " solutions (%" PRIu64 " prefixes resumed) %s\n",
+                   run == 0 ? "new" : "resumed after a cut record", n_queens, result.solutions, result.reused,
+                   result.solutions == reference ? "ok" : "MISMATCH");
+        }
+    }
+    return failures;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 4)
+    {
+        fprintf(stderr, "Usage: %s N backend journal [resume|new|check] [depth] [interval]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const uint32_t n_queens = (uint32_t)atoi(argv[1]);
+    const NQ_BACKEND backend = nq_backend_from_string(argv[2]);
+    if (backend == NQ_BACKEND_UNKNOWN)
+    {
+        fprintf(stderr, "Usage: %s N backend journal [resume|new|check] [depth] [interval]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char *journal = argv[3];
+    const int resume = argc > 4 && strcmp(argv[4], "resume") == 0;
+    const uint32_t depth = (argc > 5) ? (uint32_t)atoi(argv[5]) : 0;
+    const double interval = (argc > 6) ? atof(argv[6]) : 30.0;
+    int rank = 0;
+#ifdef NQ_WITH_MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+    if (argc > 4 && strcmp(argv[4], "check") == 0)
+    {
+        const int failures = check(n_queens, backend, journal, rank, depth);
+        if (failures < 0)
+        {
+#ifdef NQ_WITH_MPI
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+#endif
+            return EXIT_FAILURE;
+        }
+#ifdef NQ_WITH_MPI
+        MPI_Finalize();
+#endif
+        return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    NQ_CHECKPOINT *checkpoint = nq_checkpoint_open(journal, rank, resume, interval);
+    if (checkpoint == NULL)
+    {
+#ifdef NQ_WITH_MPI
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+#endif
+        return EXIT_FAILURE;
+    }
+    nq_checkpoint_handle_signals();
+
+    NQ_CONFIG config;
+    NQ_RESULT result;
+    nq_config_default(&config, n_queens);
+    config.backend = backend;
+    config.depth = depth;
+    config.checkpoint = checkpoint;
+    const int status = nq_solve(&config, NULL, &result);
+    const uint64_t recorded = checkpoint->recorded;
+    nq_checkpoint_close(checkpoint);
+
+    if (status >= 0 && rank == 0)
+    {
+        printf("N = %u : %" PRIu64 " solutions%s, %" PRIu64 " placements, %" PRIu64 " prefixes (%" PRIu64
+               " resumed, %" PRIu64 " counted by rank 0), %f s\n",
+               n_queens, result.solutions, status == 1 ? " so far" : "", result.placements, result.tasks,
+               result.reused, recorded, result.seconds);
+        if (status == 1)
+        {
+            printf("Interrupted: resume with %s %u %s %s resume\n", argv[0], n_queens, argv[2], journal);
+        }
+    }
+#ifdef NQ_WITH_MPI
+    MPI_Finalize();
+#endif
+    return status == 0 ? EXIT_SUCCESS : (status == 1 ? EXIT_INTERRUPTED : EXIT_FAILURE);
+}
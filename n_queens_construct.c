@@ -0,0 +1,128 @@
+// N-Queens constructive placement
+//
+// Purpose:
+//   Writes one valid placement of N queens in linear time with the explicit
+//   construction of common/n_queens_placement (cases by N mod 6), for N up to
+//   2^32 - 1, then checks it with the parallel verifier on one thread and on
+//   `threads` threads and prints the time and rate of each step. The
+//   placement (queen_positions layout: the row of each column, from 0) can be
+//   written to a file as raw 32-bit integers in the byte order of the machine.
+//   With N = 0 the construction is checked for every N from 1 to `threads`.
+// Arguments: N [threads] [output file]
+// Compilation and Execution:
+//   $ gcc -O2 -fopenmp n_queens_construct.c common/n_queens_placement.c -o n_queens_construct
+//   $ ./n_queens_construct 100000000 8
+//   $ ./n_queens_construct 1000000 8 placement_1M.bin
+//   $ ./n_queens_construct 0 10000        (every N up to 10000)
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "common/n_queens_placement.h"
+
+// Rows printed at most
+#define PRINT_ROWS 16
+
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+// Every N from 1 to last: a placement when there is one, and a valid one
+static int check_range(uint64_t last)
+{
+    uint32_t *positions = malloc(sizeof(uint32_t) * (last ? last : 1));
+    if (positions == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the placement.\n");
+        return EXIT_FAILURE;
+    }
+    uint64_t failures = 0;
+    for (uint64_t n = 1; n <= last; ++n)
+    {
+        const int built = nq_construct_placement(n, positions, 1);
+        if (built != (n != 2 && n != 3) || (built && !nq_verify_placement(n, positions, 1)))
+        {
+            fprintf(stderr, "N = %" PRIu64 " : wrong placement.\n", n);
+            ++failures;
+        }
+    }
+    free(positions);
+    printf("N = 1 to %" PRIu64 " : %" PRIu64 " wrong placements\n", last, failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s N [threads] [output file]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const uint64_t n_queens = strtoull(argv[1], NULL, 10);
+    const uint32_t threads = (argc > 2) ? (uint32_t)atoi(argv[2]) : 0;
+    const char *output = (argc > 3) ? argv[3] : NULL;
+    if (n_queens == 0)
+    {
+        return check_range(threads);
+    }
+    if (n_queens > UINT32_MAX)
+    {
+        fprintf(stderr, "N must be below 2^32.\n");
+        return EXIT_FAILURE;
+    }
+    uint32_t *positions = malloc(sizeof(uint32_t) * n_queens);
+    if (positions == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the placement.\n");
+        return EXIT_FAILURE;
+    }
+
+    double start = now();
+    if (!nq_construct_placement(n_queens, positions, threads))
+    {
+        printf("N = %" PRIu64 " : no placement exists.\n", n_queens);
+        free(positions);
+        return EXIT_SUCCESS;
+    }
+    const double construct_seconds = now() - start;
+    start = now();
+    const int valid_one = nq_verify_placement(n_queens, positions, 1);
+    const double verify_one_seconds = now() - start;
+    start = now();
+    const int valid = nq_verify_placement(n_queens, positions, threads);
+    const double verify_seconds = now() - start;
+
+    printf("N = %" PRIu64 " : placement built in %f s (%.3e queens/s)\n", n_queens, construct_seconds,
+           n_queens / construct_seconds);
+    printf("  check on 1 thread : %s, %f s (%.3e queens/s)\n", valid_one ? "valid" : "INVALID", verify_one_seconds,
+           n_queens / verify_one_seconds);
+    printf("  check on %s%.0u threads : %s, %f s (%.3e queens/s)\n", threads ? "" : "all", threads,
+           valid ? "valid" : "INVALID", verify_seconds, n_queens / verify_seconds);
+    printf("  rows :");
+    for (uint64_t j = 0; j < n_queens && j < PRINT_ROWS; ++j)
+    {
+        printf(" %u", positions[j]);
+    }
+    printf("%s\n", n_queens > PRINT_ROWS ? " ..." : "");
+
+    int status = (valid && valid_one) ? EXIT_SUCCESS : EXIT_FAILURE;
+    if (output != NULL)
+    {
+        FILE *file = fopen(output, "wb");
+        if (file == NULL || fwrite(positions, sizeof(uint32_t), n_queens, file) != n_queens || fclose(file) != 0)
+        {
+            perror("Failed to write the placement");
+            status = EXIT_FAILURE;
+        }
+        else
+        {
+            printf("  written to %s\n", output);
+        }
+    }
+    free(positions);
+    return status;
+}
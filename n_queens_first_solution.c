@@ -0,0 +1,100 @@
+// N-Queens first solutions
+//
+// Purpose:
+//   Finds one placement, or the first k distinct placements, of N queens
+//   with the portfolio search of common/n_queens_first: every worker walks
+//   the whole tree in its own row order and the first ones to find enough
+//   solutions stop the others. Prints the time to the first solution, the
+//   total time, the worker that found it and the placements of all workers,
+//   then checks every placement and prints the first one (queen_positions:
+//   the row of the queen of each column).
+// Arguments: N backend [k] [threads] [seed]
+// Compilation and Execution:
+//   $ gcc -O2 -fopenmp n_queens_first_solution.c common/n_queens_first.c common/n_queens_placement.c common/n_queens_solver.c common/n_queens_checkpoint.c common/n_queens_frontier.c common/n_queens_core.c common/n_queens_estimator.c common/n_queens_memo.c common/n_queens_store.c common/n_queens_task_pool.c -lpthread -o n_queens_first_solution
+//   $ ./n_queens_first_solution 40 pthread 1 8
+//   $ OMP_CANCELLATION=true ./n_queens_first_solution 40 openmp 10 8
+//   With the MPI backend (one search per rank):
+//   $ mpicc -O2 -fopenmp -DNQ_WITH_MPI n_queens_first_solution.c common/n_queens_first.c common/n_queens_placement.c common/n_queens_solver.c common/n_queens_checkpoint.c common/n_queens_frontier.c common/n_queens_core.c common/n_queens_estimator.c common/n_queens_memo.c common/n_queens_store.c common/n_queens_task_pool.c -lpthread -o n_queens_first_solution
+//   $ mpirun -np 8 ./n_queens_first_solution 40 mpi
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common/n_queens_first.h"
+#include "common/n_queens_placement.h"
+
+// Rows of the first solution printed at most
+#define PRINT_ROWS 64
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "Usage: %s N backend [k] [threads] [seed]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    NQ_FIRST_CONFIG config;
+    nq_first_config_default(&config, (uint32_t)atoi(argv[1]));
+    config.backend = nq_backend_from_string(argv[2]);
+    if (config.backend == NQ_BACKEND_UNKNOWN)
+    {
+        fprintf(stderr, "Usage: %s N backend [k] [threads] [seed]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc > 3)
+    {
+        config.k = (uint32_t)atoi(argv[3]);
+    }
+    config.threads = (argc > 4) ? (uint32_t)atoi(argv[4]) : 0;
+    if (argc > 5)
+    {
+        config.seed = strtoull(argv[5], NULL, 0);
+    }
+    int rank = 0;
+#ifdef NQ_WITH_MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+    NQ_FIRST_RESULT result;
+    int status = nq_first_solve(&config, &result);
+    if (status == 0 && rank == 0)
+    {
+        const uint32_t n = config.n_queens;
+        printf("N = %u : %u of %u solutions%s, first after %f s (worker %d), %f s in all, %" PRIu64
+               " placements\n",
+               n, result.found, config.k, result.exhausted ? " (all there are)" : "", result.first_seconds,
+               result.first_worker, result.seconds, result.placements);
+        for (uint32_t i = 0; i < result.found; ++i)
+        {
+            if (!nq_verify_placement(n, &result.positions[i * n], 1))
+            {
+                fprintf(stderr, "Solution %u is not a valid placement.\n", i);
+                status = -1;
+            }
+            for (uint32_t other = 0; other < i; ++other)
+            {
+                if (memcmp(&result.positions[i * n], &result.positions[other * n], sizeof(uint32_t) * n) == 0)
+                {
+                    fprintf(stderr, "Solutions %u and %u are the same.\n", other, i);
+                    status = -1;
+                }
+            }
+        }
+        if (result.found > 0)
+        {
+            printf("first solution :");
+            for (uint32_t j = 0; j < n && j < PRINT_ROWS; ++j)
+            {
+                printf(" %u", result.positions[j]);
+            }
+            printf("%s\n", n > PRINT_ROWS ? " ..." : "");
+        }
+    }
+    nq_first_result_free(&result);
+#ifdef NQ_WITH_MPI
+    MPI_Finalize();
+#endif
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
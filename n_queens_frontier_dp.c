@@ -0,0 +1,76 @@
+// N-Queens frontier dynamic programming
+//
+// Purpose:
+//   Counts the N-Queens solutions with the frontier DP of common/n_queens_dp
+//   (all the columns, then two half boards joined) and with the bitboard
+//   backtracking kernel, and prints the time, the operations and the number of
+//   states of each, flagging any count that disagrees with backtracking.
+//   The optional memory budget (MB) bounds the state table; with a spill
+//   directory the columns that do not fit are merged on disk.
+// Compilation and Execution:
+//   $ gcc -O3 n_queens_frontier_dp.c common/n_queens_dp.c common/n_queens_core.c -o n_queens_frontier_dp
+//   $ ./n_queens_frontier_dp 4 14
+//   $ ./n_queens_frontier_dp 14 14 64 /tmp        (64 MB budget, spill to /tmp)
+//   $ ./n_queens_frontier_dp 15 15 16 /tmp 64     (64 spill partitions)
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "common/n_queens_core.h"
+#include "common/n_queens_dp.h"
+
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t default_n = 12;
+    const uint32_t first_n = (argc > 1) ? (uint32_t)atoi(argv[1]) : default_n;
+    const uint32_t last_n = (argc > 2) ? (uint32_t)atoi(argv[2]) : first_n;
+    NQ_DP_OPTIONS options;
+    nq_dp_options_default(&options);
+    options.memory_budget = (argc > 3) ? (uint64_t)atoll(argv[3]) << 20 : 0;
+    options.spill_dir = (argc > 4) ? argv[4] : NULL;
+    options.partitions = (argc > 5) ? (uint32_t)atoi(argv[5]) : NQ_DP_DEFAULT_PARTITIONS;
+    int mismatches = 0;
+
+    if (first_n < 1 || last_n > NQ_DP_MAX_N || first_n > last_n)
+    {
+        fprintf(stderr, "The number of queens must be between 1 and %d.\n", NQ_DP_MAX_N);
+        return EXIT_FAILURE;
+    }
+    for (uint32_t n = first_n; n <= last_n; ++n)
+    {
+        uint64_t placements = 0;
+        double start_time = now();
+        const uint64_t reference = nq_count(NQ_KERNEL_BITBOARD, n, &placements);
+        double seconds = now() - start_time;
+        printf("N = %2u  backtrack : %" PRIu64 " solutions, %f s, %" PRIu64 " placements\n",
+               n, reference, seconds, placements);
+
+        NQ_DP_STATS stats;
+        start_time = now();
+        uint64_t solutions = nq_dp_count(n, &options, &stats);
+        seconds = now() - start_time;
+        mismatches += solutions != reference;
+        printf("N = %2u  frontier  : %" PRIu64 " solutions, %f s, %" PRIu64 " transitions, %" PRIu64
+               " peak states, %u columns spilled%s\n",
+               n, solutions, seconds, stats.transitions, stats.peak_states, stats.spilled_columns,
+               solutions != reference ? "  <- MISMATCH" : "");
+
+        start_time = now();
+        solutions = nq_dp_count_join(n, &options, &stats);
+        seconds = now() - start_time;
+        mismatches += solutions != reference;
+        printf("N = %2u  join      : %" PRIu64 " solutions, %f s, %" PRIu64 " transitions + %" PRIu64
+               " pairs, %" PRIu64 " peak states, %u columns spilled%s\n",
+               n, solutions, seconds, stats.transitions, stats.join_pairs, stats.peak_states,
+               stats.spilled_columns, solutions != reference ? "  <- MISMATCH" : "");
+    }
+    return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
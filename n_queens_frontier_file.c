@@ -0,0 +1,128 @@
+// N-Queens frontier files
+//
+// Purpose:
+//   Writes the depth-d prefix frontier of N (common/n_queens_frontier) to a
+//   binary file once, with the estimated subtree size of each prefix if asked,
+//   so that the runs and ranks that use it map it instead of computing it
+//   (n_queens_sharded_count --frontier). The frontier and the weights are
+//   computed on `threads` threads (0: one per CPU). `info` prints the header
+//   of a file and its first prefixes. `bench` times the single-threaded
+//   streaming generator against the breadth-first parallel build on 1, 2, 4,
+//   ... threads and checks that they give the same prefixes.
+// Compilation and Execution:
+//   $ gcc -O2 n_queens_frontier_file.c common/n_queens_frontier.c common/n_queens_core.c common/n_queens_estimator.c -lpthread -o n_queens_frontier_file
+//   $ ./n_queens_frontier_file write 18 5 f18_5.nqf weights 8
+//   $ ./n_queens_frontier_file info f18_5.nqf
+//   $ ./n_queens_frontier_file bench 20 6 16
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "common/n_queens_frontier.h"
+
+#define SHOWN_PREFIXES 4
+
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+static int info(const char *path)
+{
+    NQ_FRONTIER_FILE *file = nq_frontier_map(path);
+    if (file == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+    const NQ_FRONTIER_HEADER *header = file->header;
+    printf("%s : version %u, N = %u, depth %u, %s board, %" PRIu64 " prefixes of %u bytes%s, %" PRIu64
+           " placements to build\n",
+           path, header->version, header->n_queens, header->depth,
+           header->symmetry == NQ_SYMMETRY_HALF ? "half" : "whole", header->count, header->record_size,
+           (header->flags & NQ_FRONTIER_WEIGHTS) ? " with weights" : "", header->placements);
+    for (uint64_t i = 0; i < header->count && i < SHOWN_PREFIXES; ++i)
+    {
+        NQ_PREFIX prefix;
+        nq_frontier_get(file, i, &prefix);
+        printf("  %" PRIu64 " :", i);
+        for (uint32_t j = 0; j < prefix.depth; ++j)
+        {
+            printf(" %u", prefix.rows[j]);
+        }
+        printf("  (weight %.0f)\n", nq_frontier_weight(file, i));
+    }
+    nq_frontier_unmap(file);
+    return EXIT_SUCCESS;
+}
+
+static int bench(uint32_t n_queens, uint32_t depth, uint32_t max_threads)
+{
+    NQ_PREFIX_STREAM stream;
+    NQ_PREFIX prefix;
+    double start = now();
+    nq_stream_init(&stream, n_queens, depth);
+    uint64_t signature = 0;
+    while (nq_stream_next(&stream, &prefix))
+    {
+        uint64_t rows = 0;
+        for (uint32_t j = 0; j < depth; ++j)
+        {
+            rows |= (uint64_t)prefix.rows[j] << (5 * j);
+        }
+        signature = (signature ^ rows) * 0x100000001B3ULL;
+    }
+    printf("stream       : %" PRIu64 " prefixes in %f s\n", stream.next_index, now() - start);
+    nq_stream_destroy(&stream);
+
+    int same = 1;
+    for (uint32_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        NQ_FRONTIER_ARRAY array;
+        start = now();
+        nq_frontier_build(&array, n_queens, depth, threads);
+        const double seconds = now() - start;
+        uint64_t check = 0;
+        for (uint64_t i = 0; i < array.count; ++i)
+        {
+            check = (check ^ array.entries[i].rows) * 0x100000001B3ULL;
+        }
+        printf("%2u thread(s) : %" PRIu64 " prefixes in %f s%s\n", threads, array.count, seconds,
+               check == signature ? "" : "  (MISMATCH)");
+        same = same && check == signature;
+        nq_frontier_array_free(&array);
+    }
+    return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc == 3 && strcmp(argv[1], "info") == 0)
+    {
+        return info(argv[2]);
+    }
+    if (argc >= 4 && strcmp(argv[1], "bench") == 0)
+    {
+        return bench((uint32_t)atoi(argv[2]), (uint32_t)atoi(argv[3]), (argc > 4) ? (uint32_t)atoi(argv[4]) : 8);
+    }
+    if (argc < 5 || strcmp(argv[1], "write") != 0)
+    {
+        fprintf(stderr, "Usage: %s write N depth file [weights|none] [threads] | %s info file | %s bench N depth [threads]\n",
+                argv[0], argv[0], argv[0]);
+        return EXIT_FAILURE;
+    }
+    const uint32_t n_queens = (uint32_t)atoi(argv[2]);
+    const uint32_t depth = (uint32_t)atoi(argv[3]);
+    const int weights = argc > 5 && strcmp(argv[5], "weights") == 0;
+    const uint32_t threads = (argc > 6) ? (uint32_t)atoi(argv[6]) : 0;
+    const double start = now();
+    if (!nq_frontier_write(argv[4], n_queens, depth, weights, threads))
+    {
+        return EXIT_FAILURE;
+    }
+    printf("written in %f s\n", now() - start);
+    return info(argv[4]);
+}
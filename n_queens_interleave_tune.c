@@ -0,0 +1,96 @@
+// N-Queens interleaved kernel tuning
+//
+// Purpose:
+//   Times the interleaved kernel of common/n_queens_core (K independent
+//   depth-first walks advanced one step each in turn on one core) for K = 1
+//   to the given maximum, against the recursive single-walk bitboard kernel,
+//   and prints the placements per second of each and the best K for this
+//   processor, to be compiled in with -DNQ_INTERLEAVE_WALKS=K. Each time is
+//   the best of `repeats` runs.
+// Arguments: N [max walks] [repeats]
+// Compilation and Execution:
+//   $ gcc -O3 -march=native n_queens_interleave_tune.c common/n_queens_core.c -o n_queens_interleave_tune
+//   $ ./n_queens_interleave_tune 14 16 3
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "common/n_queens_core.h"
+
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[])
+{
+    const uint32_t n_queens = (argc > 1) ? (uint32_t)atoi(argv[1]) : 14;
+    const uint32_t max_walks = (argc > 2) ? (uint32_t)atoi(argv[2]) : 16;
+    const int repeats = (argc > 3) ? atoi(argv[3]) : 3;
+    if (n_queens < 2 || n_queens > NQ_CORE_MAX_N || max_walks < 1 || max_walks > NQ_INTERLEAVE_MAX_WALKS ||
+        repeats < 1)
+    {
+        fprintf(stderr, "Usage: %s N (2 to %d) [max walks (1 to %d)] [repeats]\n", argv[0], NQ_CORE_MAX_N,
+                NQ_INTERLEAVE_MAX_WALKS);
+        return EXIT_FAILURE;
+    }
+    uint32_t prefixes[NQ_CORE_MAX_N * NQ_CORE_MAX_N][2];
+    uint64_t prefix_placements = 0;
+    const uint64_t count = nq_half_board_prefixes(n_queens, prefixes, &prefix_placements);
+
+    // the single walk: the recursive bitboard kernel
+    uint64_t reference = 0, reference_placements = 0;
+    double reference_seconds = 0.0;
+    for (int r = 0; r < repeats; ++r)
+    {
+        reference_placements = 0;
+        const double start = now();
+        reference = nq_count_prefixes(NQ_KERNEL_BITBOARD, n_queens, &prefixes[0][0], 2, count, 2,
+                                      &reference_placements);
+        const double seconds = now() - start;
+        reference_seconds = (r == 0 || seconds < reference_seconds) ? seconds : reference_seconds;
+    }
+    printf("N = %u, %" PRIu64 " prefixes, %" PRIu64 " placements, best of %d runs\n", n_queens, count,
+           reference_placements, repeats);
+    printf("  recursive : %f s, %.3e placements/s\n", reference_seconds, reference_placements / reference_seconds);
+
+    uint32_t best_walks = 0;
+    double best_seconds = 0.0;
+    int mismatches = 0;
+    for (uint32_t walks = 1; walks <= max_walks; ++walks)
+    {
+        double walk_seconds = 0.0;
+        for (int r = 0; r < repeats; ++r)
+        {
+            uint64_t placements = 0;
+            const double start = now();
+            const uint64_t solutions =
+                nq_interleaved_prefixes(n_queens, &prefixes[0][0], 2, count, 2, walks, &placements);
+            const double seconds = now() - start;
+            walk_seconds = (r == 0 || seconds < walk_seconds) ? seconds : walk_seconds;
+            if (solutions != reference || placements != reference_placements)
+            {
+                ++mismatches;
+            }
+        }
+        printf("  K = %2u    : %f s, %.3e placements/s, %.2fx the recursive kernel%s\n", walks, walk_seconds,
+               reference_placements / walk_seconds, reference_seconds / walk_seconds,
+               walks == NQ_INTERLEAVE_WALKS ? "  (compiled default)" : "");
+        if (best_walks == 0 || walk_seconds < best_seconds)
+        {
+            best_walks = walks;
+            best_seconds = walk_seconds;
+        }
+    }
+    printf("best K = %u (%.2fx the recursive kernel): -DNQ_INTERLEAVE_WALKS=%u\n", best_walks,
+           reference_seconds / best_seconds, best_walks);
+    if (mismatches)
+    {
+        fprintf(stderr, "%d interleaved counts disagree with the recursive kernel.\n", mismatches);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
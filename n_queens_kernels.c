@@ -0,0 +1,89 @@
+// N-Queens counting kernels
+//
+// Purpose:
+//   Counts the N-Queens solutions with each kernel of common/n_queens_core
+//   (array, bitboard, simd, interleaved) and prints the count, the queen placements and
+//   the time of each, flagging any kernel that disagrees with the others.
+//   The bitboard search is also run with the endgame tables of
+//   common/n_queens_endgame for the last k columns (third argument, 0: off),
+//   cached in the file given as fourth argument.
+// Compilation and Execution:
+//   $ gcc -O3 -march=native n_queens_kernels.c common/n_queens_core.c common/n_queens_endgame.c -o n_queens_kernels
+//   $ ./n_queens_kernels 14          (N = 14 only)
+//   $ ./n_queens_kernels 1 16        (N = 1 to 16)
+//   $ ./n_queens_kernels 16 16 4 endgame4.bin
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "common/n_queens_core.h"
+#include "common/n_queens_endgame.h"
+
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t default_n = 12;
+    const uint32_t first_n = (argc > 1) ? (uint32_t)atoi(argv[1]) : default_n;
+    const uint32_t last_n = (argc > 2) ? (uint32_t)atoi(argv[2]) : first_n;
+    const uint32_t endgame_k = (argc > 3) ? (uint32_t)atoi(argv[3]) : NQ_ENDGAME_DEFAULT_K;
+    const char *endgame_cache = (argc > 4) ? argv[4] : NULL;
+    static const char *names[] = {"array", "bitboard", "simd", "interleaved"};
+    int mismatches = 0;
+
+    if (first_n < 1 || last_n > NQ_CORE_MAX_N || first_n > last_n)
+    {
+        fprintf(stderr, "The number of queens must be between 1 and %d.\n", NQ_CORE_MAX_N);
+        return EXIT_FAILURE;
+    }
+    NQ_ENDGAME *endgame = NULL;
+    if (endgame_k > 0)
+    {
+        const double start_time = now();
+        endgame = nq_endgame_create(endgame_k, endgame_cache);
+        printf("endgame table k = %u : %" PRIu64 " bytes, ready in %f s\n", endgame_k, endgame->size,
+               now() - start_time);
+    }
+    for (uint32_t n = first_n; n <= last_n; ++n)
+    {
+        uint64_t reference = 0;
+        for (int kernel = NQ_KERNEL_ARRAY; kernel <= NQ_KERNEL_INTERLEAVED; ++kernel)
+        {
+            uint64_t placements = 0;
+            const double start_time = now();
+            const uint64_t solutions = nq_count((NQ_KERNEL)kernel, n, &placements);
+            const double seconds = now() - start_time;
+            if (kernel == NQ_KERNEL_ARRAY)
+            {
+                reference = solutions;
+            }
+            const int mismatch = solutions != reference;
+            mismatches += mismatch;
+            printf("N = %2u  %-11s : %" PRIu64 " solutions, %" PRIu64 " placements, %f s (%.3e placements/s)%s\n",
+                   n, names[kernel], solutions, placements, seconds, seconds > 0 ? placements / seconds : 0.0,
+                   mismatch ? "  <- MISMATCH" : "");
+        }
+        if (endgame != NULL)
+        {
+            uint64_t placements = 0;
+            const double start_time = now();
+            const uint64_t solutions = nq_endgame_count(endgame, n, &placements);
+            const double seconds = now() - start_time;
+            const int mismatch = solutions != reference;
+            mismatches += mismatch;
+            printf("N = %2u  endgame%u : %" PRIu64 " solutions, %" PRIu64 " placements, %f s%s\n",
+                   n, endgame_k, solutions, placements, seconds, mismatch ? "  <- MISMATCH" : "");
+        }
+    }
+    if (endgame != NULL)
+    {
+        nq_endgame_destroy(endgame);
+    }
+    return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,67 @@
+// N-Queens min-conflicts local search
+//
+// Purpose:
+//   Produces distinct placements of N queens with the parallel min-conflicts
+//   search of common/n_queens_local (one independent search per thread, each
+//   with its own seed) for each N of a comma-separated list, and prints the
+//   distinct solutions per second, the duplicates, the repair steps per
+//   solution and the restarts. Every solution is checked with the verifier
+//   of common/n_queens_placement. Each N runs for `seconds` or until
+//   `target` distinct solutions (0: no target).
+// Arguments: N[,N...] [threads] [seconds] [target]
+// Compilation and Execution:
+//   $ gcc -O2 n_queens_min_conflicts.c common/n_queens_local.c common/n_queens_placement.c -lpthread -o n_queens_min_conflicts
+//   $ ./n_queens_min_conflicts 100,1000,10000 8 5
+//   $ ./n_queens_min_conflicts 1000000 8 0 1
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common/n_queens_local.h"
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s N[,N...] [threads] [seconds] [target]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    char *list = strdup(argv[1]);
+    const uint32_t threads = (argc > 2) ? (uint32_t)atoi(argv[2]) : 0;
+    const double seconds = (argc > 3) ? atof(argv[3]) : 5.0;
+    const uint64_t target = (argc > 4) ? strtoull(argv[4], NULL, 10) : 0;
+    if (list == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the list of N.\n");
+        return EXIT_FAILURE;
+    }
+    int status = EXIT_SUCCESS;
+    printf("%10s %12s %10s %14s %14s %10s %8s\n", "N", "solutions", "duplicates", "solutions/s", "steps/solution",
+           "restarts", "invalid");
+    for (char *item = strtok(list, ","); item != NULL; item = strtok(NULL, ","))
+    {
+        NQ_LOCAL_CONFIG config;
+        nq_local_config_default(&config, (uint32_t)atoi(item));
+        config.threads = threads;
+        config.seconds = seconds;
+        config.target = target;
+        config.keep = 0;
+        NQ_LOCAL_RESULT result;
+        if (nq_local_search(&config, &result) != 0)
+        {
+            status = EXIT_FAILURE;
+            continue;
+        }
+        printf("%10u %12" PRIu64 " %10" PRIu64 " %14.1f %14.1f %10" PRIu64 " %8" PRIu64 "\n", config.n_queens,
+               result.solutions, result.duplicates, result.solutions / result.seconds,
+               result.solutions ? (double)result.steps / result.solutions : 0.0, result.restarts, result.invalid);
+        if (result.invalid)
+        {
+            status = EXIT_FAILURE;
+        }
+        nq_local_result_free(&result);
+    }
+    free(list);
+    return status;
+}
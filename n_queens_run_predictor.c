@@ -0,0 +1,41 @@
+// N-Queens run-time predictor
+//
+// Purpose:
+//   Estimates, before a long count is started, the number of queen placements
+//   of the whole search (Knuth random probing over the half board searched by
+//   the counters) and the time it should take on a given number of cores.
+// Compilation and Execution:
+//   $ gcc -O2 n_queens_run_predictor.c common/n_queens_estimator.c -o n_queens_run_predictor
+//   $ ./n_queens_run_predictor 18 16
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "common/n_queens_estimator.h"
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t default_n = 16;
+    static const uint32_t default_workers = 1;
+    static const uint32_t default_samples = 100000;
+    const uint32_t n_queens = (argc > 1) ? (uint32_t)atoi(argv[1]) : default_n;
+    const uint32_t workers = (argc > 2) ? (uint32_t)atoi(argv[2]) : default_workers;
+    const uint32_t samples = (argc > 3) ? (uint32_t)atoi(argv[3]) : default_samples;
+
+    if (n_queens < 1 || n_queens > 32)
+    {
+        fprintf(stderr, "The number of queens must be between 1 and 32.\n");
+        return EXIT_FAILURE;
+    }
+
+    clock_t start_time = clock();
+    double nodes, rate;
+    const double seconds = estimator_predict_seconds(n_queens, workers, samples, &nodes, &rate);
+    clock_t end_time = clock();
+
+    printf("estimation takes : %f s \n", (double)(end_time - start_time) / CLOCKS_PER_SEC);
+    printf("The %u-Queens problem should require about %.0f queen placements\n", n_queens, nodes);
+    printf("at %.3e placements/s per core, about %.3f s on %u core(s)\n", rate, seconds, workers);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,52 @@
+// N-Queens shard merge
+//
+// Purpose:
+//   Reads the manifests written by n_queens_sharded_count, checks that they
+//   come from the same count (N, depth, frontier fingerprint, number of
+//   shards), that every shard is there exactly once and that their prefix
+//   ranges cover the frontier without gap or overlap, then prints the total.
+//   Exits with a failure status, and no total, otherwise.
+// Compilation and Execution:
+//   $ gcc -O2 n_queens_shard_merge.c common/n_queens_shard.c -o n_queens_shard_merge
+//   $ ./n_queens_shard_merge shard_16_*_of_4.txt
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "common/n_queens_shard.h"
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s manifest...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const uint32_t count = (uint32_t)(argc - 1);
+    NQ_SHARD_MANIFEST *manifests = malloc(sizeof(NQ_SHARD_MANIFEST) * count);
+    if (manifests == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the manifests.\n");
+        return EXIT_FAILURE;
+    }
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (!nq_shard_read(argv[i + 1], &manifests[i]))
+        {
+            free(manifests);
+            return EXIT_FAILURE;
+        }
+    }
+    NQ_SHARD_MANIFEST total;
+    const int merged = nq_shard_merge(manifests, count, &total);
+    free(manifests);
+    if (!merged)
+    {
+        return EXIT_FAILURE;
+    }
+    printf("N = %u : %" PRIu64 " solutions, %" PRIu64 " placements, %u shards of %" PRIu64
+           " prefixes at depth %u, %f s of counting in all\n",
+           total.n_queens, total.solutions, total.placements, total.shards, total.prefixes, total.depth,
+           total.seconds);
+    return EXIT_SUCCESS;
+}
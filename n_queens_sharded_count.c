@@ -0,0 +1,145 @@
+// N-Queens count of one shard, for job arrays without MPI
+//
+// Purpose:
+//   Counts one slice of the prefix frontier with a backend of
+//   common/n_queens_solver and writes its partial count to a manifest
+//   (common/n_queens_shard). The frontier and its split only depend on N, the
+//   depth and the number of shards: every shard of a job array computes the
+//   same cut, into contiguous ranges of close estimated subtree sizes.
+//   n_queens_shard_merge checks the manifests of all shards and adds them up.
+//   With --frontier, the prefixes (and their weights, if any) are read from a
+//   frontier file written by n_queens_frontier_file instead of being computed;
+//   without --shard, the whole count is done and no manifest is written.
+// Arguments: N backend [--shard i/k] [--depth d] [--threads t] [--manifest path] [--frontier file]
+// Compilation and Execution:
+//   $ gcc -O2 -fopenmp n_queens_sharded_count.c common/n_queens_shard.c common/n_queens_solver.c common/n_queens_checkpoint.c common/n_queens_frontier.c common/n_queens_core.c common/n_queens_estimator.c common/n_queens_memo.c common/n_queens_store.c common/n_queens_task_pool.c -lpthread -o n_queens_sharded_count
+//   $ for i in 0 1 2 3; do ./n_queens_sharded_count 16 pthread --shard $i/4 --depth 4; done
+//   $ ./n_queens_shard_merge shard_16_*_of_4.txt
+//   In a Slurm job array:
+//   $ ./n_queens_sharded_count 21 openmp --shard $SLURM_ARRAY_TASK_ID/$SLURM_ARRAY_TASK_COUNT --depth 6
+//   From a frontier file shared by every job:
+//   $ ./n_queens_frontier_file write 21 6 f21_6.nqf weights
+//   $ ./n_queens_sharded_count 21 openmp --frontier f21_6.nqf --shard $SLURM_ARRAY_TASK_ID/$SLURM_ARRAY_TASK_COUNT
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common/n_queens_shard.h"
+#include "common/n_queens_solver.h"
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s N backend [--shard i/k] [--depth d] [--threads t] [--manifest path] [--frontier file]\n",
+            program);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        usage(argv[0]);
+    }
+    NQ_CONFIG config;
+    nq_config_default(&config, (uint32_t)atoi(argv[1]));
+    config.backend = nq_backend_from_string(argv[2]);
+    if (config.backend == NQ_BACKEND_UNKNOWN)
+    {
+        usage(argv[0]);
+    }
+    const char *manifest_path = NULL;
+    const char *frontier_path = NULL;
+    int sharded = 0;
+    for (int i = 3; i < argc; i += 2)
+    {
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+        }
+        if (strcmp(argv[i], "--shard") == 0)
+        {
+            if (!nq_shard_parse(argv[i + 1], &config.shard, &config.shards))
+            {
+                fprintf(stderr, "'%s' is not a shard i/k with i < k.\n", argv[i + 1]);
+                return EXIT_FAILURE;
+            }
+            sharded = 1;
+        }
+        else if (strcmp(argv[i], "--depth") == 0)
+        {
+            config.depth = (uint32_t)atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0)
+        {
+            config.threads = (uint32_t)atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--manifest") == 0)
+        {
+            manifest_path = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--frontier") == 0)
+        {
+            frontier_path = argv[i + 1];
+        }
+        else
+        {
+            usage(argv[0]);
+        }
+    }
+    int rank = 0;
+#ifdef NQ_WITH_MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+    // every rank and every job of the node maps the same pages
+    NQ_FRONTIER_FILE *frontier = frontier_path ? nq_frontier_map(frontier_path) : NULL;
+    if (frontier_path != NULL && frontier == NULL)
+    {
+#ifdef NQ_WITH_MPI
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+#endif
+        return EXIT_FAILURE;
+    }
+    config.frontier = frontier;
+
+    NQ_RESULT result;
+    const int status = nq_solve(&config, NULL, &result);
+    if (frontier != NULL)
+    {
+        nq_frontier_unmap(frontier);
+    }
+    if (status == 0 && rank == 0 && !sharded)
+    {
+        printf("N = %u : %" PRIu64 " solutions, %" PRIu64 " placements, %" PRIu64 " prefixes at depth %u, %f s\n",
+               config.n_queens, result.solutions, result.placements, result.frontier, result.depth, result.seconds);
+    }
+    else if (status == 0 && rank == 0)
+    {
+        NQ_SHARD_MANIFEST manifest = {config.n_queens, result.depth, result.frontier, result.frontier_hash,
+                                      config.shard, config.shards, result.shard_begin, result.shard_end,
+                                      result.solutions, result.placements, result.seconds};
+        char default_path[64];
+        if (manifest_path == NULL)
+        {
+            snprintf(default_path, sizeof(default_path), "shard_%u_%u_of_%u.txt", config.n_queens, config.shard,
+                     config.shards);
+            manifest_path = default_path;
+        }
+        printf("N = %u, shard %u/%u : prefixes [%" PRIu64 ", %" PRIu64 ") of %" PRIu64 " at depth %u, %" PRIu64
+               " solutions, %" PRIu64 " placements, %f s -> %s\n",
+               config.n_queens, config.shard, config.shards, result.shard_begin, result.shard_end, result.frontier,
+               result.depth, result.solutions, result.placements, result.seconds, manifest_path);
+        if (!nq_shard_write(manifest_path, &manifest))
+        {
+#ifdef NQ_WITH_MPI
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+#endif
+            return EXIT_FAILURE;
+        }
+    }
+#ifdef NQ_WITH_MPI
+    MPI_Finalize();
+#endif
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
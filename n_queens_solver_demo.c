@@ -0,0 +1,166 @@
+// N-Queens reentrant solver demo
+//
+// Purpose:
+//   Runs one count on every backend of common/n_queens_solver, then several
+//   independent counts at the same time from different threads, all sharing a
+//   single pool of worker threads. No solver state lives in globals.
+//   With a third argument (MB), the sequential and pthread counts are run
+//   again through a shared transposition table of that size (0: none).
+//   With a fourth argument, the count is run twice through the result store
+//   kept in that file: the second time, and in any later run, it is read back.
+// Compilation and Execution:
+//   $ gcc -O2 -fopenmp n_queens_solver_demo.c common/n_queens_solver.c common/n_queens_checkpoint.c common/n_queens_frontier.c common/n_queens_core.c common/n_queens_estimator.c common/n_queens_memo.c common/n_queens_store.c common/n_queens_task_pool.c -lpthread -o n_queens_solver_demo
+//   $ ./n_queens_solver_demo 14 4
+//   $ ./n_queens_solver_demo 16 4 64
+//   $ ./n_queens_solver_demo 16 4 0 results.nqs
+//   With the MPI backend:
+//   $ mpicc -O2 -fopenmp -DNQ_WITH_MPI n_queens_solver_demo.c common/n_queens_solver.c common/n_queens_checkpoint.c common/n_queens_frontier.c common/n_queens_core.c common/n_queens_estimator.c common/n_queens_memo.c common/n_queens_store.c common/n_queens_task_pool.c -lpthread -o n_queens_solver_demo
+//   $ mpirun -np 2 ./n_queens_solver_demo 14 4
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "common/n_queens_solver.h"
+
+#define CONCURRENT_SOLVES 3
+
+typedef struct concurrent_solve
+{
+    NQ_CONFIG config;
+    NQ_WORKERS *workers;
+    NQ_RESULT result;
+    int status;
+} CONCURRENT_SOLVE;
+
+static void *run_solve(void *args)
+{
+    CONCURRENT_SOLVE *solve = args;
+    solve->status = nq_solve(&solve->config, solve->workers, &solve->result);
+    return NULL;
+}
+
+static void print_result(const char *label, uint32_t n_queens, const NQ_RESULT *result)
+{
+    printf("%-12s N = %2u : %" PRIu64 " solutions, %" PRIu64 " placements, %" PRIu64 " tasks, %f s\n",
+           label, n_queens, result->solutions, result->placements, result->tasks, result->seconds);
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t default_n = 12;
+    const uint32_t n_queens = (argc > 1) ? (uint32_t)atoi(argv[1]) : default_n;
+    const uint32_t threads = (argc > 2) ? (uint32_t)atoi(argv[2]) : 0;
+    const uint64_t memo_bytes = (argc > 3) ? (uint64_t)atoll(argv[3]) << 20 : 0;
+    const char *store_path = (argc > 4) ? argv[4] : NULL;
+    int rank = 0;
+#ifdef NQ_WITH_MPI
+    int provided;
+    // concurrent solves call MPI from several threads
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+    NQ_WORKERS *workers = nq_workers_create(threads);
+    static const char *names[] = {"sequential", "pthread", "openmp", "mpi"};
+#ifdef NQ_WITH_MPI
+    const int last_backend = NQ_BACKEND_MPI;
+#else
+    const int last_backend = NQ_BACKEND_OPENMP;
+#endif
+    for (int backend = NQ_BACKEND_SEQUENTIAL; backend <= last_backend; ++backend)
+    {
+        NQ_CONFIG config;
+        NQ_RESULT result;
+        nq_config_default(&config, n_queens);
+        config.backend = (NQ_BACKEND)backend;
+        config.threads = threads;
+        if (nq_solve(&config, workers, &result) == 0 && rank == 0)
+        {
+            print_result(names[backend], n_queens, &result);
+        }
+    }
+
+    // the same counts through one transposition table, kept from one count to the next
+    if (memo_bytes > 0 && n_queens <= NQ_MEMO_MAX_N)
+    {
+        NQ_MEMO *memo = nq_memo_create(n_queens, memo_bytes, 0, 0);
+        for (int backend = NQ_BACKEND_SEQUENTIAL; backend <= NQ_BACKEND_PTHREAD; ++backend)
+        {
+            NQ_CONFIG config;
+            NQ_RESULT result;
+            nq_config_default(&config, n_queens);
+            config.backend = (NQ_BACKEND)backend;
+            config.threads = threads;
+            config.memo = memo;
+            if (nq_solve(&config, workers, &result) == 0 && rank == 0)
+            {
+                print_result(backend == NQ_BACKEND_SEQUENTIAL ? "memo seq" : "memo pthread", n_queens, &result);
+                printf("             table : %" PRIu64 " hits, %" PRIu64 " misses (%.1f %% hits), %" PRIu64
+                       " stores, %" PRIu64 " replacements, %" PRIu64 " entries used\n",
+                       result.memo.hits, result.memo.misses,
+                       result.memo.hits + result.memo.misses
+                           ? 100.0 * result.memo.hits / (result.memo.hits + result.memo.misses)
+                           : 0.0,
+                       result.memo.stores, result.memo.replacements, nq_memo_occupancy(memo));
+            }
+        }
+        nq_memo_destroy(memo);
+    }
+
+    // a count that was already done is read back from the store
+    if (store_path != NULL)
+    {
+        NQ_STORE *store = nq_store_open(store_path);
+        if (store != NULL)
+        {
+            for (int run = 0; run < 2; ++run)
+            {
+                NQ_CONFIG config;
+                NQ_RESULT result;
+                nq_config_default(&config, n_queens);
+                config.backend = NQ_BACKEND_PTHREAD;
+                config.threads = threads;
+                config.store = store;
+                if (nq_solve(&config, workers, &result) == 0 && rank == 0)
+                {
+                    print_result("store", n_queens, &result);
+                    printf("             store : %" PRIu64 " results reused, %" PRIu64 " results in %s\n",
+                           result.reused, nq_store_count(store), store_path);
+                }
+            }
+            nq_store_close(store);
+        }
+    }
+
+    // independent solves of different sizes, started together on the same workers
+    CONCURRENT_SOLVE solves[CONCURRENT_SOLVES];
+    pthread_t th[CONCURRENT_SOLVES];
+    for (int i = 0; i < CONCURRENT_SOLVES; ++i)
+    {
+        nq_config_default(&solves[i].config, n_queens > (uint32_t)i ? n_queens - (uint32_t)i : 1);
+        solves[i].config.backend = NQ_BACKEND_PTHREAD;
+        solves[i].workers = workers;
+        if (pthread_create(&th[i], NULL, &run_solve, &solves[i]) != 0)
+        {
+            perror("Failed to create the thread");
+        }
+    }
+    for (int i = 0; i < CONCURRENT_SOLVES; ++i)
+    {
+        if (pthread_join(th[i], NULL) != 0)
+        {
+            perror("Failed to join the thread");
+        }
+        if (solves[i].status == 0 && rank == 0)
+        {
+            print_result("concurrent", solves[i].config.n_queens, &solves[i].result);
+        }
+    }
+    nq_workers_destroy(workers);
+
+#ifdef NQ_WITH_MPI
+    MPI_Finalize();
+#endif
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,85 @@
+// N-Queens breadth-first then depth-first count
+//
+// Purpose:
+//   Counts the N-Queens solutions with common/n_queens_bfs: the board is
+//   expanded level by level into structure-of-arrays frontiers (12 bytes per
+//   state) while the next level fits in the memory budget, then the OpenMP
+//   threads finish the states depth first. Prints the depth reached, the bytes
+//   per frontier state against one CHESS_BOARD copy of the task programs, the
+//   nodes per second of both phases, and checks the count against the
+//   sequential bitboard kernel.
+// Arguments: N [budget MB] [threads] [simd|scalar] [max depth]
+// Compilation and Execution:
+//   $ gcc -O3 -march=native -fopenmp openmp_bfs_soa.c ../common/n_queens_bfs.c ../common/n_queens_core.c -o openmp_bfs_soa
+//   $ ./openmp_bfs_soa 16 64 8
+//   $ ./openmp_bfs_soa 16 64 8 scalar
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../common/n_queens_bfs.h"
+#include "../common/n_queens_core.h"
+
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s N [budget MB] [threads] [simd|scalar] [max depth]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const uint32_t n_queens = (uint32_t)atoi(argv[1]);
+    NQ_BFS_OPTIONS options;
+    nq_bfs_options_default(&options);
+    if (argc > 2)
+    {
+        options.memory_budget = (uint64_t)atoll(argv[2]) << 20;
+    }
+    options.threads = (argc > 3) ? (uint32_t)atoi(argv[3]) : 0;
+    options.simd = !(argc > 4 && strcmp(argv[4], "scalar") == 0);
+    options.max_depth = (argc > 5) ? (uint32_t)atoi(argv[5]) : 0;
+    if (n_queens < 1 || n_queens > NQ_BFS_MAX_N)
+    {
+        fprintf(stderr, "N must be between 1 and %d.\n", NQ_BFS_MAX_N);
+        return EXIT_FAILURE;
+    }
+
+    NQ_BFS_STATS stats;
+    const uint64_t solutions = nq_bfs_count(n_queens, &options, &stats);
+    const uint64_t nodes = stats.bfs_placements + stats.dfs_placements;
+    const double seconds = stats.bfs_seconds + stats.dfs_seconds;
+
+    uint64_t reference_placements = 0;
+    const double start = now();
+    const uint64_t reference = nq_count(NQ_KERNEL_BITBOARD, n_queens, &reference_placements);
+    const double reference_seconds = now() - start;
+
+    // one task copy of the array programs: the struct and its four arrays
+    const uint64_t board_bytes = sizeof(CHESS_BOARD) + sizeof(uint32_t) * 2 * (n_queens + 2 * n_queens - 1);
+    printf("N = %u : %" PRIu64 " solutions, %" PRIu64 " placements, %f s (%s extraction)\n", n_queens, solutions,
+           nodes, seconds, options.simd ? "simd" : "scalar");
+    printf("  breadth first : depth %u, %" PRIu64 " states, %f s, %.1f M states/s, peak %.1f MB\n", stats.depth,
+           stats.frontier, stats.bfs_seconds, stats.bfs_placements / stats.bfs_seconds * 1e-6,
+           stats.peak_bytes / (double)(1 << 20));
+    printf("  bytes per state : %zu in a level, %.1f per state of the widest level with the work arrays, "
+           "one CHESS_BOARD copy: %" PRIu64 "\n",
+           3 * sizeof(uint32_t), stats.widest ? (double)stats.peak_bytes / stats.widest : 0.0, board_bytes);
+    printf("  depth first : %" PRIu64 " placements, %f s, %.1f M nodes/s\n", stats.dfs_placements, stats.dfs_seconds,
+           stats.dfs_placements / stats.dfs_seconds * 1e-6);
+    printf("  bitboard kernel (1 thread) : %" PRIu64 " solutions, %" PRIu64 " placements, %f s, %.1f M nodes/s\n",
+           reference, reference_placements, reference_seconds, reference_placements / reference_seconds * 1e-6);
+    if (solutions != reference || nodes != reference_placements)
+    {
+        fprintf(stderr, "Mismatch with the bitboard kernel.\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
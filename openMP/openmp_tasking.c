@@ -1,5 +1,9 @@
 #include "n_queens_counter_lib.h"
 #include <omp.h>
+#include "../common/n_queens_affinity.h"
+#include "../common/n_queens_telemetry.h"
+#include "../common/n_queens_estimator.h"
+#include <math.h>
 
 int tasks_created = 0;
 
@@ -7,58 +11,110 @@ uint32_t nqueens = 8;
 
 int nthreads = 4;
 
-int partial_solutions, partial_placements;
+//ordre des tâches : 0 = ordre du runtime (fifo), 1 = plus gros sous-arbre estimé d'abord (lpt)
+int lpt_order = 0;
+
+//découpage paresseux : parcours séquentiel qui ne crée de tâche que s'il y a
+//moins de tâches prêtes (créées, pas encore démarrées) que de threads
+int lazy_split = 0;
+int ready_tasks = 0;
+
+int partial_solutions;
+uint64_t partial_placements;
+
+//compteurs de charge de chaque thread (tâches séquentielles, noeuds, temps occupé)
+WORKER_STATS thread_stats;
 
 void place_next_queen_sequential(const uint32_t row_boundary, CHESS_BOARD *board);
 void place_next_queen_parallel(const uint32_t row_boundary, CHESS_BOARD *board);
+void place_next_queen_lazy(const uint32_t row_boundary, CHESS_BOARD *board);
 void place_queens(const uint32_t row_boundary, CHESS_BOARD *board);
 
 
 
-#pragma omp threadprivate(partial_solutions, partial_placements)
+#pragma omp threadprivate(partial_solutions, partial_placements, thread_stats)
 
 /** Lancer le processus de placement parallèle des reines sur l'échiquier. **/
 void place_queens(const uint32_t row_boundary, CHESS_BOARD *board)
 
 {
+    WORKER_STATS *stats = malloc(sizeof(WORKER_STATS) * nthreads);
+    const double region_start = telemetry_now();
+
     //crée une région parallèle avec nqueens threads
     #pragma omp parallel num_threads(nthreads) 
     {
+        //Fixer chaque thread sur son CPU selon la politique NQ_PLACEMENT
+        placement_bind_worker(omp_get_thread_num());
+
         //Initialiser le nombre de solutions partielles et de placements partiels pour chaque thread
         partial_solutions = 0;
         partial_placements = 0;
+        telemetry_reset(&thread_stats);
         
         //Assurer que la ligne suivante soit appelée par un seul thread et que les autres threads ne l'attendent pas
         #pragma omp single 
         {
             //Fonction parallélisée permettant de placer la reine suivante sur l'échiquier board.
-            place_next_queen_parallel(row_boundary, board);
+            if (lazy_split) {
+                const double task_start = telemetry_now();
+                const uint64_t placements = partial_placements;
+                place_next_queen_lazy(row_boundary, board);
+                telemetry_task_done(&thread_stats, partial_placements - placements, telemetry_now() - task_start);
+            } else {
+                place_next_queen_parallel(row_boundary, board);
+            }
         }
 
         //Additionner le nombre de solutions et de placements trouvés par chaque thread
         #pragma omp critical
         total_solutions += partial_solutions;
+
+        //le temps de la région qui n'a pas servi à une tâche séquentielle est compté comme attente
+        telemetry_idle(&thread_stats, telemetry_now() - region_start - thread_stats.busy);
+        stats[omp_get_thread_num()] = thread_stats;
     }
 
+    placement_report(nthreads);
+    telemetry_report("thread", stats, nthreads);
+    free(stats);
     
 }
 
 
+//priorité d'une tâche : log2 de la taille estimée du sous-arbre sous son
+//préfixe, bornée par omp_get_max_task_priority() (OMP_MAX_TASK_PRIORITY)
+static int task_priority(CHESS_BOARD *task_board) {
+    const int max_priority = omp_get_max_task_priority();
+    if (!lpt_order || max_priority == 0) {
+        return 0;
+    }
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    for (uint32_t j = 0; j < task_board->column_j; ++j) {
+        seed = seed * 31 + task_board->queen_positions[j];
+    }
+    const double nodes = estimator_subtree(task_board->n_size, task_board->queen_positions, task_board->column_j,
+                                           ESTIMATOR_DEFAULT_SAMPLES, &seed);
+    const int priority = (int)log2(nodes + 1);
+    return priority < max_priority ? priority : max_priority;
+}
+
 //la partie parallèle de l'algorithme, cette fonction génère des tâches à exécuter pour les threads 
 void place_next_queen_parallel(const uint32_t row_boundary, CHESS_BOARD *board) {
     const uint32_t middle = board->column_j ? board->n_size : board->n_size >> 1;
     
-    CHESS_BOARD *local_board;
     for (uint32_t row_i = 0; row_i < row_boundary; ++row_i) {  
         
         if (square_is_free(row_i, board)) 
         {
-            #pragma omp task firstprivate(row_i) mergeable 
-            {       
-                local_board = copyBoard(board);
-
-                set_queen(row_i, local_board);
+            //chaque tâche possède sa copie de l'échiquier, faite à sa création :
+            //elle peut la libérer sans attendre ses tâches filles
+            CHESS_BOARD *local_board = copyBoard(board);
+            set_queen(row_i, local_board);
+            const int priority = task_priority(local_board);
 
+            #pragma omp task firstprivate(local_board) mergeable priority(priority)
+            {       
                 uint32_t limit = local_board->n_size;
                 if (local_board->queen_positions[0] == middle) {
                     limit = middle;
@@ -69,14 +125,62 @@ void place_next_queen_parallel(const uint32_t row_boundary, CHESS_BOARD *board)
                 
                     place_next_queen_parallel(limit, local_board);
                 } else {
+                    const double task_start = telemetry_now();
+                    const uint64_t placements = partial_placements;
                     place_next_queen_sequential(limit, local_board);
+                    telemetry_task_done(&thread_stats, partial_placements - placements, telemetry_now() - task_start);
                 }
 
-            #pragma omp taskyield
-            
+                smash_board(local_board);
+            }
+        }
+    }
+}
+
+
+
+//parcours séquentiel qui détache une ligne en tâche quand des threads vont
+//manquer de travail, tant que la colonne est dans la première moitié
+void place_next_queen_lazy(const uint32_t row_boundary, CHESS_BOARD *board)
+{
+    const uint32_t middle = board->column_j ? board->n_size : board->n_size >> 1;
+
+    for (uint32_t row_i = 0; row_i < row_boundary; ++row_i)
+    {
+        if (!square_is_free(row_i, board))
+        {
+            continue;
+        }
+        if (board->column_j < nqueens / 2 && __atomic_load_n(&ready_tasks, __ATOMIC_RELAXED) < nthreads)
+        {
+            CHESS_BOARD *local_board = copyBoard(board);
+            set_queen(row_i, local_board);
+            __atomic_add_fetch(&ready_tasks, 1, __ATOMIC_RELAXED);
+
+            #pragma omp task firstprivate(local_board)
+            {
+                __atomic_sub_fetch(&ready_tasks, 1, __ATOMIC_RELAXED);
+                const double task_start = telemetry_now();
+                const uint64_t placements = partial_placements;
+                if (local_board->column_j == local_board->n_size) {
+                    partial_solutions += 2;
+                } else {
+                    place_next_queen_lazy(local_board->queen_positions[0] == middle ? middle : local_board->n_size, local_board);
+                }
+                telemetry_task_done(&thread_stats, partial_placements - placements, telemetry_now() - task_start);
+                smash_board(local_board);
             }
-            free(local_board); 
+            continue;
         }
+
+        set_queen(row_i, board);
+        partial_placements++;
+        if (board->column_j == board->n_size) {
+            partial_solutions += 2;
+        } else {
+            place_next_queen_lazy(board->queen_positions[0] == middle ? middle : board->n_size, board);
+        }
+        remove_queen(row_i, board);
     }
 }
 
@@ -92,6 +196,7 @@ void place_next_queen_sequential(const uint32_t row_boundary, CHESS_BOARD *board
         if (square_is_free(row_i, board))
         {
             set_queen(row_i, board);
+            partial_placements++;
 
 
             if (board->column_j == board->n_size){
@@ -143,10 +248,19 @@ int main(int argc, char *argv[])
     double temps_parallel_pris, temps_sequentiel_pris = 0;
 
     nqueens = (argc != 1) ? (uint32_t)atoi(argv[1]) : nqueens;
+    //création des tâches : fifo (par défaut), lpt ou lazy
+    lpt_order = (argc > 2) && strcmp(argv[2], "lpt") == 0;
+    lazy_split = (argc > 2) && strcmp(argv[2], "lazy") == 0;
+    printf("création des tâches : %s\n", lazy_split ? "lazy" : (lpt_order ? "lpt" : "fifo"));
+    if (lpt_order && omp_get_max_task_priority() == 0) {
+        fprintf(stderr, "OMP_MAX_TASK_PRIORITY vaut 0 : les priorités des tâches sont ignorées.\n");
+    }
 
     const uint32_t row_boundary = (nqueens >> 1) + (nqueens & 1);
 
-    initialize_board(nqueens, &board);
+    placement_init(PLACEMENT_NONE);
+
+    initialize_board(nqueens, &board, 0, 0);
     start_time = omp_get_wtime();
     place_next_queen(row_boundary, board); 
     end_time = omp_get_wtime();
@@ -158,7 +272,7 @@ int main(int argc, char *argv[])
 
     
     total_solutions = 0;
-    initialize_board(nqueens, &board);
+    initialize_board(nqueens, &board, 0, 0);
     start_time = omp_get_wtime();
     place_queens(row_boundary, board); 
     end_time = omp_get_wtime();
@@ -178,7 +292,7 @@ int main(int argc, char *argv[])
 
     nthreads = 8;
     total_solutions = 0;
-    initialize_board(nqueens, &board);
+    initialize_board(nqueens, &board, 0, 0);
     start_time = omp_get_wtime();
     place_queens(row_boundary, board); 
     end_time = omp_get_wtime();
@@ -198,7 +312,7 @@ int main(int argc, char *argv[])
 
     nthreads = 16;
     total_solutions = 0;
-    initialize_board(nqueens, &board);
+    initialize_board(nqueens, &board, 0, 0);
     start_time = omp_get_wtime();
     place_queens(row_boundary, board); 
     end_time = omp_get_wtime();
@@ -218,7 +332,7 @@ int main(int argc, char *argv[])
 
     nthreads = 32;
     total_solutions = 0;
-    initialize_board(nqueens, &board);
+    initialize_board(nqueens, &board, 0, 0);
     start_time = omp_get_wtime();
     place_queens(row_boundary, board); 
     end_time = omp_get_wtime();
@@ -5,52 +5,23 @@
 #include <pthread.h>
 #include <time.h>
 #include <mpi.h>
+#include "../common/n_queens_telemetry.h"
+#include "../common/n_queens_estimator.h"
+#include "../common/n_queens_core.h"
+#include "../common/n_queens_frontier.h"
 
 #define level 0
-#define MAX_BOARDS 500
 
 // An abstract representation of an NxN chess board to tracking open positions
-typedef struct chess_board
-{
-    uint32_t n_size;           // Number of queens on the NxN chess board
-    uint32_t *queen_positions; // Store queen positions on the board
-    uint32_t *column;          // Store available column moves/attacks
-    uint32_t *diagonal_up;     // Store available diagonal moves/attacks
-    uint32_t *diagonal_down;
-    uint32_t column_j;   // Stores column to place the next queen in
-    uint64_t placements; // Tracks total number queen placements
-    uint64_t solutions;  // Tracks number of solutions
-    //indicate the intervals of rows that will be verified for each process
-    uint64_t start;
-    uint64_t end;
-}Board;
-
-// un pointeur vers un echéquier qui simule une tâche dans la file
-typedef Board *Task;
+typedef CHESS_BOARD Board;
 
-
-// pour compter le nombre de tâches dans la file
+// pour compter le nombre de tâches du frontier
 uint64_t taskCount = 0;
 uint64_t numberOfSolutions = 0;
 // Function prototypes
 
-//creer les taches du premier colonne jusqu'à la limite : level
-void createTasks(Task *task);
-
-//enfiler la tache : task
-void submitTask(Board *task);
-
-//executer avec la fonction createTasks afin de generer les taches à partir d'un certain echiquier donné
-void place_next_queen(struct chess_board *board);
-
 //execution sequentiel de la fonction principale 
 void place_next_queen_process(struct chess_board *board);
-static void initialize_board(const uint32_t n_queens, struct chess_board **board, uint32_t start, uint32_t end);
-
-//définir un nouveau type de données MPI (MPI_Datatype) qui correspond à la structure Board
-void defineTaskStruct(MPI_Datatype *mpiTaskType);
-
-Board taskQueue[MAX_BOARDS];
 
 int main(int argc, char *argv[])
 {
@@ -64,294 +35,98 @@ int main(int argc, char *argv[])
     MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
 
-    const uint32_t row_boundary = (n_queens >> 1) + (n_queens & 1);
-
     struct chess_board *board;
-
-    uint32_t start = 0;
-    uint32_t end =row_boundary;
-
-    initialize_board(n_queens, &board, start, end);  
-    if (rank == 0) {
-        // Créer la file des taches 
-        createTasks(&board);
-    }
-    MPI_Datatype mpiTaskType;
-    defineTaskStruct(&mpiTaskType);
-
-    int packedSize;
-    // Obtenir la taille du tampon requis pour emballer les tâches
-    MPI_Pack_size(MAX_BOARDS, mpiTaskType, MPI_COMM_WORLD, &packedSize);
-
-    char *buffer = malloc(packedSize);
-    int position = 0;
-    if (rank == 0) {
-        // Emballer les tâches dans un tampon
-        MPI_Pack(taskQueue, MAX_BOARDS, mpiTaskType, buffer, packedSize, &position, MPI_COMM_WORLD);
+    initialize_board(n_queens, &board, 0, 0);
+
+    // Les tâches sont les préfixes de level + 1 colonnes, produits à la demande
+    // dans le même ordre par chaque processus : rien n'est rangé d'avance
+    const uint32_t depth = level + 1 < n_queens ? level + 1 : n_queens;
+    NQ_PREFIX_STREAM stream;
+    NQ_PREFIX prefix;
+    nq_stream_init(&stream, n_queens, depth);
+
+    // Estimer la taille du sous-arbre de chaque tâche (sondages de Knuth, graine
+    // fixe : tous les processus obtiennent les mêmes poids) ; seuls les poids
+    // sont gardés, pas les échiquiers
+    uint64_t capacity = 256;
+    double *weights = malloc(sizeof(double) * capacity);
+    while (nq_stream_next(&stream, &prefix))
+    {
+        if (taskCount == capacity)
+        {
+            capacity *= 2;
+            weights = realloc(weights, sizeof(double) * capacity);
+        }
+        if (weights == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed for the task weights.\n");
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        weights[taskCount++] = estimator_prefix(n_queens, prefix.rows, depth, prefix.index, ESTIMATOR_DEFAULT_SAMPLES);
     }
-    // Diffuser le tampon contenant les tâches à tous les processus
-    MPI_Bcast(buffer, packedSize, MPI_PACKED, 0, MPI_COMM_WORLD);
 
-    if (rank != 0) {
-        // Déballer les tâches depuis le tampon
-        MPI_Unpack(buffer, packedSize, &position, taskQueue, MAX_BOARDS, mpiTaskType, MPI_COMM_WORLD);
-    }
-    
-    // Répartir les tâches entre les processus
-    uint64_t start_process = rank * taskCount / num_procs;
-    uint64_t end_process = (rank + 1) * taskCount / num_procs;
+    // Répartir les tâches entre les processus selon leur poids estimé
+    uint64_t *bounds = malloc(sizeof(uint64_t) * (num_procs + 1));
+    estimator_weighted_split(weights, taskCount, num_procs, bounds);
+    uint64_t start_process = bounds[rank];
+    uint64_t end_process = bounds[rank + 1];
+    free(bounds);
+    free(weights);
     
-    for (int i = start_process; i < end_process; i++)
+    WORKER_STATS stats;
+    telemetry_reset(&stats);
+    // Reprendre le frontier au début de la part du processus
+    nq_stream_skip_to(&stream, start_process);
+    for (uint64_t i = start_process; i < end_process && nq_stream_next(&stream, &prefix); i++)
     {
         // Exécuter les tâches assignées à chaque processus
-        place_next_queen_process(&taskQueue[i]);   
-    }
+        const double task_start = telemetry_now();
+        const uint64_t placements = board->placements;
+        nq_prefix_place(&prefix, board);
+        place_next_queen_process(board);
+        nq_prefix_remove(&prefix, board);
+        telemetry_task_done(&stats, board->placements - placements, telemetry_now() - task_start);
+    }
+    nq_stream_destroy(&stream);
+    smash_board(board);
     
     printf("solutions : %lu \n",numberOfSolutions);
     uint64_t total_solutions = 0;
     // Réduire le nombre local de solutions pour obtenir le nombre total de solutions
     MPI_Reduce(&numberOfSolutions, &total_solutions, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+    // Rassembler les compteurs de charge des processus avec la réduction
+    WORKER_STATS *all_stats = rank == 0 ? malloc(sizeof(WORKER_STATS) * num_procs) : NULL;
+    MPI_Gather(&stats, sizeof(WORKER_STATS), MPI_BYTE, all_stats, sizeof(WORKER_STATS), MPI_BYTE, 0, MPI_COMM_WORLD);
     
     if (rank == 0) {
         clock_t end_time = clock();
         double time_totale = (double)(end_time-start_time)/CLOCKS_PER_SEC;
         printf("program takes : %f s \n",time_totale);
         printf("The %u-Queens problem has %lu solutions\n", n_queens, total_solutions);
+        // Les processus qui finissent tôt attendent le plus lent
+        double longest = 0.0;
+        for (int r = 0; r < num_procs; r++) {
+            longest = all_stats[r].busy > longest ? all_stats[r].busy : longest;
+        }
+        for (int r = 0; r < num_procs; r++) {
+            telemetry_idle(&all_stats[r], longest - all_stats[r].busy);
+        }
+        telemetry_report("rank", all_stats, num_procs);
+        free(all_stats);
     }
     
-    free(buffer);
-    MPI_Type_free(&mpiTaskType);
     MPI_Finalize();
     return EXIT_SUCCESS;
 }
 
 
-void defineTaskStruct(MPI_Datatype *mpiTaskType) {
-    int blockLengths[10] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
-    MPI_Aint displacements[10];
-    MPI_Datatype types[10] = {
-        MPI_UINT32_T, MPI_UINT32_T, MPI_UINT32_T, MPI_UINT32_T, MPI_UINT32_T,
-        MPI_UINT32_T, MPI_UINT64_T, MPI_UINT64_T, MPI_UINT64_T, MPI_UINT64_T
-    };
-
-    Board board;
-    MPI_Get_address(&(board.n_size), &displacements[0]);
-    MPI_Get_address(&(board.queen_positions), &displacements[1]);
-    MPI_Get_address(&(board.column), &displacements[2]);
-    MPI_Get_address(&(board.diagonal_up), &displacements[3]);
-    MPI_Get_address(&(board.diagonal_down), &displacements[4]);
-    MPI_Get_address(&(board.column_j), &displacements[5]);
-    MPI_Get_address(&(board.placements), &displacements[6]);
-    MPI_Get_address(&(board.solutions), &displacements[7]);
-    MPI_Get_address(&(board.start), &displacements[8]);
-    MPI_Get_address(&(board.end), &displacements[9]);
-
-    for (int i = 1; i < 10; i++) {
-        displacements[i] -= displacements[0];
-    }
-    displacements[0] = 0;
-
-    MPI_Type_create_struct(10, blockLengths, displacements, types, mpiTaskType);
-    MPI_Type_commit(mpiTaskType);
-}
-// Handles dynamic memory allocation of the arrays and sets initial values
-static void initialize_board(const uint32_t n_queens, struct chess_board **board, uint32_t start, uint32_t end)
-{
-    if (n_queens < 1)
-    {
-        fprintf(stderr, "The number of queens must be greater than 0.\n");
-        exit(EXIT_SUCCESS);
-    }
-
-    // Dynamically allocate memory for chessboard struct
-    *board = malloc(sizeof(struct chess_board));
-    if (*board == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed for chess board.\n");
-        exit(EXIT_FAILURE);
-    }
-
-    // Dynamically allocate memory for chessboard arrays that track positions
-    const uint32_t diagonal_size = 2 * n_queens - 1;
-    const uint32_t total_size = 2 * (n_queens + diagonal_size);
-    (*board)->queen_positions = malloc(sizeof(uint32_t) * total_size);
-    if ((*board)->queen_positions == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed for the chess board arrays.\n");
-        free(*board);
-        exit(EXIT_FAILURE);
-    }
-    (*board)->column = &(*board)->queen_positions[n_queens];
-    (*board)->diagonal_up = &(*board)->column[n_queens];
-    (*board)->diagonal_down = &(*board)->diagonal_up[diagonal_size];
-
-    // Initialize the chess board parameters
-    (*board)->n_size = n_queens;
-    for (uint32_t i = 0; i < n_queens; ++i)
-    {
-        (*board)->queen_positions[i] = 0;
-    }
-    for (uint32_t i = n_queens; i < total_size; ++i)
-    {
-        // Initializes values for column, diagonal_up, and diagonal_down
-        (*board)->queen_positions[i] = 1;
-    }
-    (*board)->column_j = 0;
-    (*board)->placements = 0;
-    (*board)->solutions = 0;
-    (*board)->start = start;
-    (*board)->end = end;
-}
-
-// pour créer une copie de l'échiquier
-struct chess_board *copyBoard(struct chess_board *board)
-{
-    Task task = malloc(sizeof(struct chess_board));
-
-    if (board->n_size < 1)
-    {
-        fprintf(stderr, "The number of queens must be greater than 0.\n");
-        exit(EXIT_SUCCESS);
-    }
-    task = malloc(sizeof(struct chess_board));
-    if (task == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed for chess board.\n");
-        exit(EXIT_FAILURE);
-    }
-    const uint32_t diagonal_size = 2 * board->n_size - 1;
-    const uint32_t total_size = 2 * (board->n_size + diagonal_size);
-    (task)->queen_positions = malloc(sizeof(uint32_t) * total_size);
-    if ((task)->queen_positions == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed for the chess board arrays.\n");
-        free(task);
-        exit(EXIT_FAILURE);
-    }
-    (task)->column = &(task)->queen_positions[board->n_size];
-    (task)->diagonal_up = &(task)->column[board->n_size];
-    (task)->diagonal_down = &(task)->diagonal_up[diagonal_size];
-    (task)->n_size = board->n_size;
-    for (uint32_t i = 0; i < board->n_size; ++i)
-    {
-        task->queen_positions[i] = board->queen_positions[i];
-    }
-    for (uint32_t i = board->n_size; i < total_size; ++i)
-    {
-        task->queen_positions[i] = board->queen_positions[i];
-    }
-    task->column_j = board->column_j;
-    task->placements = board->placements;
-    task->start = board->start;
-    task->end = board->end;
-    return task;
-}
-
-
-// Check if a queen can be placed in at row 'i' of the current column
-static uint32_t square_is_free(const uint32_t row_i, struct chess_board *board)
-{
-    return board->column[row_i] &
-           board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] &
-           board->diagonal_down[board->column_j + row_i];
-}
-
-// Place a queen on the chess board at row 'i' of the current column
-static void set_queen(const uint32_t row_i, struct chess_board *board)
-{
-    board->queen_positions[board->column_j] = row_i;
-    board->column[row_i] = 0;
-    board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] = 0;
-    board->diagonal_down[board->column_j + row_i] = 0;
-    ++board->column_j;
-    ++board->placements;
-}
-
-// Removes a queen from the NxN chess board in the given column to backtrack
-static void remove_queen(const uint32_t row_i, struct chess_board *board)
-{
-    --board->column_j;
-    board->diagonal_down[board->column_j + row_i] = 1;
-    board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] = 1;
-    board->column[row_i] = 1;
-}
-
-void createTasks(Task *task)
-{
-    // vérifier si on est arrivé au niveau de parallélisation désiré
-    if ((*task)->column_j <= level)
-    {
-        // on ajoute des tâches
-        place_next_queen(*task);
-    }
-}
-
-// pour ajouter une tâche dans la file
-void submitTask(Board *task)
-{
-    taskQueue[taskCount] = (*task);
-    taskCount++;
-}
-void place_next_queen(struct chess_board *board)
-{
-    uint64_t start = board->start;
-    uint64_t end = board->end;
-    const uint32_t middle = board->column_j ? board->n_size : board->n_size >> 1;
-    for (uint32_t row_i = start; row_i < end; ++row_i)
-    {
-        // on utilise ces vérification au lieu de la fonction donnéé pour vérifier la disponibilité d'un emplacement
-        // c'est la même chose juste ordonné par les plus petites vérifications vers les plus grandes pour diminuer le temps d'execution
-        if (board->column[row_i])
-        {
-            if (board->diagonal_down[board->column_j + row_i])
-            {
-                if (board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)])
-                {
-                    set_queen(row_i, board);
-                    if (board->queen_positions[0] != middle)
-                    {
-                        board->start = 0;
-                        board->end = board->n_size;
-                        Board *task = copyBoard(board);
-                        if(task->column_j <= level){
-                            // on ajoute des tâches
-                            place_next_queen(task);
-                        }else{
-                            submitTask(task);
-                        }
-                    }
-                    else
-                    {
-                        board->start = 0;
-                        board->end = middle;
-                        Task task = copyBoard(board);
-                        if(task->column_j <= level){
-                            // on ajoute des tâches
-                            place_next_queen(task);
-                        }else{
-                            printf("here submit col %u\n", task->column_j);
-                            submitTask(task);
-                        }
-                    }
-                    remove_queen(row_i, board);
-                }
-            }
-        }
-    }
-
-
-}
 void place_next_queen_process(struct chess_board *board)
 {
-    printf("incide\n");
     uint64_t start = board->start;
-    printf("start %lu\n",start);
     uint64_t end = board->end;
-    printf("end %lu\n",end);
     const uint32_t middle = board->column_j ? board->n_size : board->n_size >> 1;
     for (uint32_t row_i = start; row_i < end; ++row_i)
     {
-            printf("row_i: %u \n\n",row_i);
         if (board->column[row_i])
         {
             if (board->diagonal_down[board->column_j + row_i])
@@ -361,7 +136,6 @@ void place_next_queen_process(struct chess_board *board)
                     set_queen(row_i, board);
                     if (board->column_j == board->n_size)
                     {
-                        printf("increm\n");
                         numberOfSolutions += 2;
                     }
                     else if (board->queen_positions[0] != middle)
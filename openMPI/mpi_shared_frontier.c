@@ -0,0 +1,263 @@
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <mpi.h>
+#include "../common/n_queens_telemetry.h"
+#include "../common/n_queens_estimator.h"
+#include "../common/n_queens_core.h"
+
+// Profondeur maximale des préfixes stockés dans la fenêtre partagée
+#define MAX_DEPTH 8
+// Profondeur par défaut du frontier (nombre de colonnes fixées par préfixe)
+#define DEFAULT_DEPTH 2
+
+// Un préfixe du frontier : les lignes des reines des `depth` premières colonnes.
+// Contrairement à CHESS_BOARD, il ne contient aucun pointeur et peut donc être
+// partagé entre processus (fenêtre partagée) ou envoyé tel quel par MPI.
+typedef struct prefix
+{
+    uint32_t rows[MAX_DEPTH];
+} Prefix;
+
+// En-tête de la fenêtre partagée d'un noeud, suivi de `count` préfixes.
+// `next` est le prochain préfixe à réclamer, `solutions` la somme du noeud.
+typedef struct frontier_header
+{
+    uint64_t next;
+    uint64_t count;
+    uint64_t solutions;
+    uint64_t placements;
+} FrontierHeader;
+
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t default_n = 4;
+    int num_procs, rank;
+    int node_rank, node_size;
+    int is_leader;
+
+    const uint32_t n_queens = (argc > 1) ? (uint32_t)atoi(argv[1]) : default_n;
+    uint32_t depth = (argc > 2) ? (uint32_t)atoi(argv[2]) : DEFAULT_DEPTH;
+    if (depth < 1 || depth > MAX_DEPTH)
+    {
+        fprintf(stderr, "The frontier depth must be between 1 and %d.\n", MAX_DEPTH);
+        return EXIT_FAILURE;
+    }
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    double start_time = MPI_Wtime();
+
+    // Regrouper les processus qui partagent la mémoire d'un même noeud
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+    MPI_Comm_rank(node_comm, &node_rank);
+    MPI_Comm_size(node_comm, &node_size);
+    is_leader = (node_rank == 0);
+
+    // Seuls les chefs de noeud communiquent à travers le réseau
+    MPI_Comm leader_comm;
+    MPI_Comm_split(MPI_COMM_WORLD, is_leader ? 0 : MPI_UNDEFINED, rank, &leader_comm);
+
+    // Le processus 0 génère le frontier complet, puis le répartit entre les
+    // noeuds proportionnellement à leur nombre de processus
+    Prefix *node_prefixes = NULL;
+    uint64_t node_count = 0;
+    if (is_leader)
+    {
+        int num_nodes, leader_rank;
+        MPI_Comm_size(leader_comm, &num_nodes);
+        MPI_Comm_rank(leader_comm, &leader_rank);
+
+        // Les préfixes circulent en unités de Prefix, pas en octets : les
+        // comptes de MPI_Scatterv (int) suffisent jusqu'à INT_MAX préfixes
+        MPI_Datatype prefix_type;
+        MPI_Type_contiguous(sizeof(Prefix), MPI_BYTE, &prefix_type);
+        MPI_Type_commit(&prefix_type);
+
+        int *node_sizes = malloc(sizeof(int) * num_nodes);
+        MPI_Gather(&node_size, 1, MPI_INT, node_sizes, 1, MPI_INT, 0, leader_comm);
+
+        int *send_counts = NULL;
+        int *displs = NULL;
+        Prefix *ordered = NULL;
+        if (leader_rank == 0)
+        {
+            struct chess_board *board;
+            uint32_t *rows = NULL;
+            uint64_t count = 0, capacity = 0;
+            initialize_board(n_queens, &board, 0, 0);
+            nq_half_board_expand(board, depth, MAX_DEPTH, &rows, &count, &capacity);
+            smash_board(board);
+            Prefix *prefixes = (Prefix *)rows;
+            if (count > INT_MAX)
+            {
+                fprintf(stderr, "The frontier has %" PRIu64 " prefixes, more than MPI can scatter (%d).\n", count,
+                        INT_MAX);
+                MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+            }
+
+            // Ordre LPT : les plus gros sous-arbres estimés d'abord, pour qu'ils
+            // soient réclamés en premier sur chaque noeud
+            double *weights = malloc(sizeof(double) * (count ? count : 1));
+            uint64_t *order = malloc(sizeof(uint64_t) * (count ? count : 1));
+            Prefix *sorted = malloc(sizeof(Prefix) * (count ? count : 1));
+            estimator_frontier(n_queens, prefixes[0].rows, MAX_DEPTH, count,
+                               depth < n_queens ? depth : n_queens, ESTIMATOR_DEFAULT_SAMPLES, weights);
+            estimator_lpt_order(weights, count, order);
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                sorted[i] = prefixes[order[i]];
+            }
+            free(prefixes);
+            free(order);
+            free(weights);
+            prefixes = sorted;
+
+            // Distribution cyclique : le préfixe i va au noeud qui possède le
+            // processus (i mod num_procs), ce qui mélange les gros et petits sous-arbres
+            int *slot_to_node = malloc(sizeof(int) * num_procs);
+            for (int node = 0, slot = 0; node < num_nodes; ++node)
+            {
+                for (int k = 0; k < node_sizes[node]; ++k)
+                {
+                    slot_to_node[slot++] = node;
+                }
+            }
+            send_counts = calloc(num_nodes, sizeof(int));
+            displs = calloc(num_nodes, sizeof(int));
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                send_counts[slot_to_node[i % num_procs]]++;
+            }
+            for (int node = 1; node < num_nodes; ++node)
+            {
+                displs[node] = displs[node - 1] + send_counts[node - 1];
+            }
+            int *fill = calloc(num_nodes, sizeof(int));
+            ordered = malloc(sizeof(Prefix) * (count ? count : 1));
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                const int node = slot_to_node[i % num_procs];
+                ordered[displs[node] + fill[node]++] = prefixes[i];
+            }
+            free(fill);
+            free(slot_to_node);
+            free(prefixes);
+        }
+
+        int recv_count = 0;
+        MPI_Scatter(send_counts, 1, MPI_INT, &recv_count, 1, MPI_INT, 0, leader_comm);
+        node_count = (uint64_t)recv_count;
+        node_prefixes = malloc(sizeof(Prefix) * (node_count ? node_count : 1));
+        MPI_Scatterv(ordered, send_counts, displs, prefix_type,
+                     node_prefixes, recv_count, prefix_type, 0, leader_comm);
+        MPI_Type_free(&prefix_type);
+
+        free(ordered);
+        free(send_counts);
+        free(displs);
+        free(node_sizes);
+    }
+
+    // Une seule copie du frontier par noeud, dans une fenêtre partagée allouée
+    // par le chef ; les autres processus n'allouent rien et y accèdent directement
+    MPI_Bcast(&node_count, 1, MPI_UINT64_T, 0, node_comm);
+    const MPI_Aint window_size = is_leader ? sizeof(FrontierHeader) + node_count * sizeof(Prefix) : 0;
+    MPI_Win window;
+    void *window_base;
+    MPI_Win_allocate_shared(window_size, 1, MPI_INFO_NULL, node_comm, &window_base, &window);
+
+    MPI_Aint leader_size;
+    int disp_unit;
+    FrontierHeader *header;
+    MPI_Win_shared_query(window, 0, &leader_size, &disp_unit, &header);
+    Prefix *frontier = (Prefix *)(header + 1);
+
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, window);
+    if (is_leader)
+    {
+        header->next = 0;
+        header->count = node_count;
+        header->solutions = 0;
+        header->placements = 0;
+        memcpy(frontier, node_prefixes, node_count * sizeof(Prefix));
+        free(node_prefixes);
+    }
+    MPI_Win_sync(window);
+    MPI_Barrier(node_comm);
+    MPI_Win_sync(window);
+
+    // Chaque processus réclame le prochain préfixe par un incrément atomique
+    // en mémoire partagée : aucun message n'est échangé à l'intérieur du noeud
+    struct chess_board *board;
+    initialize_board(n_queens, &board, 0, 0);
+    WORKER_STATS stats;
+    telemetry_reset(&stats);
+    for (;;)
+    {
+        const uint64_t i = __atomic_fetch_add(&header->next, 1, __ATOMIC_RELAXED);
+        if (i >= header->count)
+        {
+            break;
+        }
+        const double task_start = telemetry_now();
+        const uint64_t placements = board->placements;
+        nq_half_board_solve(NQ_KERNEL_BITBOARD, frontier[i].rows, depth, board);
+        telemetry_task_done(&stats, board->placements - placements, telemetry_now() - task_start);
+    }
+    __atomic_fetch_add(&header->solutions, board->solutions, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&header->placements, board->placements, __ATOMIC_RELAXED);
+    smash_board(board);
+
+    MPI_Win_sync(window);
+    MPI_Barrier(node_comm);
+    MPI_Win_sync(window);
+
+    // Rassembler les compteurs de charge des processus avec la réduction
+    WORKER_STATS *all_stats = rank == 0 ? malloc(sizeof(WORKER_STATS) * num_procs) : NULL;
+    MPI_Gather(&stats, sizeof(WORKER_STATS), MPI_BYTE, all_stats, sizeof(WORKER_STATS), MPI_BYTE, 0, MPI_COMM_WORLD);
+
+    // Réduire les sommes des noeuds entre chefs uniquement
+    if (is_leader)
+    {
+        uint64_t node_solutions = header->solutions;
+        uint64_t total_solutions = 0;
+        MPI_Reduce(&node_solutions, &total_solutions, 1, MPI_UINT64_T, MPI_SUM, 0, leader_comm);
+        if (rank == 0)
+        {
+            // The next line fixes double-counting when solving the 1-queen problem
+            if (n_queens == 1)
+            {
+                total_solutions = 1;
+            }
+            double end_time = MPI_Wtime();
+            printf("program takes : %f s \n", end_time - start_time);
+            printf("The %u-Queens problem has %lu solutions\n", n_queens, total_solutions);
+            // Les processus qui finissent tôt attendent le plus lent
+            double longest = 0.0;
+            for (int r = 0; r < num_procs; r++)
+            {
+                longest = all_stats[r].busy > longest ? all_stats[r].busy : longest;
+            }
+            for (int r = 0; r < num_procs; r++)
+            {
+                telemetry_idle(&all_stats[r], longest - all_stats[r].busy);
+            }
+            telemetry_report("rank", all_stats, num_procs);
+            free(all_stats);
+        }
+        MPI_Comm_free(&leader_comm);
+    }
+
+    MPI_Win_unlock_all(window);
+    MPI_Win_free(&window);
+    MPI_Comm_free(&node_comm);
+    MPI_Finalize();
+    return EXIT_SUCCESS;
+}
@@ -5,102 +5,13 @@
 #include <pthread.h>
 #include <time.h>
 #include <mpi.h>
+#include "../common/n_queens_telemetry.h"
+#include "../common/n_queens_estimator.h"
+#include "../common/n_queens_core.h"
 
 // An abstract representation of an NxN chess board to tracking open positions
-struct chess_board
-{
-    uint32_t n_size;           // Number of queens on the NxN chess board
-    uint32_t *queen_positions; // Store queen positions on the board
-    uint32_t *column;          // Store available column moves/attacks
-    uint32_t *diagonal_up;     // Store available diagonal moves/attacks
-    uint32_t *diagonal_down;
-    uint32_t column_j;   // Stores column to place the next queen in
-    uint64_t placements; // Tracks total number queen placements
-    uint64_t solutions;  // Tracks number of solutions
-    //indicate the intervals of rows that will be verified for each process
-    uint64_t start;
-    uint64_t end;
-};
 struct chess_board *board;
 
-// Handles dynamic memory allocation of the arrays and sets initial values
-static void initialize_board(const uint32_t n_queens, struct chess_board **board, uint32_t start, uint32_t end)
-{
-    if (n_queens < 1)
-    {
-        fprintf(stderr, "The number of queens must be greater than 0.\n");
-        exit(EXIT_SUCCESS);
-    }
-
-    // Dynamically allocate memory for chessboard struct
-    *board = malloc(sizeof(struct chess_board));
-    if (*board == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed for chess board.\n");
-        exit(EXIT_FAILURE);
-    }
-
-    // Dynamically allocate memory for chessboard arrays that track positions
-    const uint32_t diagonal_size = 2 * n_queens - 1;
-    const uint32_t total_size = 2 * (n_queens + diagonal_size);
-    (*board)->queen_positions = malloc(sizeof(uint32_t) * total_size);
-    if ((*board)->queen_positions == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed for the chess board arrays.\n");
-        free(*board);
-        exit(EXIT_FAILURE);
-    }
-    (*board)->column = &(*board)->queen_positions[n_queens];
-    (*board)->diagonal_up = &(*board)->column[n_queens];
-    (*board)->diagonal_down = &(*board)->diagonal_up[diagonal_size];
-
-    // Initialize the chess board parameters
-    (*board)->n_size = n_queens;
-    for (uint32_t i = 0; i < n_queens; ++i)
-    {
-        (*board)->queen_positions[i] = 0;
-    }
-    for (uint32_t i = n_queens; i < total_size; ++i)
-    {
-        // Initializes values for column, diagonal_up, and diagonal_down
-        (*board)->queen_positions[i] = 1;
-    }
-    (*board)->column_j = 0;
-    (*board)->placements = 0;
-    (*board)->solutions = 0;
-    (*board)->start = start;
-    (*board)->end = end;
-}
-
-
-
-// Check if a queen can be placed in at row 'i' of the current column
-static uint32_t square_is_free(const uint32_t row_i, struct chess_board *board)
-{
-    return board->column[row_i] &
-           board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] &
-           board->diagonal_down[board->column_j + row_i];
-}
-
-// Place a queen on the chess board at row 'i' of the current column
-static void set_queen(const uint32_t row_i, struct chess_board *board)
-{
-    board->queen_positions[board->column_j] = row_i;
-    board->column[row_i] = 0;
-    board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] = 0;
-    board->diagonal_down[board->column_j + row_i] = 0;
-    ++board->column_j;
-    ++board->placements;
-}
-
-// Removes a queen from the NxN chess board in the given column to backtrack
-static void remove_queen(const uint32_t row_i, struct chess_board *board)
-{
-    --board->column_j;
-    board->diagonal_down[board->column_j + row_i] = 1;
-    board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] = 1;
-    board->column[row_i] = 1;
-}
 
 // Recursive function for finding valid queen placements on the chess board
 uint64_t place_next_queen_parallel(struct chess_board *board)
@@ -201,16 +112,42 @@ int main(int argc, char *argv[])
 
     struct chess_board *board;
 
-    //devide the first colonne between processes
-    uint32_t start = rank * row_boundary / num_procs;
-    uint32_t end = (rank + 1) * row_boundary / num_procs;
+    // Weigh each row of the first column by its estimated subtree size (fixed
+    // seed: every rank gets the same weights) and divide the column by weight
+    uint32_t *rows = malloc(sizeof(uint32_t) * row_boundary);
+    double *weights = malloc(sizeof(double) * row_boundary);
+    uint64_t *bounds = malloc(sizeof(uint64_t) * (num_procs + 1));
+    if (rows == NULL || weights == NULL || bounds == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed for the row weights.\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    for (uint32_t row = 0; row < row_boundary; ++row)
+    {
+        rows[row] = row;
+    }
+    estimator_frontier(n_queens, rows, 1, row_boundary, 1, ESTIMATOR_DEFAULT_SAMPLES, weights);
+    estimator_weighted_split(weights, row_boundary, num_procs, bounds);
+    uint32_t start = (uint32_t)bounds[rank];
+    uint32_t end = (uint32_t)bounds[rank + 1];
+    free(bounds);
+    free(weights);
+    free(rows);
     initialize_board(n_queens, &board, start, end);  
 
+    WORKER_STATS stats;
+    telemetry_reset(&stats);
+    const double task_start = telemetry_now();
     uint64_t solutions = place_next_queen_parallel(board);
+    // each rank's slice of the first column is a single task
+    telemetry_task_done(&stats, board->placements, telemetry_now() - task_start);
 
     uint64_t total_solutions = 0;
     //Perform reduction operation to gather the local solutions from each process and compute the total solutions
     MPI_Reduce(&solutions, &total_solutions, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+    // Gather the per-rank load counters alongside the reduction
+    WORKER_STATS *all_stats = rank == 0 ? malloc(sizeof(WORKER_STATS) * num_procs) : NULL;
+    MPI_Gather(&stats, sizeof(WORKER_STATS), MPI_BYTE, all_stats, sizeof(WORKER_STATS), MPI_BYTE, 0, MPI_COMM_WORLD);
     
     // Print the total number of solutions from the root process
     if (rank == 0) {
@@ -218,6 +155,16 @@ int main(int argc, char *argv[])
         double time_totale = (double)(end_time-start_time)/CLOCKS_PER_SEC;
         printf("program takes : %f s \n",time_totale);
         printf("The %u-Queens problem has %lu solutions\n", n_queens, total_solutions);
+        // Ranks that finish early wait for the slowest one
+        double longest = 0.0;
+        for (int r = 0; r < num_procs; r++) {
+            longest = all_stats[r].busy > longest ? all_stats[r].busy : longest;
+        }
+        for (int r = 0; r < num_procs; r++) {
+            telemetry_idle(&all_stats[r], longest - all_stats[r].busy);
+        }
+        telemetry_report("rank", all_stats, num_procs);
+        free(all_stats);
     }
 
     // Clean up the MPI environment
@@ -231,6 +178,5 @@ int main(int argc, char *argv[])
 }
 
 
-
     
 
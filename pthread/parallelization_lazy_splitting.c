@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "../common/n_queens_affinity.h"
+#include "../common/n_queens_telemetry.h"
+#include "../common/n_queens_task_pool.h"
+#include "../common/n_queens_core.h"
+// Le nombre de threads
+#define THREAD_NUM 16
+
+// Découpage paresseux : le thread principal soumet une seule tâche (tout
+// l'arbre) et chaque thread parcourt son sous-arbre séquentiellement. Dans les
+// colonnes peu profondes il teste le drapeau "un thread a faim" de la file ;
+// s'il est levé, il détache les lignes pas encore essayées de sa colonne la
+// moins profonde en une nouvelle tâche. Le nombre de tâches suit l'inactivité
+// réelle au lieu d'un niveau fixé à l'avance.
+
+typedef CHESS_BOARD Board;
+
+typedef Board *Task;
+
+// état de parcours d'un thread
+typedef struct worker_state
+{
+    Board *board;
+    // prochaine ligne à essayer et borne (exclue) de chaque colonne en cours ;
+    // row_end est réduite quand des lignes sont détachées
+    uint32_t *row_next;
+    uint32_t *row_end;
+    // première colonne de la tâche en cours
+    uint32_t base;
+    WORKER_STATS *stats;
+} WORKER;
+
+// mutex pour accéder au solutions
+pthread_mutex_t mutexSolutions;
+TASK_POOL taskPool;
+// le nombre total de solutions
+uint64_t numberOfSolutions = 0;
+// les colonnes < split_depth testent le drapeau et peuvent être découpées
+uint32_t split_depth;
+// compteurs de charge de chaque thread, alloués par le thread sur son noeud
+WORKER_STATS *workerStats[THREAD_NUM];
+
+
+// copier une tâche dans l'échiquier local du thread
+static void load_task(struct chess_board *local, struct chess_board *task)
+{
+    const uint32_t total_size = 2 * (task->n_size + 2 * task->n_size - 1);
+    memcpy(local->queen_positions, task->queen_positions, sizeof(uint32_t) * total_size);
+    local->column_j = task->column_j;
+    local->start = task->start;
+    local->end = task->end;
+}
+
+// détacher les lignes non essayées de la colonne en cours la moins profonde :
+// c'est là que reste le plus de travail
+static void split_work(WORKER *w)
+{
+    Board *board = w->board;
+    for (uint32_t k = w->base; k <= board->column_j && k < split_depth; ++k)
+    {
+        if (w->row_next[k] >= w->row_end[k])
+        {
+            continue;
+        }
+        Task task;
+        initialize_board(board->n_size, &task, w->row_next[k], w->row_end[k]);
+        for (uint32_t j = 0; j < k; ++j)
+        {
+            set_queen(board->queen_positions[j], task);
+        }
+        task->placements = 0;
+        w->row_end[k] = w->row_next[k];
+        ++w->stats->steals;
+        pool_submit(&taskPool, task, 0);
+        return;
+    }
+}
+
+static void lazy_search(WORKER *w)
+{
+    Board *board = w->board;
+    const uint32_t j = board->column_j;
+    w->row_end[j] = board->end;
+    w->row_next[j] = board->start;
+    while (w->row_next[j] < w->row_end[j])
+    {
+        const uint32_t row_i = w->row_next[j]++;
+        // les lignes [row_next, row_end) ne sont pas encore essayées
+        if (j < split_depth && pool_hungry(&taskPool))
+        {
+            split_work(w);
+        }
+        if (square_is_free(row_i, board))
+        {
+            set_queen(row_i, board);
+            if (board->column_j == board->n_size)
+            {
+                board->solutions += 2;
+            }
+            else
+            {
+                // symétrie : la reine du milieu en colonne 0 limite la colonne 1
+                board->start = 0;
+                board->end = (j == 0 && row_i == board->n_size >> 1) ? board->n_size >> 1 : board->n_size;
+                lazy_search(w);
+            }
+            remove_queen(row_i, board);
+        }
+    }
+}
+
+// la fonction executé par chaque thread
+void *startThread(void *args)
+{
+    const uint32_t worker = (uint32_t)(uintptr_t)args;
+    placement_bind_worker(worker);
+    WORKER_STATS *stats = placement_alloc_local(sizeof(WORKER_STATS));
+    workerStats[worker] = stats;
+
+    WORKER w;
+    w.board = NULL;
+    w.row_next = NULL;
+    w.row_end = NULL;
+    w.stats = stats;
+
+    while (1)
+    {
+        const double wait_start = telemetry_now();
+        Task task = pool_take(&taskPool);
+        if (task == NULL)
+        {
+            telemetry_idle(stats, telemetry_now() - wait_start);
+            break;
+        }
+        const double task_start = telemetry_now();
+        telemetry_idle(stats, task_start - wait_start);
+        if (w.board == NULL)
+        {
+            // alloués après le placement du thread (first touch)
+            initialize_board(task->n_size, &w.board, 0, 0);
+            w.row_next = placement_alloc_local(sizeof(uint32_t) * task->n_size);
+            w.row_end = placement_alloc_local(sizeof(uint32_t) * task->n_size);
+        }
+        load_task(w.board, task);
+        smash_board(task);
+        w.base = w.board->column_j;
+        const uint64_t placements = w.board->placements;
+        lazy_search(&w);
+        telemetry_task_done(stats, w.board->placements - placements, telemetry_now() - task_start);
+        // les lignes détachées sont déjà soumises
+        pool_task_done(&taskPool);
+    }
+
+    // ajouter les solutions du thread une seule fois, à sa sortie
+    if (w.board != NULL)
+    {
+        pthread_mutex_lock(&mutexSolutions);
+        numberOfSolutions += w.board->solutions;
+        pthread_mutex_unlock(&mutexSolutions);
+        smash_board(w.board);
+        free(w.row_next);
+        free(w.row_end);
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t default_n = 16;
+    const uint32_t n_queens = (argc > 1) ? (uint32_t)atoi(argv[1]) : default_n;
+    // profondeur de découpage, par défaut la moitié de l'échiquier
+    split_depth = (argc > 2) ? (uint32_t)atoi(argv[2]) : n_queens / 2;
+    if (n_queens < 1)
+    {
+        fprintf(stderr, "The number of queens must be greater than 0.\n");
+        exit(EXIT_SUCCESS);
+    }
+    const uint32_t row_boundary = (n_queens >> 1) + (n_queens & 1);
+    pthread_t th[THREAD_NUM];
+    pthread_mutex_init(&mutexSolutions, NULL);
+    pool_init(&taskPool, POOL_FIFO);
+    // placement des threads selon NQ_PLACEMENT (compact, scatter, cores)
+    placement_init(PLACEMENT_NONE);
+    const double start_time = telemetry_now();
+    int i;
+    for (i = 0; i < THREAD_NUM; i++)
+    {
+        if (pthread_create(&th[i], NULL, &startThread, (void *)(uintptr_t)i) != 0)
+        {
+            perror("Failed to create the thread");
+        }
+    }
+    // une seule tâche : l'arbre entier, découpé à la demande
+    Task root;
+    initialize_board(n_queens, &root, 0, row_boundary);
+    pool_submit(&taskPool, root, 0);
+    pool_close(&taskPool);
+    for (i = 0; i < THREAD_NUM; i++)
+    {
+        if (pthread_join(th[i], NULL) != 0)
+        {
+            perror("Failed to join the thread");
+        }
+    }
+    const double time_totale = telemetry_now() - start_time;
+    // N = 1 : la seule solution est sur la ligne du milieu, comptée une fois
+    if (n_queens == 1)
+    {
+        numberOfSolutions = 1;
+    }
+    printf("N = %u : Nombre de solution global : %" PRIu64 " dans : %f s (profondeur de découpage %u)\n",
+           n_queens, numberOfSolutions, time_totale, split_depth);
+    // résumé de l'équilibrage ; "steals" compte les tâches détachées
+    WORKER_STATS stats[THREAD_NUM];
+    for (i = 0; i < THREAD_NUM; i++)
+    {
+        stats[i] = *workerStats[i];
+        free(workerStats[i]);
+    }
+    placement_report(THREAD_NUM);
+    telemetry_report("worker", stats, THREAD_NUM);
+    pool_destroy(&taskPool);
+    pthread_mutex_destroy(&mutexSolutions);
+    return 0;
+}
@@ -4,109 +4,17 @@
 #include <string.h>
 #include <pthread.h>
 #include <time.h>
+#include "../common/n_queens_affinity.h"
+#include "../common/n_queens_telemetry.h"
+#include "../common/n_queens_estimator.h"
+#include "../common/n_queens_core.h"
 
 pthread_mutex_t solutions_mutex;
 uint64_t total_solutions = 0; // Shared variable to store the sum of solutions
 
 // An abstract representation of an NxN chess board to tracking open positions
-struct chess_board
-{
-    uint32_t n_size;           // Number of queens on the NxN chess board
-    uint32_t *queen_positions; // Store queen positions on the board
-    uint32_t *column;          // Store available column moves/attacks
-    uint32_t *diagonal_up;     // Store available diagonal moves/attacks
-    uint32_t *diagonal_down;
-    uint32_t column_j;   // Stores column to place the next queen in
-    uint64_t placements; // Tracks total number queen placements
-    uint64_t solutions;  // Tracks number of solutions
-    uint64_t start;
-    uint64_t end;
-};
 struct chess_board *board;
 
-// Handles dynamic memory allocation of the arrays and sets initial values
-static void initialize_board(const uint32_t n_queens, struct chess_board **board, uint32_t start, uint32_t end)
-{
-    if (n_queens < 1)
-    {
-        fprintf(stderr, "The number of queens must be greater than 0.\n");
-        exit(EXIT_SUCCESS);
-    }
-
-    // Dynamically allocate memory for chessboard struct
-    *board = malloc(sizeof(struct chess_board));
-    if (*board == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed for chess board.\n");
-        exit(EXIT_FAILURE);
-    }
-
-    // Dynamically allocate memory for chessboard arrays that track positions
-    const uint32_t diagonal_size = 2 * n_queens - 1;
-    const uint32_t total_size = 2 * (n_queens + diagonal_size);
-    (*board)->queen_positions = malloc(sizeof(uint32_t) * total_size);
-    if ((*board)->queen_positions == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed for the chess board arrays.\n");
-        free(*board);
-        exit(EXIT_FAILURE);
-    }
-    (*board)->column = &(*board)->queen_positions[n_queens];
-    (*board)->diagonal_up = &(*board)->column[n_queens];
-    (*board)->diagonal_down = &(*board)->diagonal_up[diagonal_size];
-
-    // Initialize the chess board parameters
-    (*board)->n_size = n_queens;
-    for (uint32_t i = 0; i < n_queens; ++i)
-    {
-        (*board)->queen_positions[i] = 0;
-    }
-    for (uint32_t i = n_queens; i < total_size; ++i)
-    {
-        // Initializes values for column, diagonal_up, and diagonal_down
-        (*board)->queen_positions[i] = 1;
-    }
-    (*board)->column_j = 0;
-    (*board)->placements = 0;
-    (*board)->solutions = 0;
-    (*board)->start = start;
-    (*board)->end = end;
-}
-
-// Frees the dynamically allocated memory for the chess board structure
-static void smash_board(struct chess_board *board)
-{
-    free(board->queen_positions);
-    free(board);
-}
-
-// Check if a queen can be placed in at row 'i' of the current column
-static uint32_t square_is_free(const uint32_t row_i, struct chess_board *board)
-{
-    return board->column[row_i] &
-           board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] &
-           board->diagonal_down[board->column_j + row_i];
-}
-
-// Place a queen on the chess board at row 'i' of the current column
-static void set_queen(const uint32_t row_i, struct chess_board *board)
-{
-    board->queen_positions[board->column_j] = row_i;
-    board->column[row_i] = 0;
-    board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] = 0;
-    board->diagonal_down[board->column_j + row_i] = 0;
-    ++board->column_j;
-    ++board->placements;
-}
-
-// Removes a queen from the NxN chess board in the given column to backtrack
-static void remove_queen(const uint32_t row_i, struct chess_board *board)
-{
-    --board->column_j;
-    board->diagonal_down[board->column_j + row_i] = 1;
-    board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] = 1;
-    board->column[row_i] = 1;
-}
 
 // Prints the number of queen placements and solutions for the NxN chess board
 static void print_counts(struct chess_board *board)
@@ -157,11 +65,31 @@ uint64_t place_next_queen(struct chess_board *board)
     return board->solutions;
 }
 
+// Rows of the first column given to one worker thread
+struct worker_args
+{
+    uint32_t worker;
+    uint32_t n_queens;
+    uint32_t start;
+    uint32_t end;
+    WORKER_STATS *stats;
+};
+
 // Wrapper function for pthread_create
 static void *place_next_queen_wrapper(void *arg)
 {
-    struct chess_board *board = (struct chess_board *)arg;
+    struct worker_args *args = (struct worker_args *)arg;
+    struct chess_board *board;
+
+    // Pin the thread first, then allocate its board so the pages are touched
+    // first (and therefore placed) on the worker's own NUMA node
+    placement_bind_worker(args->worker);
+    initialize_board(args->n_queens, &board, args->start, args->end);
+    const double task_start = telemetry_now();
     uint64_t solutions = place_next_queen(board);
+    // The whole row range is one task for this static split
+    telemetry_task_done(args->stats, board->placements, telemetry_now() - task_start);
+    smash_board(board);
 
     pthread_mutex_lock(&solutions_mutex);
     total_solutions += solutions;
@@ -184,16 +112,35 @@ int main(int argc, char *argv[])
     const uint32_t row_boundary = (n_queens >> 1) + (n_queens & 1);
 
     pthread_t threads[num_threads];
+    struct worker_args args[num_threads];
+    WORKER_STATS stats[num_threads];
     pthread_mutex_init(&solutions_mutex, NULL);
 
+    // Thread placement policy from NQ_PLACEMENT (compact, scatter, cores)
+    placement_init(PLACEMENT_NONE);
+
+    // Split the rows of the first column by estimated subtree size rather than
+    // by row count: the subtrees of the outer rows are much smaller
+    uint32_t rows[row_boundary];
+    double weights[row_boundary];
+    uint64_t bounds[num_threads + 1];
+    for (uint32_t r = 0; r < row_boundary; r++)
+    {
+        rows[r] = r;
+    }
+    estimator_frontier(n_queens, rows, 1, row_boundary, 1, ESTIMATOR_DEFAULT_SAMPLES, weights);
+    estimator_weighted_split(weights, row_boundary, num_threads, bounds);
+
     for (uint32_t i = 0; i < num_threads; i++)
     {
         // printf("Thread 1\n");
-        struct chess_board *board;
-        uint32_t start = i * row_boundary / num_threads;
-        uint32_t end = (i + 1) * row_boundary / num_threads;
-        initialize_board(n_queens, &board, start, end);
-        pthread_create(&threads[i], NULL, place_next_queen_wrapper, (void *)board);
+        args[i].worker = i;
+        args[i].n_queens = n_queens;
+        args[i].start = bounds[i];
+        args[i].end = bounds[i + 1];
+        args[i].stats = &stats[i];
+        telemetry_reset(&stats[i]);
+        pthread_create(&threads[i], NULL, place_next_queen_wrapper, (void *)&args[i]);
     }
 
     for (uint32_t i = 0; i < num_threads; i++)
@@ -214,5 +161,18 @@ int main(int argc, char *argv[])
 
     printf("The %u-Queens problem has %lu solutions\n", n_queens, total_solutions);
 
+    // Workers that finish early wait for the slowest one
+    double longest = 0.0;
+    for (uint32_t i = 0; i < num_threads; i++)
+    {
+        longest = stats[i].busy > longest ? stats[i].busy : longest;
+    }
+    for (uint32_t i = 0; i < num_threads; i++)
+    {
+        telemetry_idle(&stats[i], longest - stats[i].busy);
+    }
+    placement_report(num_threads);
+    telemetry_report("worker", stats, num_threads);
+
     return EXIT_SUCCESS;
 }
\ No newline at end of file
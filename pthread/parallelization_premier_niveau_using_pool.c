@@ -6,162 +6,98 @@
 #include <time.h>
 #include <inttypes.h>
 #include <sys/time.h>
+#include <errno.h>
+#include "../common/n_queens_affinity.h"
+#include "../common/n_queens_telemetry.h"
+#include "../common/n_queens_estimator.h"
+#include "../common/n_queens_task_pool.h"
+#include "../common/n_queens_core.h"
 
 #define THREAD_NUM 8
 
-typedef struct chess_board{
-    uint32_t n_size;           
-    uint32_t *queen_positions; 
-    uint32_t *column;          
-    uint32_t *diagonal_up;     
-    uint32_t *diagonal_down;
-    uint32_t column_j;   
-    uint64_t placements; 
-    uint64_t solutions;  
-    uint64_t start;
-    uint64_t end;
-} Board;
+typedef CHESS_BOARD Board;
 
 typedef Board *Task;
 
 
-pthread_mutex_t mutexQueue;
-pthread_cond_t condQueue;
 pthread_mutex_t mutexSolutions;
 
-Task taskQueue[10];
-uint64_t taskCount = 0;
+// Task queue, served in submission order (fifo) or largest estimated subtree first (lpt)
+TASK_POOL taskPool;
 uint64_t numberOfSolutions = 0;
+// Per-worker load counters, allocated by each worker on its own node
+WORKER_STATS *workerStats[THREAD_NUM];
 
 void place_next_queen_thread(struct chess_board *board);
 
 
-static void initialize_board(const uint32_t n_queens, struct chess_board **board, uint32_t start, uint32_t end)
-{
-    if (n_queens < 1)
-    {
-        fprintf(stderr, "The number of queens must be greater than 0.\n");
-        exit(EXIT_SUCCESS);
-    }
-
-    // Dynamically allocate memory for chessboard struct
-    *board = malloc(sizeof(struct chess_board));
-    if (*board == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed for chess board.\n");
-        exit(EXIT_FAILURE);
-    }
-
-    // Dynamically allocate memory for chessboard arrays that track positions
-    const uint32_t diagonal_size = 2 * n_queens - 1;
-    const uint32_t total_size = 2 * (n_queens + diagonal_size);
-    (*board)->queen_positions = malloc(sizeof(uint32_t) * total_size);
-    if ((*board)->queen_positions == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed for the chess board arrays.\n");
-        free(*board);
-        exit(EXIT_FAILURE);
-    }
-    (*board)->column = &(*board)->queen_positions[n_queens];
-    (*board)->diagonal_up = &(*board)->column[n_queens];
-    (*board)->diagonal_down = &(*board)->diagonal_up[diagonal_size];
-
-    // Initialize the chess board parameters
-    (*board)->n_size = n_queens;
-    for (uint32_t i = 0; i < n_queens; ++i)
-    {
-        (*board)->queen_positions[i] = 0;
-    }
-    for (uint32_t i = n_queens; i < total_size; ++i)
-    {
-        // Initializes values for column, diagonal_up, and diagonal_down
-        (*board)->queen_positions[i] = 1;
-    }
-    (*board)->column_j = 0;
-    (*board)->placements = 0;
-    (*board)->solutions = 0;
-    (*board)->start = start;
-    (*board)->end = end;
-}
-
-
-// Check if a queen can be placed in at row 'i' of the current column
-static uint32_t square_is_free(const uint32_t row_i, struct chess_board *board)
-{
-    return board->column[row_i] &
-           board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] &
-           board->diagonal_down[board->column_j + row_i];
-}
-
-// Place a queen on the chess board at row 'i' of the current column
-static void set_queen(const uint32_t row_i, struct chess_board *board)
-{
-    board->queen_positions[board->column_j] = row_i;
-    board->column[row_i] = 0;
-    board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] = 0;
-    board->diagonal_down[board->column_j + row_i] = 0;
-    ++board->column_j;
-    ++board->placements;
+void executeTask(Task* task) {
+    place_next_queen_thread(*task);
 }
 
-// Removes a queen from the NxN chess board in the given column to backtrack
-static void remove_queen(const uint32_t row_i, struct chess_board *board)
+// Copy a task into the worker's own board, allocated by the worker after it
+// was pinned so that its pages live on the worker's NUMA node
+static void load_task(struct chess_board **local, struct chess_board *task)
 {
-    --board->column_j;
-    board->diagonal_down[board->column_j + row_i] = 1;
-    board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] = 1;
-    board->column[row_i] = 1;
+    if (*local == NULL)
+    {
+        initialize_board(task->n_size, local, 0, 0);
+    }
+    const uint32_t total_size = 2 * (task->n_size + 2 * task->n_size - 1);
+    memcpy((*local)->queen_positions, task->queen_positions, sizeof(uint32_t) * total_size);
+    (*local)->column_j = task->column_j;
+    (*local)->start = task->start;
+    (*local)->end = task->end;
 }
 
-void executeTask(Task* task) {
-    place_next_queen_thread(*task);
-}
 
 void submitTask(Task *task) {
-    pthread_mutex_lock(&mutexQueue);
-    taskQueue[taskCount] = (*task);
-    taskCount++;
-    pthread_mutex_unlock(&mutexQueue);
-    pthread_cond_signal(&condQueue);
+    double priority = 0;
+    if (taskPool.order == POOL_LPT) {
+        // One seed per first-column row, so that runs are reproducible
+        uint64_t seed = 0x9E3779B97F4A7C15ULL ^ ((*task)->queen_positions[0] + 1) * 0xBF58476D1CE4E5B9ULL;
+        priority = estimator_subtree((*task)->n_size, (*task)->queen_positions, (*task)->column_j,
+                                     ESTIMATOR_DEFAULT_SAMPLES, &seed);
+    }
+    pool_submit(&taskPool, *task, priority);
 }
 
 
-
-
 void* startThread(void* args) {
-    while (1) {
-        Task task;
-
-        pthread_mutex_lock(&mutexQueue);
-        struct timespec timeout;
-        struct timeval now;
+    struct chess_board *local = NULL;
+    const uint32_t worker = (uint32_t)(uintptr_t)args;
+    placement_bind_worker(worker);
+    WORKER_STATS *stats = placement_alloc_local(sizeof(WORKER_STATS));
+    workerStats[worker] = stats;
 
-        // Get the current time
-        gettimeofday(&now, NULL);
-
-        timeout.tv_sec = now.tv_sec + 2;
-        timeout.tv_nsec = now.tv_usec * 1000;
-
-        while (taskCount == 0) {
-            if (pthread_cond_timedwait(&condQueue, &mutexQueue, &timeout) == ETIMEDOUT) {
-                pthread_mutex_unlock(&mutexQueue);
-                return NULL; // Exit the thread
+    while (1) {
+        const double wait_start = telemetry_now();
+        // NULL once the queue is closed and every task is finished
+        Task task = pool_take(&taskPool);
+        if (task == NULL) {
+            // The final wait is the tail of the run and counts as idle time
+            telemetry_idle(stats, telemetry_now() - wait_start);
+            // The worker's solutions are added once, when it exits
+            if (local != NULL) {
+                pthread_mutex_lock(&mutexSolutions);
+                numberOfSolutions += local->solutions;
+                pthread_mutex_unlock(&mutexSolutions);
+                smash_board(local);
             }
+            return NULL;
         }
-
-        task = taskQueue[0];
-        int i;
-        for (i = 0; i < taskCount - 1; i++) {
-            taskQueue[i] = taskQueue[i + 1];
-        }
-        taskCount--;
-        pthread_mutex_unlock(&mutexQueue);
-        executeTask(&task);
+        const double task_start = telemetry_now();
+        telemetry_idle(stats, task_start - wait_start);
+        load_task(&local, task);
+        smash_board(task);
+        const uint64_t placements = local->placements;
+        executeTask(&local);
+        telemetry_task_done(stats, local->placements - placements, telemetry_now() - task_start);
+        pool_task_done(&taskPool);
     }
 }
 
 
-
 void place_next_queen(struct chess_board *board)
 {
     uint64_t start = board->start;
@@ -215,9 +151,7 @@ void place_next_queen_thread(struct chess_board *board)
             set_queen(row_i, board);
             if (board->column_j == board->n_size)
             {
-                pthread_mutex_lock(&mutexSolutions);
-                numberOfSolutions += 2;
-                pthread_mutex_unlock(&mutexSolutions);
+                board->solutions += 2;
             }
             else if (board->queen_positions[0] != middle)
             {
@@ -241,35 +175,49 @@ int main(int argc, char* argv[]) {
     const uint32_t n_queens = (argc != 1) ? (uint32_t)atoi(argv[1]) : default_n;
     const uint32_t row_boundary = (n_queens >> 1) + (n_queens & 1);
 
+    // Task order: fifo (default) or lpt
+    const POOL_ORDER order = pool_order_from_string((argc > 2) ? argv[2] : NULL);
+
     pthread_t th[THREAD_NUM];
-    pthread_mutex_init(&mutexQueue, NULL);
     pthread_mutex_init(&mutexSolutions, NULL);
-    pthread_cond_init(&condQueue, NULL);
+    pool_init(&taskPool, order);
+    printf("task order : %s\n", order == POOL_LPT ? "lpt" : "fifo");
     Board *board;
 
-    clock_t start_time = clock();
+    // Thread placement policy from NQ_PLACEMENT (compact, scatter, cores)
+    placement_init(PLACEMENT_NONE);
+
+    const double start_time = telemetry_now();
 
     int i;
     for (i = 0; i < THREAD_NUM; i++) {
-        if (pthread_create(&th[i], NULL, &startThread, NULL) != 0) {
+        if (pthread_create(&th[i], NULL, &startThread, (void *)(uintptr_t)i) != 0) {
             perror("Failed to create the thread");
         }
     }
 
     initialize_board(n_queens, &board, 0 , row_boundary);
     place_next_queen(board);
+    // The main thread will not submit anything else
+    pool_close(&taskPool);
 
     for (i = 0; i < THREAD_NUM; i++) {
         if (pthread_join(th[i], NULL) != 0) {
             perror("Failed to join the thread");
         }
     }
-    clock_t end_time = clock();
-
-    double time_totale = (double)(end_time-start_time)/CLOCKS_PER_SEC;
-    printf("Nombre de solution global : %d Dans : %f s \n",numberOfSolutions,time_totale-2);
+    double time_totale = telemetry_now() - start_time;
+    printf("Nombre de solution global : %" PRIu64 " Dans : %f s \n",numberOfSolutions,time_totale);
+    // Gather the per-worker counters for the load-balance summary
+    WORKER_STATS stats[THREAD_NUM];
+    for (i = 0; i < THREAD_NUM; i++) {
+        stats[i] = *workerStats[i];
+        free(workerStats[i]);
+    }
+    placement_report(THREAD_NUM);
+    telemetry_report("worker", stats, THREAD_NUM);
 
-    pthread_mutex_destroy(&mutexQueue);
-    pthread_cond_destroy(&condQueue);
+    pool_destroy(&taskPool);
+    pthread_mutex_destroy(&mutexSolutions);
     return 0;
 }
\ No newline at end of file
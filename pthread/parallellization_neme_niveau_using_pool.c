@@ -6,253 +6,150 @@
 #include <time.h>
 #include <inttypes.h>
 #include <sys/time.h>
+#include <errno.h>
+#include "../common/n_queens_affinity.h"
+#include "../common/n_queens_telemetry.h"
+#include "../common/n_queens_estimator.h"
+#include "../common/n_queens_task_pool.h"
+#include "../common/n_queens_core.h"
+#include "../common/n_queens_frontier.h"
 // Le nombre de threads
 #define THREAD_NUM 16
 // Le niveau ou s'arrète la parallèlisation des tâches
 #define level 1
+// Nombre de préfixes pris d'un coup dans le générateur
+#define BATCH_SIZE 16
+// Avec N = 0, chaque N de 1 à CHECK_MAX_N est compté dans les deux ordres et
+// comparé à nq_count
+#define CHECK_MAX_N 12
 
-typedef struct chess_board
-{
-    uint32_t n_size;
-    uint32_t *queen_positions;
-    uint32_t *column;
-    uint32_t *diagonal_up;
-    uint32_t *diagonal_down;
-    uint32_t column_j;
-    uint64_t placements;
-    // start et end pour définir les bordures des valeurs des positions à parcourir possibles d'une queen de position j
-    uint64_t start;
-    uint64_t end;
-} Board;
+typedef CHESS_BOARD Board;
 // un pointeur vers un echéquier qui simule une tâche dans la file
 typedef Board *Task;
-// mutex pour accéder â le queue
-pthread_mutex_t mutexQueue;
-// pour signaler aux threads qu'il existe une tâche dans la file
-pthread_cond_t condQueue;
 // mutex pour accéder au solutions
 pthread_mutex_t mutexSolutions;
 
-// file des tâches de taille assez grande
-Task taskQueue[400];
-// pour compter le nombre de tâches dans la file
-uint64_t taskCount = 0;
+// file des tâches par sous-arbre estimé décroissant (lpt) : elle doit connaître
+// toutes les tâches pour les ordonner
+TASK_POOL taskPool;
+// préfixes de level + 1 colonnes produits à la demande : en fifo les threads y
+// puisent directement par lots, sans file, dès le lancement
+NQ_PREFIX_STREAM taskStream;
+uint32_t n_queens_global;
 // le nombre total de solutions
 uint64_t numberOfSolutions = 0;
+// compteurs de charge de chaque thread, alloués par le thread sur son noeud
+WORKER_STATS *workerStats[THREAD_NUM];
 
 void place_next_queen_thread(struct chess_board *board);
-void place_next_queen(struct chess_board *board);
-void place_next_queen_without_parallelization(struct chess_board *board);
-static void initialize_board(const uint32_t n_queens, struct chess_board **board, uint32_t start, uint32_t end)
-{
-    if (n_queens < 1)
-    {
-        fprintf(stderr, "The number of queens must be greater than 0.\n");
-        exit(EXIT_SUCCESS);
-    }
+void place_next_queen_without_parallelization(struct chess_board *board, uint32_t row_boundary);
 
-    // Dynamically allocate memory for chessboard struct
-    *board = malloc(sizeof(struct chess_board));
-    if (*board == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed for chess board.\n");
-        exit(EXIT_FAILURE);
-    }
 
-    const uint32_t diagonal_size = 2 * n_queens - 1;
-    const uint32_t total_size = 2 * (n_queens + diagonal_size);
-    (*board)->queen_positions = malloc(sizeof(uint32_t) * total_size);
-    if ((*board)->queen_positions == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed for the chess board arrays.\n");
-        free(*board);
-        exit(EXIT_FAILURE);
-    }
-    (*board)->column = &(*board)->queen_positions[n_queens];
-    (*board)->diagonal_up = &(*board)->column[n_queens];
-    (*board)->diagonal_down = &(*board)->diagonal_up[diagonal_size];
-
-    (*board)->n_size = n_queens;
-    for (uint32_t i = 0; i < n_queens; ++i)
-    {
-        (*board)->queen_positions[i] = 0;
-    }
-    for (uint32_t i = n_queens; i < total_size; ++i)
-    {
-        (*board)->queen_positions[i] = 1;
-    }
-    (*board)->column_j = 0;
-    (*board)->placements = 0;
-    (*board)->start = start;
-    (*board)->end = end;
-}
-// pour créer une copie de l'échiquier
-struct chess_board *copyBoard(struct chess_board *board)
+// copier une tâche dans l'échiquier local du thread, alloué par le thread
+// lui-même après son placement pour que ses pages soient sur son noeud NUMA
+static void load_task(struct chess_board **local, struct chess_board *task)
 {
-    Task task = malloc(sizeof(struct chess_board));
-
-    if (board->n_size < 1)
-    {
-        fprintf(stderr, "The number of queens must be greater than 0.\n");
-        exit(EXIT_SUCCESS);
-    }
-    task = malloc(sizeof(struct chess_board));
-    if (task == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed for chess board.\n");
-        exit(EXIT_FAILURE);
-    }
-    const uint32_t diagonal_size = 2 * board->n_size - 1;
-    const uint32_t total_size = 2 * (board->n_size + diagonal_size);
-    (task)->queen_positions = malloc(sizeof(uint32_t) * total_size);
-    if ((task)->queen_positions == NULL)
+    if (*local == NULL)
     {
-        fprintf(stderr, "Memory allocation failed for the chess board arrays.\n");
-        free(task);
-        exit(EXIT_FAILURE);
+        initialize_board(task->n_size, local, 0, 0);
     }
-    (task)->column = &(task)->queen_positions[board->n_size];
-    (task)->diagonal_up = &(task)->column[board->n_size];
-    (task)->diagonal_down = &(task)->diagonal_up[diagonal_size];
-    (task)->n_size = board->n_size;
-    for (uint32_t i = 0; i < board->n_size; ++i)
-    {
-        task->queen_positions[i] = board->queen_positions[i];
-    }
-    for (uint32_t i = board->n_size; i < total_size; ++i)
-    {
-        task->queen_positions[i] = board->queen_positions[i];
-    }
-    task->column_j = board->column_j;
-    task->placements = board->placements;
-    task->start = board->start;
-    task->end = board->end;
-    return task;
+    const uint32_t total_size = 2 * (task->n_size + 2 * task->n_size - 1);
+    memcpy((*local)->queen_positions, task->queen_positions, sizeof(uint32_t) * total_size);
+    (*local)->column_j = task->column_j;
+    (*local)->placements = task->placements;
+    (*local)->start = task->start;
+    (*local)->end = task->end;
 }
 
-static void smash_board(struct chess_board *board)
-{
-    free(board->queen_positions);
-    free(board);
-}
 
-static void set_queen(const uint32_t row_i, struct chess_board *board)
-{
-    board->queen_positions[board->column_j] = row_i;
-    board->column[row_i] = 0;
-    board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] = 0;
-    board->diagonal_down[board->column_j + row_i] = 0;
-    ++board->column_j;
-    ++board->placements;
-}
-
-static void remove_queen(const uint32_t row_i, struct chess_board *board)
-{
-    --board->column_j;
-    board->diagonal_down[board->column_j + row_i] = 1;
-    board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)] = 1;
-    board->column[row_i] = 1;
-}
-// la tâche à executer par le thread
-void executeTask(Task *task)
+// pour ajouter une tâche dans la file, avec la taille estimée de son sous-arbre
+// comme priorité quand les plus grosses tâches passent en premier
+void submitTask(Task *task)
 {
-    // vérifier si on est arrivé au niveau de parallélisation désiré
-    if ((*task)->column_j <= level)
+    double priority = 0;
+    if (taskPool.order == POOL_LPT)
     {
-        // on ajoute des tâches
-        place_next_queen(*task);
-    }
-    // sinon on execute la tâche
-    else
-    {
-        place_next_queen_thread(*task);
+        uint64_t seed = 0x9E3779B97F4A7C15ULL ^ ((*task)->placements + 1) * 0xBF58476D1CE4E5B9ULL;
+        for (uint32_t j = 0; j < (*task)->column_j; ++j)
+        {
+            seed = seed * 31 + (*task)->queen_positions[j];
+        }
+        priority = estimator_subtree((*task)->n_size, (*task)->queen_positions, (*task)->column_j,
+                                     ESTIMATOR_DEFAULT_SAMPLES, &seed);
     }
-}
-// pour ajouter une tâche dans la file
-void submitTask(Task *task)
-{
-    pthread_mutex_lock(&mutexQueue);
-    taskQueue[taskCount] = (*task);
-    taskCount++;
-    pthread_mutex_unlock(&mutexQueue);
-    pthread_cond_signal(&condQueue);
+    pool_submit(&taskPool, *task, priority);
 }
 // la fonction executé par chaque thread
 void *startThread(void *args)
 {
-    while (1)
-    {
-        Task task;
+    // l'échiquier local et le compteur de solutions du thread
+    struct chess_board *local = NULL;
+    const uint32_t worker = (uint32_t)(uintptr_t)args;
+    placement_bind_worker(worker);
+    WORKER_STATS *stats = placement_alloc_local(sizeof(WORKER_STATS));
+    workerStats[worker] = stats;
 
-        pthread_mutex_lock(&mutexQueue);
-        // pour tuer le thread s'il ne prend pas de tâche dans cette durée
-        struct timespec timeout;
-        struct timeval now;
-
-        gettimeofday(&now, NULL);
-
-        timeout.tv_sec = now.tv_sec + 3;
-        timeout.tv_nsec = now.tv_usec * 1000;
-        // le thread boucle jusqu'à qu'il trouve une tâche ou que la durée est passé
-        while (taskCount == 0)
+    if (taskPool.order == POOL_FIFO)
+    {
+        // les lots de préfixes remplacent la file : pas d'attente de la génération
+        NQ_PREFIX batch[BATCH_SIZE];
+        initialize_board(n_queens_global, &local, 0, 0);
+        while (1)
         {
-            if (pthread_cond_timedwait(&condQueue, &mutexQueue, &timeout) == ETIMEDOUT)
+            const double wait_start = telemetry_now();
+            const uint32_t count = nq_stream_next_batch(&taskStream, batch, BATCH_SIZE);
+            telemetry_idle(stats, telemetry_now() - wait_start);
+            if (count == 0)
             {
-                pthread_mutex_unlock(&mutexQueue);
-                return NULL;
+                break;
+            }
+            for (uint32_t k = 0; k < count; ++k)
+            {
+                const double task_start = telemetry_now();
+                const uint64_t placements = local->placements;
+                nq_prefix_place(&batch[k], local);
+                place_next_queen_thread(local);
+                nq_prefix_remove(&batch[k], local);
+                telemetry_task_done(stats, local->placements - placements, telemetry_now() - task_start);
             }
         }
-        // prendre la premère tâche de la file
-        task = taskQueue[0];
-        int i;
-        // décalage vers la gauche de la file
-        for (i = 0; i < taskCount - 1; i++)
-        {
-            taskQueue[i] = taskQueue[i + 1];
-        }
-        taskCount--;
-        pthread_mutex_unlock(&mutexQueue);
-        executeTask(&task);
-        free(task); // free task
+        pthread_mutex_lock(&mutexSolutions);
+        numberOfSolutions += local->solutions;
+        pthread_mutex_unlock(&mutexSolutions);
+        smash_board(local);
+        return NULL;
     }
-}
 
-void place_next_queen(struct chess_board *board)
-{
-    uint64_t start = board->start;
-    uint64_t end = board->end;
-    const uint32_t middle = board->column_j ? board->n_size : board->n_size >> 1;
-    for (uint32_t row_i = start; row_i < end; ++row_i)
+    while (1)
     {
-        // on utilise ces vérification au lieu de la fonction donnéé pour vérifier la disponibilité d'un emplacement
-        // c'est la même chose juste ordonné par les plus petites vérifications vers les plus grandes pour diminuer le temps d'execution
-        if (board->column[row_i])
+        const double wait_start = telemetry_now();
+        // le thread attend une tâche ; NULL quand la file est fermée et vide
+        Task task = pool_take(&taskPool);
+        if (task == NULL)
         {
-            if (board->diagonal_down[board->column_j + row_i])
+            // l'attente finale compte comme inactivité : c'est la traîne
+            telemetry_idle(stats, telemetry_now() - wait_start);
+            // ajouter les solutions du thread une seule fois, à sa sortie
+            if (local != NULL)
             {
-                if (board->diagonal_up[(board->n_size - 1) + (board->column_j - row_i)])
-                {
-                    set_queen(row_i, board);
-                    if (board->queen_positions[0] != middle)
-                    {
-                        board->start = 0;
-                        board->end = board->n_size;
-                        Task task = copyBoard(board);
-                        submitTask(&task);
-                    }
-                    else
-                    {
-                        board->start = 0;
-                        board->end = middle;
-                        Task task = copyBoard(board);
-                        submitTask(&task);
-                    }
-                    remove_queen(row_i, board);
-                }
+                pthread_mutex_lock(&mutexSolutions);
+                numberOfSolutions += local->solutions;
+                pthread_mutex_unlock(&mutexSolutions);
+                smash_board(local);
             }
+            return NULL;
         }
+        const double task_start = telemetry_now();
+        telemetry_idle(stats, task_start - wait_start);
+        load_task(&local, task);
+        smash_board(task); // free task
+        const uint64_t placements = local->placements;
+        place_next_queen_thread(local);
+        telemetry_task_done(stats, local->placements - placements, telemetry_now() - task_start);
+        pool_task_done(&taskPool);
     }
 }
+
 void place_next_queen_without_parallelization(struct chess_board *board,uint32_t row_boundary){
     const uint32_t middle = board->column_j ? board->n_size : board->n_size >> 1;
     for (uint32_t row_i = 0; row_i < row_boundary; ++row_i) {
@@ -260,11 +157,11 @@ void place_next_queen_without_parallelization(struct chess_board *board,uint32_t
             set_queen(row_i, board);
             if (board->column_j == board->n_size) {
 
-                total_solutions += 2;
+                numberOfSolutions += 2;
             } else if (board->queen_positions[0] != middle) {
-                place_next_queen(board->n_size, board);
+                place_next_queen_without_parallelization(board, board->n_size);
             } else {
-                place_next_queen(middle, board);
+                place_next_queen_without_parallelization(board, middle);
             }
             remove_queen(row_i, board);
         }
@@ -277,6 +174,13 @@ void place_next_queen_thread(struct chess_board *board)
     uint64_t start = board->start;
     uint64_t end = board->end;
     const uint32_t middle = board->column_j ? board->n_size : board->n_size >> 1;
+    // un préfixe qui place déjà toutes les reines (N = 1) est une solution : il
+    // n'a plus de ligne à essayer ; la reine du milieu de N = 1 n'a pas d'image miroir
+    if (board->column_j == board->n_size)
+    {
+        board->solutions += board->n_size == 1 ? 1 : 2;
+        return;
+    }
     for (uint32_t row_i = start; row_i < end; ++row_i)
     {
         if (board->column[row_i])
@@ -288,9 +192,7 @@ void place_next_queen_thread(struct chess_board *board)
                     set_queen(row_i, board);
                     if (board->column_j == board->n_size)
                     {
-                        pthread_mutex_lock(&mutexSolutions);
-                        numberOfSolutions += 2;
-                        pthread_mutex_unlock(&mutexSolutions);
+                        board->solutions += 2;
                     }
                     else if (board->queen_positions[0] != middle)
                     {
@@ -311,28 +213,44 @@ void place_next_queen_thread(struct chess_board *board)
     }
 }
 
-int main(int argc, char *argv[])
+// Compter les solutions de N reines avec les THREAD_NUM threads et la file
+// dans l'ordre `order` ; `report` affiche le temps et l'équilibrage de charge
+static uint64_t count_solutions(uint32_t n_queens, POOL_ORDER order, int report)
 {
-    static const uint32_t default_n = 16;
-    const uint32_t n_queens = (argc != 1) ? (uint32_t)atoi(argv[1]) : default_n;
     const uint32_t row_boundary = (n_queens >> 1) + (n_queens & 1);
     pthread_t th[THREAD_NUM];
-    pthread_mutex_init(&mutexQueue, NULL);
+    numberOfSolutions = 0;
     pthread_mutex_init(&mutexSolutions, NULL);
-    pthread_cond_init(&condQueue, NULL);
+    pool_init(&taskPool, order);
+    n_queens_global = n_queens;
+    nq_stream_init(&taskStream, n_queens, level + 1 < n_queens ? level + 1 : n_queens);
     Board *board;
-    clock_t start_time = clock();
+    const double start_time = telemetry_now();
     int i;
     // création des threads
     for (i = 0; i < THREAD_NUM; i++)
     {
-        if (pthread_create(&th[i], NULL, &startThread, NULL) != 0)
+        if (pthread_create(&th[i], NULL, &startThread, (void *)(uintptr_t)i) != 0)
         {
             perror("Failed to create the thread");
         }
     }
-    initialize_board(n_queens, &board, 0, row_boundary);
-    place_next_queen(board);
+    if (order == POOL_LPT)
+    {
+        // chaque préfixe devient un échiquier soumis avec sa taille estimée
+        NQ_PREFIX prefix;
+        initialize_board(n_queens, &board, 0, row_boundary);
+        while (nq_stream_next(&taskStream, &prefix))
+        {
+            nq_prefix_place(&prefix, board);
+            Task task = copyBoard(board);
+            submitTask(&task);
+            nq_prefix_remove(&prefix, board);
+        }
+        smash_board(board);
+    }
+    // le thread principal ne soumettra plus rien
+    pool_close(&taskPool);
     // join des threads
     for (i = 0; i < THREAD_NUM; i++)
     {
@@ -341,14 +259,57 @@ int main(int argc, char *argv[])
             perror("Failed to join the thread");
         }
     }
-    clock_t end_time = clock();
-    double time_totale = (double)(end_time - start_time) / CLOCKS_PER_SEC;
-    printf("N = %d : Nombre de solution global : %d dans : %f s \n", n_queens, numberOfSolutions, time_totale - 3);
-    pthread_mutex_destroy(&mutexQueue);
-    pthread_cond_destroy(&condQueue);
+    double time_totale = telemetry_now() - start_time;
+    // résumé de l'équilibrage de charge entre les threads
+    WORKER_STATS stats[THREAD_NUM];
+    for (i = 0; i < THREAD_NUM; i++)
+    {
+        stats[i] = *workerStats[i];
+        free(workerStats[i]);
+    }
+    if (report)
+    {
+        printf("N = %d : Nombre de solution global : %" PRIu64 " dans : %f s \n", n_queens, numberOfSolutions, time_totale);
+        placement_report(THREAD_NUM);
+        telemetry_report("worker", stats, THREAD_NUM);
+    }
+    pool_destroy(&taskPool);
+    nq_stream_destroy(&taskStream);
+    pthread_mutex_destroy(&mutexSolutions);
+    return numberOfSolutions;
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t default_n = 16;
+    const uint32_t n_queens = (argc != 1) ? (uint32_t)atoi(argv[1]) : default_n;
+    // ordre de la file : fifo (par défaut) ou lpt
+    const POOL_ORDER order = pool_order_from_string((argc > 2) ? argv[2] : NULL);
+    // placement des threads selon NQ_PLACEMENT (compact, scatter, cores)
+    placement_init(PLACEMENT_NONE);
+
+    if (n_queens == 0)
+    {
+        // vérification : les deux ordres contre le comptage séquentiel
+        int mismatches = 0;
+        for (uint32_t n = 1; n <= CHECK_MAX_N; ++n)
+        {
+            uint64_t placements = 0;
+            const uint64_t expected = nq_count(NQ_KERNEL_BITBOARD, n, &placements);
+            const uint64_t fifo = count_solutions(n, POOL_FIFO, 0);
+            const uint64_t lpt = count_solutions(n, POOL_LPT, 0);
+            mismatches += (fifo != expected) + (lpt != expected);
+            printf("N = %2u : attendu %" PRIu64 ", fifo %" PRIu64 ", lpt %" PRIu64 "%s\n", n, expected, fifo, lpt,
+                   fifo != expected || lpt != expected ? " ERREUR" : "");
+        }
+        return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    printf("ordre des tâches : %s\n", order == POOL_LPT ? "lpt" : "fifo");
+    count_solutions(n_queens, order, 1);
 
     //sequetial execution 
     //place_next_queen_without_parallelization(board,row_boundary);
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <inttypes.h>
+#include "../common/n_queens_telemetry.h"
+#include "../common/n_queens_task_pool.h"
+
+// Microbenchmark du pool de tâches : le thread principal soumet des rafales
+// de tâches vides séparées par une courte pause, pour que les threads aient le
+// temps de se retrouver sans travail. Chaque tâche porte son instant de
+// soumission ; le thread qui la prend mesure la latence de distribution.
+// La référence `shared` est l'ancienne file des programmes pthread : un seul
+// verrou et une seule condition, signalée à chaque soumission.
+
+#define MAX_WORKERS 256
+// pause entre deux rafales, en secondes
+#define BURST_GAP 20e-6
+
+typedef enum dispatch_mode
+{
+    DISPATCH_SHARED, // une condition partagée par tous les threads
+    DISPATCH_PARK,   // le pool, sommeil immédiat
+    DISPATCH_SPIN,   // le pool, attente active bornée puis sommeil
+    DISPATCH_MODES
+} DISPATCH_MODE;
+
+static const char *mode_names[DISPATCH_MODES] = {"shared", "park", "spin"};
+
+typedef struct timed_task
+{
+    double submitted;
+} TIMED_TASK;
+
+// File FIFO de l'ancien pool : tous les threads sans travail dorment sur `cond`
+typedef struct shared_queue
+{
+    TIMED_TASK **tasks;
+    uint64_t head;
+    uint64_t tail;
+    int closed;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} SHARED_QUEUE;
+
+typedef struct worker_args
+{
+    DISPATCH_MODE mode;
+    TASK_POOL *pool;
+    SHARED_QUEUE *queue;
+    double *latencies;
+    uint64_t count;
+} WORKER_ARGS;
+
+static void shared_submit(SHARED_QUEUE *queue, TIMED_TASK *task)
+{
+    pthread_mutex_lock(&queue->mutex);
+    queue->tasks[queue->tail++] = task;
+    pthread_mutex_unlock(&queue->mutex);
+    pthread_cond_signal(&queue->cond);
+}
+
+static TIMED_TASK *shared_take(SHARED_QUEUE *queue)
+{
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->head == queue->tail && !queue->closed)
+    {
+        pthread_cond_wait(&queue->cond, &queue->mutex);
+    }
+    TIMED_TASK *task = queue->head < queue->tail ? queue->tasks[queue->head++] : NULL;
+    pthread_mutex_unlock(&queue->mutex);
+    return task;
+}
+
+static void shared_close(SHARED_QUEUE *queue)
+{
+    pthread_mutex_lock(&queue->mutex);
+    queue->closed = 1;
+    pthread_mutex_unlock(&queue->mutex);
+    pthread_cond_broadcast(&queue->cond);
+}
+
+static void *worker(void *args)
+{
+    WORKER_ARGS *w = args;
+    TIMED_TASK *task;
+    if (w->mode == DISPATCH_SHARED)
+    {
+        while ((task = shared_take(w->queue)) != NULL)
+        {
+            w->latencies[w->count++] = telemetry_now() - task->submitted;
+        }
+        return NULL;
+    }
+    while ((task = pool_take(w->pool)) != NULL)
+    {
+        w->latencies[w->count++] = telemetry_now() - task->submitted;
+        pool_task_done(w->pool);
+    }
+    return NULL;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Distribuer `ntasks` tâches vides sur `nworkers` threads et afficher la latence
+static void run(DISPATCH_MODE mode, uint32_t nworkers, uint64_t ntasks)
+{
+    TASK_POOL pool;
+    SHARED_QUEUE queue;
+    TIMED_TASK *tasks = malloc(sizeof(TIMED_TASK) * ntasks);
+    memset(&queue, 0, sizeof(queue));
+    if (mode == DISPATCH_SHARED)
+    {
+        queue.tasks = malloc(sizeof(TIMED_TASK *) * ntasks);
+        pthread_mutex_init(&queue.mutex, NULL);
+        pthread_cond_init(&queue.cond, NULL);
+    }
+    else
+    {
+        pool_init(&pool, POOL_FIFO);
+        pool_set_spin(&pool, mode == DISPATCH_SPIN ? POOL_SPIN_LIMIT : 0);
+    }
+    pthread_t th[MAX_WORKERS];
+    WORKER_ARGS args[MAX_WORKERS];
+    if (tasks == NULL || (mode == DISPATCH_SHARED && queue.tasks == NULL))
+    {
+        fprintf(stderr, "Memory allocation failed for the tasks.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (uint32_t i = 0; i < nworkers; ++i)
+    {
+        args[i].mode = mode;
+        args[i].pool = &pool;
+        args[i].queue = &queue;
+        args[i].count = 0;
+        args[i].latencies = malloc(sizeof(double) * ntasks);
+        if (args[i].latencies == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed for the latencies.\n");
+            exit(EXIT_FAILURE);
+        }
+        if (pthread_create(&th[i], NULL, &worker, &args[i]) != 0)
+        {
+            perror("Failed to create the thread");
+        }
+    }
+
+    const double start_time = telemetry_now();
+    for (uint64_t t = 0; t < ntasks; ++t)
+    {
+        // une rafale d'autant de tâches que de threads, puis une pause
+        if (t % nworkers == 0 && t > 0)
+        {
+            const double gap_end = telemetry_now() + BURST_GAP;
+            while (telemetry_now() < gap_end)
+            {
+            }
+        }
+        tasks[t].submitted = telemetry_now();
+        if (mode == DISPATCH_SHARED)
+        {
+            shared_submit(&queue, &tasks[t]);
+        }
+        else
+        {
+            pool_submit(&pool, &tasks[t], 0);
+        }
+    }
+    if (mode == DISPATCH_SHARED)
+    {
+        shared_close(&queue);
+    }
+    else
+    {
+        pool_close(&pool);
+    }
+    for (uint32_t i = 0; i < nworkers; ++i)
+    {
+        if (pthread_join(th[i], NULL) != 0)
+        {
+            perror("Failed to join the thread");
+        }
+    }
+    const double elapsed = telemetry_now() - start_time;
+
+    double *all = malloc(sizeof(double) * ntasks);
+    uint64_t total = 0;
+    double sum = 0;
+    for (uint32_t i = 0; i < nworkers; ++i)
+    {
+        for (uint64_t k = 0; k < args[i].count; ++k)
+        {
+            all[total++] = args[i].latencies[k];
+            sum += args[i].latencies[k];
+        }
+        free(args[i].latencies);
+    }
+    qsort(all, total, sizeof(double), compare_double);
+    printf("mode %-6s, %u threads, %" PRIu64 " tâches en %f s\n", mode_names[mode], nworkers, total, elapsed);
+    printf("latence de distribution (us) : moyenne %.2f  p50 %.2f  p99 %.2f  max %.2f\n",
+           1e6 * sum / total, 1e6 * all[total / 2], 1e6 * all[(total * 99) / 100], 1e6 * all[total - 1]);
+
+    free(all);
+    free(tasks);
+    if (mode == DISPATCH_SHARED)
+    {
+        pthread_cond_destroy(&queue.cond);
+        pthread_mutex_destroy(&queue.mutex);
+        free(queue.tasks);
+    }
+    else
+    {
+        pool_destroy(&pool);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const uint32_t nworkers = (argc > 1) ? (uint32_t)atoi(argv[1]) : 4;
+    const uint64_t ntasks = (argc > 2) ? (uint64_t)atoll(argv[2]) : 100000;
+    // sans mode : les trois, la référence d'abord
+    int first = 0, last = DISPATCH_MODES - 1;
+    if (argc > 3)
+    {
+        for (first = 0; first < DISPATCH_MODES && strcmp(argv[3], mode_names[first]) != 0; ++first)
+        {
+        }
+        last = first;
+    }
+    if (nworkers < 1 || nworkers > MAX_WORKERS || ntasks < 1 || first == DISPATCH_MODES)
+    {
+        fprintf(stderr, "Usage: %s [workers 1..%d] [tasks] [shared|park|spin]\n", argv[0], MAX_WORKERS);
+        exit(EXIT_FAILURE);
+    }
+    for (int mode = first; mode <= last; ++mode)
+    {
+        run((DISPATCH_MODE)mode, nworkers, ntasks);
+    }
+    return 0;
+}